@@ -0,0 +1,40 @@
+# Generates a C source embedding resource files as constant byte arrays
+# Invoked at build time by the `aa` target:
+#   cmake -DROOT=<resources dir> -DOUTPUT=<file.c> -DFILES=<a|b|...> -P embed_resources.cmake
+# Every array gets a trailing NUL (not counted in `size`), so text files can be
+# used as C strings directly.
+
+string(REPLACE "|" ";" FILES "${FILES}")
+
+# Matches 24 bytes (`0x..,`), used to break the arrays into lines
+set(line_pattern "")
+foreach(i RANGE 1 24)
+  string(APPEND line_pattern "0x..,")
+endforeach()
+
+set(arrays "")
+set(table "")
+set(index 0)
+foreach(file IN LISTS FILES)
+  file(READ "${ROOT}/${file}" hex HEX)
+  string(LENGTH "${hex}" hex_length)
+  math(EXPR size "${hex_length} / 2")
+  string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," bytes "${hex}")
+  string(REGEX REPLACE "(${line_pattern})" "\\1\n" bytes "${bytes}")
+  string(APPEND arrays
+    "// ${file}\n"
+    "static const unsigned char aa_embedded_${index}[] = {\n${bytes}0x00};\n\n")
+  string(APPEND table "    {\"${file}\", aa_embedded_${index}, ${size}},\n")
+  math(EXPR index "${index} + 1")
+endforeach()
+
+file(WRITE "${OUTPUT}.tmp"
+  "// Generated by cmake/embed_resources.cmake, do not edit\n"
+  "#include \"embedded.h\"\n\n"
+  "${arrays}"
+  "const aa_embedded_file aa_embedded_files[] = {\n${table}};\n"
+  "const size_t aa_embedded_file_count = ${index};\n")
+# Only touch the output when its content changes, to avoid needless recompiles
+execute_process(
+  COMMAND "${CMAKE_COMMAND}" -E copy_if_different "${OUTPUT}.tmp" "${OUTPUT}")
+file(REMOVE "${OUTPUT}.tmp")
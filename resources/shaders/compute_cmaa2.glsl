@@ -0,0 +1,322 @@
+/*
+ * Conservative morphological anti-aliasing (after CMAA 2.0), in compute
+ * The shader is assembled with one of the following defines, one kernel each:
+ * - CMAA2_EDGES: detects colour edges with local contrast adaptation, stores
+ *   the right and top edge of every pixel, and appends every pixel with an
+ *   edge to the candidate list
+ * - CMAA2_ARGS: turns the length of a list into the arguments of the indirect
+ *   dispatch processing it, and resets the counters
+ * - CMAA2_PROCESS: for every candidate, blurs simple shapes (a pixel enclosed
+ *   by 3 or 4 edges) and follows the edges starting there. Only Z shapes,
+ *   stepping on opposite sides at both ends, are blended along the line they
+ *   approximate: corners and the ends of lines are left sharp.
+ *   A pixel may be blended by several shapes: every blended colour is pushed
+ *   onto a list per pixel (atomics), and each first push appends the pixel to
+ *   the location list
+ * - CMAA2_APPLY: writes the mean of the list of every location into the image
+ */
+#version 430 core
+
+#define CMAA2_PROCESS_GROUP 64
+// Contrast of an edge to its neighbours below which it is dropped (as SMAA)
+#define CMAA2_LOCAL_CONTRAST_FACTOR 2.0
+// Longest edge followed, in pixels
+#define CMAA2_MAX_LENGTH 64
+// Weight of the neighbours across each edge of a simple shape
+#define CMAA2_SIMPLE_SHAPE_BLUR 0.1
+
+#if defined(CMAA2_EDGES)
+layout(local_size_x = 16, local_size_y = 16) in;
+#elif defined(CMAA2_ARGS)
+layout(local_size_x = 1) in;
+#else
+layout(local_size_x = CMAA2_PROCESS_GROUP) in;
+#endif
+
+// Counters, list lengths of the previous stage, and indirect arguments
+layout(std430, binding = 0) buffer Control
+{
+  uint candidateCount;
+  uint locationCount;
+  uint itemCount;
+  uint candidateTotal;
+  uint locationTotal;
+  uint candidateArgs[3];
+  uint locationArgs[3];
+};
+// Pixels packed as x | y << 16
+layout(std430, binding = 1) buffer Candidates
+{
+  uint candidates[];
+};
+layout(std430, binding = 2) buffer Locations
+{
+  uint locations[];
+};
+// Blended colour (RGBA8) and next item of the list, plus one (0 ends it)
+layout(std430, binding = 3) buffer Items
+{
+  uvec2 items[];
+};
+
+layout(rgba8, binding = 0) uniform image2D colorImage;
+// Bit 0: edge with the right neighbour, bit 1: edge with the top neighbour
+layout(r8ui, binding = 1) uniform uimage2D edgesImage;
+// First item of the list of every pixel, plus one (0 for an empty list)
+layout(r32ui, binding = 2) uniform uimage2D headsImage;
+
+uniform float threshold;
+uniform uint itemCapacity;
+// CMAA2_ARGS: false for the candidates, true for the locations
+uniform bool locationStage;
+
+uint Pack(ivec2 p)
+{
+  return uint(p.x) | (uint(p.y) << 16);
+}
+
+ivec2 Unpack(uint p)
+{
+  return ivec2(p & 0xFFFFu, p >> 16);
+}
+
+#if defined(CMAA2_EDGES)
+
+vec3 Load(ivec2 p)
+{
+  ivec2 size = imageSize(colorImage);
+  return imageLoad(colorImage, clamp(p, ivec2(0), size - 1)).rgb;
+}
+
+float Difference(vec3 a, vec3 b)
+{
+  vec3 d = abs(a - b);
+  return max(d.r, max(d.g, d.b));
+}
+
+void main()
+{
+  ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+  if (any(greaterThanEqual(p, imageSize(colorImage))))
+    return;
+
+  vec3 c  = Load(p);
+  vec3 l  = Load(p + ivec2(-1, 0));
+  vec3 r  = Load(p + ivec2(1, 0));
+  vec3 b  = Load(p + ivec2(0, -1));
+  vec3 t  = Load(p + ivec2(0, 1));
+  vec3 rr = Load(p + ivec2(2, 0));
+  vec3 rb = Load(p + ivec2(1, -1));
+  vec3 rt = Load(p + ivec2(1, 1));
+  vec3 tt = Load(p + ivec2(0, 2));
+  vec3 tl = Load(p + ivec2(-1, 1));
+
+  float left   = Difference(c, l);
+  float bottom = Difference(c, b);
+  float right  = Difference(c, r);
+  float top    = Difference(c, t);
+
+  // An edge is kept if it is not much weaker than the other edges of its
+  // two pixels
+  float rightLocal = max(
+      max(left, max(top, bottom)),
+      max(Difference(r, rr), max(Difference(r, rt), Difference(r, rb))));
+  float topLocal = max(
+      max(left, max(right, bottom)),
+      max(Difference(t, tt), max(Difference(t, tl), Difference(t, rt))));
+  bool rightEdge =
+      right > threshold && right * CMAA2_LOCAL_CONTRAST_FACTOR >= rightLocal;
+  bool topEdge = top > threshold && top * CMAA2_LOCAL_CONTRAST_FACTOR >= topLocal;
+
+  uint edges = (rightEdge ? 1u : 0u) | (topEdge ? 2u : 0u);
+  imageStore(edgesImage, p, uvec4(edges));
+  if (edges != 0u)
+    candidates[atomicAdd(candidateCount, 1u)] = Pack(p);
+}
+
+#elif defined(CMAA2_ARGS)
+
+void main()
+{
+  if (locationStage)
+  {
+    locationTotal   = locationCount;
+    locationCount   = 0u;
+    locationArgs[0] =
+        (locationTotal + CMAA2_PROCESS_GROUP - 1) / CMAA2_PROCESS_GROUP;
+    locationArgs[1] = 1u;
+    locationArgs[2] = 1u;
+  }
+  else
+  {
+    candidateTotal   = candidateCount;
+    candidateCount   = 0u;
+    itemCount        = 0u;
+    candidateArgs[0] =
+        (candidateTotal + CMAA2_PROCESS_GROUP - 1) / CMAA2_PROCESS_GROUP;
+    candidateArgs[1] = 1u;
+    candidateArgs[2] = 1u;
+  }
+}
+
+#elif defined(CMAA2_PROCESS)
+
+uint Edges(ivec2 p)
+{
+  if (any(lessThan(p, ivec2(0)))
+      || any(greaterThanEqual(p, imageSize(edgesImage))))
+    return 0u;
+  return imageLoad(edgesImage, p).r;
+}
+
+bool RightEdge(ivec2 p)
+{
+  return (Edges(p) & 1u) != 0u;
+}
+
+bool TopEdge(ivec2 p)
+{
+  return (Edges(p) & 2u) != 0u;
+}
+
+void Push(ivec2 p, vec4 colour)
+{
+  uint item = atomicAdd(itemCount, 1u);
+  if (item >= itemCapacity)
+    return;
+  uint next   = imageAtomicExchange(headsImage, p, item + 1u);
+  items[item] = uvec2(packUnorm4x8(colour), next);
+  if (next == 0u)
+    locations[atomicAdd(locationCount, 1u)] = Pack(p);
+}
+
+// Areas of a pixel on the positive and negative side of its edge, covered by
+// the other side of a line crossing it from height h0 to h1 (in pixels, from
+// the edge)
+vec2 Areas(float h0, float h1)
+{
+  if (h0 * h1 >= 0.0)
+  {
+    float area = 0.5 * (h0 + h1);
+    return vec2(max(area, 0.0), max(-area, 0.0));
+  }
+  float t      = h0 / (h0 - h1);
+  float first  = 0.5 * abs(h0) * t;
+  float second = 0.5 * abs(h1) * (1.0 - t);
+  return h0 > 0.0 ? vec2(first, second) : vec2(second, first);
+}
+
+// Blends the pixels along a Z shape of `length` edges starting at `p`, the
+// line going from h0 to -h0; `along` steps along the edge and `across` to the
+// pixel on its positive side
+void BlendZ(ivec2 p, int length, float h0, ivec2 along, ivec2 across)
+{
+  for (int i = 0; i < length; i++)
+  {
+    float a             = h0 * (1.0 - 2.0 * float(i) / float(length));
+    float b             = h0 * (1.0 - 2.0 * float(i + 1) / float(length));
+    vec2 areas          = Areas(a, b);
+    ivec2 negative      = p + i * along;
+    ivec2 positive      = negative + across;
+    vec4 negativeColour = imageLoad(colorImage, negative);
+    vec4 positiveColour = imageLoad(colorImage, positive);
+    if (areas.x > 0.0)
+      Push(positive, mix(positiveColour, negativeColour, areas.x));
+    if (areas.y > 0.0)
+      Push(negative, mix(negativeColour, positiveColour, areas.y));
+  }
+}
+
+// Follows the top edges from `p`, the first one of its row
+void ProcessHorizontal(ivec2 p)
+{
+  int length = 1;
+  while (length < CMAA2_MAX_LENGTH && TopEdge(p + ivec2(length, 0)))
+    length++;
+  ivec2 last      = p + ivec2(length - 1, 0);
+  bool startBelow = RightEdge(p + ivec2(-1, 0));
+  bool startAbove = RightEdge(p + ivec2(-1, 1));
+  bool endBelow   = RightEdge(last);
+  bool endAbove   = RightEdge(last + ivec2(0, 1));
+  if (startBelow && !startAbove && endAbove && !endBelow)
+    BlendZ(p, length, -0.5, ivec2(1, 0), ivec2(0, 1));
+  else if (startAbove && !startBelow && endBelow && !endAbove)
+    BlendZ(p, length, 0.5, ivec2(1, 0), ivec2(0, 1));
+}
+
+// Follows the right edges from `p`, the first one of its column
+void ProcessVertical(ivec2 p)
+{
+  int length = 1;
+  while (length < CMAA2_MAX_LENGTH && RightEdge(p + ivec2(0, length)))
+    length++;
+  ivec2 last      = p + ivec2(0, length - 1);
+  bool startLeft  = TopEdge(p + ivec2(0, -1));
+  bool startRight = TopEdge(p + ivec2(1, -1));
+  bool endLeft    = TopEdge(last);
+  bool endRight   = TopEdge(last + ivec2(1, 0));
+  if (startLeft && !startRight && endRight && !endLeft)
+    BlendZ(p, length, -0.5, ivec2(0, 1), ivec2(1, 0));
+  else if (startRight && !startLeft && endLeft && !endRight)
+    BlendZ(p, length, 0.5, ivec2(0, 1), ivec2(1, 0));
+}
+
+void main()
+{
+  uint index = gl_GlobalInvocationID.x;
+  if (index >= candidateTotal)
+    return;
+  ivec2 p = Unpack(candidates[index]);
+
+  bool right  = RightEdge(p);
+  bool top    = TopEdge(p);
+  bool left   = RightEdge(p + ivec2(-1, 0));
+  bool bottom = TopEdge(p + ivec2(0, -1));
+
+  int count = int(right) + int(top) + int(left) + int(bottom);
+  if (count >= 3)
+  {
+    vec4 sum = vec4(0.0);
+    if (right)
+      sum += imageLoad(colorImage, p + ivec2(1, 0));
+    if (top)
+      sum += imageLoad(colorImage, p + ivec2(0, 1));
+    if (left)
+      sum += imageLoad(colorImage, p + ivec2(-1, 0));
+    if (bottom)
+      sum += imageLoad(colorImage, p + ivec2(0, -1));
+    vec4 colour = imageLoad(colorImage, p);
+    float weight = CMAA2_SIMPLE_SHAPE_BLUR * float(count);
+    Push(p, mix(colour, sum / float(count), weight));
+  }
+
+  if (top && !TopEdge(p + ivec2(-1, 0)))
+    ProcessHorizontal(p);
+  if (right && !RightEdge(p + ivec2(0, -1)))
+    ProcessVertical(p);
+}
+
+#elif defined(CMAA2_APPLY)
+
+void main()
+{
+  uint index = gl_GlobalInvocationID.x;
+  if (index >= locationTotal)
+    return;
+  ivec2 p = Unpack(locations[index]);
+
+  vec4 sum    = vec4(0.0);
+  float count = 0.0;
+  uint item   = imageLoad(headsImage, p).r;
+  while (item != 0u)
+  {
+    uvec2 entry = items[item - 1u];
+    sum += unpackUnorm4x8(entry.x);
+    count += 1.0;
+    item = entry.y;
+  }
+  imageStore(headsImage, p, uvec4(0u));
+  imageStore(colorImage, p, sum / count);
+}
+
+#endif
\ No newline at end of file
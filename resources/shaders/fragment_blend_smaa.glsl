@@ -1,6 +1,7 @@
 // SMAA Blend Weight Calculation Pass Fragment Shader 
 // Uses the edges detected in Pass 1 to calculate blending weights for pixels
 // by searching the Area and Search textures
+#include "SMAA.hlsl"
 in vec2 vTexCoord;
 in vec2 vPixCoord;
 in vec4 vOffset[3];
@@ -10,8 +11,10 @@ out vec4 FragColor;
 uniform sampler2D edgeTex;
 uniform sampler2D areaTex;
 uniform sampler2D searchTex;
+// Selects the area texture of the current subsample (SMAA T2x), 0 for SMAA 1x
+uniform vec4 subsampleIndices = vec4(0.0);
 
 void main()
 {
-    FragColor = SMAABlendingWeightCalculationPS(vTexCoord, vPixCoord, vOffset, edgeTex, areaTex, searchTex, vec4(0.0));
+    FragColor = SMAABlendingWeightCalculationPS(vTexCoord, vPixCoord, vOffset, edgeTex, areaTex, searchTex, subsampleIndices);
 }
\ No newline at end of file
@@ -1,7 +1,16 @@
 // Basic fragment shader that outputs a solid white color
+// The velocity is only stored by targets with a second attachment (SMAA T2x)
 #version 430 core
-out vec4 FragColor;
+in vec2 v_velocity;
+layout(location = 0) out vec4 FragColor;
+layout(location = 1) out vec2 Velocity;
+// Writes the luma into the alpha, read by the FXAA_LUMA_ALPHA variants of
+// `fragment_fxaa_iterative.glsl`
+uniform bool u_luma_alpha = false;
 void main()
 {
-    FragColor = vec4(1.0, 1.0, 1.0, 1.0);
+    vec3 color = vec3(1.0, 1.0, 1.0);
+    float luma = dot(color, vec3(0.299, 0.587, 0.114));
+    FragColor  = vec4(color, u_luma_alpha ? luma : 1.0);
+    Velocity   = v_velocity;
 }
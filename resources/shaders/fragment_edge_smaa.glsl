@@ -1,14 +1,28 @@
 // SMAA Edge Detection Pass Fragment Shader 
-// Detects edges in the input scene based on luminance (Luma) contrast
+// Detects edges in the input scene based on luminance (Luma) contrast, or on
+// colour (SMAA_EDGE_COLOR) or depth (SMAA_EDGE_DEPTH) contrast. With
+// SMAA_PREDICATION, luma edges are predicated by the depth.
 // Stores edge strength in the RG channels of the output framebuffer
+#include "SMAA.hlsl"
 in vec2 vTexCoord;
 in vec4 vOffset[3];
 
 out vec4 FragColor;
 
 uniform sampler2D sceneTex;
+// Depth of the scene, only read by the depth and predicated variants
+uniform sampler2D depthTex;
 
 void main()
 {
+#if defined(SMAA_EDGE_DEPTH)
+    FragColor = vec4(SMAADepthEdgeDetectionPS(vTexCoord, vOffset, depthTex), 0.0, 0.0);
+#elif defined(SMAA_EDGE_COLOR)
+    FragColor = vec4(SMAAColorEdgeDetectionPS(vTexCoord, vOffset, sceneTex), 0.0, 0.0);
+#elif SMAA_PREDICATION
+    FragColor = vec4(
+        SMAALumaEdgeDetectionPS(vTexCoord, vOffset, sceneTex, depthTex), 0.0, 0.0);
+#else
     FragColor = vec4(SMAALumaEdgeDetectionPS(vTexCoord, vOffset, sceneTex), 0.0, 0.0);
+#endif
 }
\ No newline at end of file
@@ -4,9 +4,176 @@
  * - An iterative sub-pixel search loop (up to 12 steps) to find the exact end of an edge
  * - Sub-pixel shifting to resolve aliasing on textures, not just geometry edges
  * Reference: Ported from Timothy Lottes' (NVIDIA) FXAA 3.11 Quality FxaaPixelShader.
+ * Variants (see `src/fxaa.h`):
+ * - FXAA_QUALITY_PRESET: the search steps of FXAA_QUALITY__PRESET 10 to 39,
+ *   compiled in, 39 by default
+ * - FXAA_LUMA_ALPHA: the luma is read from the alpha of the scene instead of
+ *   being computed at every tap
  */
 #version 430 core
 
+#ifndef FXAA_QUALITY_PRESET
+#define FXAA_QUALITY_PRESET 39
+#endif
+
+// Number of search steps (FXAA_QUALITY_PS) and their lengths, in pixels
+#if (FXAA_QUALITY_PRESET == 10)
+#define FXAA_QUALITY_PS 3
+#define FXAA_QUALITY_P0 1.5
+#define FXAA_QUALITY_P1 3.0
+#define FXAA_QUALITY_P2 12.0
+#elif (FXAA_QUALITY_PRESET == 11)
+#define FXAA_QUALITY_PS 4
+#define FXAA_QUALITY_P0 1.0
+#define FXAA_QUALITY_P1 1.5
+#define FXAA_QUALITY_P2 3.0
+#define FXAA_QUALITY_P3 12.0
+#elif (FXAA_QUALITY_PRESET == 12)
+#define FXAA_QUALITY_PS 5
+#define FXAA_QUALITY_P0 1.0
+#define FXAA_QUALITY_P1 1.5
+#define FXAA_QUALITY_P2 2.0
+#define FXAA_QUALITY_P3 4.0
+#define FXAA_QUALITY_P4 12.0
+#elif (FXAA_QUALITY_PRESET == 13)
+#define FXAA_QUALITY_PS 6
+#define FXAA_QUALITY_P0 1.0
+#define FXAA_QUALITY_P1 1.5
+#define FXAA_QUALITY_P2 2.0
+#define FXAA_QUALITY_P3 2.0
+#define FXAA_QUALITY_P4 4.0
+#define FXAA_QUALITY_P5 12.0
+#elif (FXAA_QUALITY_PRESET == 14)
+#define FXAA_QUALITY_PS 7
+#define FXAA_QUALITY_P0 1.0
+#define FXAA_QUALITY_P1 1.5
+#define FXAA_QUALITY_P2 2.0
+#define FXAA_QUALITY_P3 2.0
+#define FXAA_QUALITY_P4 2.0
+#define FXAA_QUALITY_P5 4.0
+#define FXAA_QUALITY_P6 12.0
+#elif (FXAA_QUALITY_PRESET == 15)
+#define FXAA_QUALITY_PS 8
+#define FXAA_QUALITY_P0 1.0
+#define FXAA_QUALITY_P1 1.5
+#define FXAA_QUALITY_P2 2.0
+#define FXAA_QUALITY_P3 2.0
+#define FXAA_QUALITY_P4 2.0
+#define FXAA_QUALITY_P5 2.0
+#define FXAA_QUALITY_P6 4.0
+#define FXAA_QUALITY_P7 12.0
+#elif (FXAA_QUALITY_PRESET == 20)
+#define FXAA_QUALITY_PS 3
+#define FXAA_QUALITY_P0 1.5
+#define FXAA_QUALITY_P1 2.0
+#define FXAA_QUALITY_P2 8.0
+#elif (FXAA_QUALITY_PRESET == 21)
+#define FXAA_QUALITY_PS 4
+#define FXAA_QUALITY_P0 1.0
+#define FXAA_QUALITY_P1 1.5
+#define FXAA_QUALITY_P2 2.0
+#define FXAA_QUALITY_P3 8.0
+#elif (FXAA_QUALITY_PRESET == 22)
+#define FXAA_QUALITY_PS 5
+#define FXAA_QUALITY_P0 1.0
+#define FXAA_QUALITY_P1 1.5
+#define FXAA_QUALITY_P2 2.0
+#define FXAA_QUALITY_P3 2.0
+#define FXAA_QUALITY_P4 8.0
+#elif (FXAA_QUALITY_PRESET == 23)
+#define FXAA_QUALITY_PS 6
+#define FXAA_QUALITY_P0 1.0
+#define FXAA_QUALITY_P1 1.5
+#define FXAA_QUALITY_P2 2.0
+#define FXAA_QUALITY_P3 2.0
+#define FXAA_QUALITY_P4 2.0
+#define FXAA_QUALITY_P5 8.0
+#elif (FXAA_QUALITY_PRESET == 24)
+#define FXAA_QUALITY_PS 7
+#define FXAA_QUALITY_P0 1.0
+#define FXAA_QUALITY_P1 1.5
+#define FXAA_QUALITY_P2 2.0
+#define FXAA_QUALITY_P3 2.0
+#define FXAA_QUALITY_P4 2.0
+#define FXAA_QUALITY_P5 3.0
+#define FXAA_QUALITY_P6 8.0
+#elif (FXAA_QUALITY_PRESET == 25)
+#define FXAA_QUALITY_PS 8
+#define FXAA_QUALITY_P0 1.0
+#define FXAA_QUALITY_P1 1.5
+#define FXAA_QUALITY_P2 2.0
+#define FXAA_QUALITY_P3 2.0
+#define FXAA_QUALITY_P4 2.0
+#define FXAA_QUALITY_P5 2.0
+#define FXAA_QUALITY_P6 4.0
+#define FXAA_QUALITY_P7 8.0
+#elif (FXAA_QUALITY_PRESET == 26)
+#define FXAA_QUALITY_PS 9
+#define FXAA_QUALITY_P0 1.0
+#define FXAA_QUALITY_P1 1.5
+#define FXAA_QUALITY_P2 2.0
+#define FXAA_QUALITY_P3 2.0
+#define FXAA_QUALITY_P4 2.0
+#define FXAA_QUALITY_P5 2.0
+#define FXAA_QUALITY_P6 2.0
+#define FXAA_QUALITY_P7 4.0
+#define FXAA_QUALITY_P8 8.0
+#elif (FXAA_QUALITY_PRESET == 27)
+#define FXAA_QUALITY_PS 10
+#define FXAA_QUALITY_P0 1.0
+#define FXAA_QUALITY_P1 1.5
+#define FXAA_QUALITY_P2 2.0
+#define FXAA_QUALITY_P3 2.0
+#define FXAA_QUALITY_P4 2.0
+#define FXAA_QUALITY_P5 2.0
+#define FXAA_QUALITY_P6 2.0
+#define FXAA_QUALITY_P7 2.0
+#define FXAA_QUALITY_P8 4.0
+#define FXAA_QUALITY_P9 8.0
+#elif (FXAA_QUALITY_PRESET == 28)
+#define FXAA_QUALITY_PS 11
+#define FXAA_QUALITY_P0 1.0
+#define FXAA_QUALITY_P1 1.5
+#define FXAA_QUALITY_P2 2.0
+#define FXAA_QUALITY_P3 2.0
+#define FXAA_QUALITY_P4 2.0
+#define FXAA_QUALITY_P5 2.0
+#define FXAA_QUALITY_P6 2.0
+#define FXAA_QUALITY_P7 2.0
+#define FXAA_QUALITY_P8 2.0
+#define FXAA_QUALITY_P9 4.0
+#define FXAA_QUALITY_P10 8.0
+#elif (FXAA_QUALITY_PRESET == 29)
+#define FXAA_QUALITY_PS 12
+#define FXAA_QUALITY_P0 1.0
+#define FXAA_QUALITY_P1 1.5
+#define FXAA_QUALITY_P2 2.0
+#define FXAA_QUALITY_P3 2.0
+#define FXAA_QUALITY_P4 2.0
+#define FXAA_QUALITY_P5 2.0
+#define FXAA_QUALITY_P6 2.0
+#define FXAA_QUALITY_P7 2.0
+#define FXAA_QUALITY_P8 2.0
+#define FXAA_QUALITY_P9 2.0
+#define FXAA_QUALITY_P10 4.0
+#define FXAA_QUALITY_P11 8.0
+#else
+// "high 39"
+#define FXAA_QUALITY_PS 12
+#define FXAA_QUALITY_P0 1.0
+#define FXAA_QUALITY_P1 1.0
+#define FXAA_QUALITY_P2 1.0
+#define FXAA_QUALITY_P3 1.0
+#define FXAA_QUALITY_P4 1.0
+#define FXAA_QUALITY_P5 1.5
+#define FXAA_QUALITY_P6 2.0
+#define FXAA_QUALITY_P7 2.0
+#define FXAA_QUALITY_P8 2.0
+#define FXAA_QUALITY_P9 2.0
+#define FXAA_QUALITY_P10 4.0
+#define FXAA_QUALITY_P11 8.0
+#endif
+
 in vec2 frag_uv;
 out vec4 outColor;
 
@@ -20,10 +187,14 @@ uniform float fxaaQualityEdgeThresholdMin = 0.0833;
 uniform float lumaScale = 1.0; 
 
 vec4 FxaaTexOff(sampler2D t, vec2 p, vec2 o, vec2 r) { return textureLod(t, p + (o * r), 0.0); }
+#if defined(FXAA_LUMA_ALPHA)
+float FxaaLuma(vec4 rgba) { return lumaScale * rgba.a; }
+#else
 float FxaaLuma(vec4 rgba) { return lumaScale * dot(rgba.rgb, vec3(0.299, 0.587, 0.114)); }
+#endif
 float FxaaSat(float x) { return clamp(x, 0.0, 1.0); }
 
-// FXAA 3.11 (Quality) pixel shader port (long-search/high quality preset)
+// FXAA 3.11 (Quality) pixel shader port (search steps of FXAA_QUALITY_PRESET)
 vec4 FxaaPixelShader(
     vec2 pos,                 // center-of-pixel UV
     sampler2D tex,             // input color
@@ -32,20 +203,6 @@ vec4 FxaaPixelShader(
     float qEdgeThreshold,
     float qEdgeThresholdMin
 ) {
-    // "high 39" preset search steps 
-    float fxaaQualityP0  = 1.0;
-    float fxaaQualityP1  = 1.0;
-    float fxaaQualityP2  = 1.0;
-    float fxaaQualityP3  = 1.0;
-    float fxaaQualityP4  = 1.0;
-    float fxaaQualityP5  = 1.5;
-    float fxaaQualityP6  = 2.0;
-    float fxaaQualityP7  = 2.0;
-    float fxaaQualityP8  = 2.0;
-    float fxaaQualityP9  = 2.0;
-    float fxaaQualityP10 = 4.0;
-    float fxaaQualityP11 = 8.0;
-
     vec2 posM = pos;
     vec4 rgbyM = textureLod(tex, posM, 0.0);
     float lumaM = FxaaLuma(rgbyM);
@@ -133,8 +290,8 @@ vec4 FxaaPixelShader(
     if (!horzSpan) posB.x += lengthSign * 0.5;
     if ( horzSpan) posB.y += lengthSign * 0.5;
 
-    vec2 posN = posB - offNP * fxaaQualityP0;
-    vec2 posP = posB + offNP * fxaaQualityP0;
+    vec2 posN = posB - offNP * FXAA_QUALITY_P0;
+    vec2 posP = posB + offNP * FXAA_QUALITY_P0;
 
     float subpixD = ((-2.0) * subpixC) + 3.0;
     float lumaEndN = FxaaLuma(textureLod(tex, posN, 0.0));
@@ -154,69 +311,87 @@ vec4 FxaaPixelShader(
     bool doneN = abs(lumaEndN) >= gradientScaled;
     bool doneP = abs(lumaEndP) >= gradientScaled;
 
-    if (!doneN) posN -= offNP * fxaaQualityP1;
-    if (!doneP) posP += offNP * fxaaQualityP1;
+    if (!doneN) posN -= offNP * FXAA_QUALITY_P1;
+    if (!doneP) posP += offNP * FXAA_QUALITY_P1;
 
     bool doneNP = (!doneN) || (!doneP);
 
-    // Unrolled search (P2..P11)
+    // Unrolled search (P2..P11, as many steps as the preset has)
     if (doneNP) {
-        if (!doneN) { lumaEndN = FxaaLuma(textureLod(tex, posN, 0.0)) - lumaNN * 0.5; doneN = abs(lumaEndN) >= gradientScaled; if (!doneN) posN -= offNP * fxaaQualityP2; }
-        if (!doneP) { lumaEndP = FxaaLuma(textureLod(tex, posP, 0.0)) - lumaNN * 0.5; doneP = abs(lumaEndP) >= gradientScaled; if (!doneP) posP += offNP * fxaaQualityP2; }
+        if (!doneN) { lumaEndN = FxaaLuma(textureLod(tex, posN, 0.0)) - lumaNN * 0.5; doneN = abs(lumaEndN) >= gradientScaled; if (!doneN) posN -= offNP * FXAA_QUALITY_P2; }
+        if (!doneP) { lumaEndP = FxaaLuma(textureLod(tex, posP, 0.0)) - lumaNN * 0.5; doneP = abs(lumaEndP) >= gradientScaled; if (!doneP) posP += offNP * FXAA_QUALITY_P2; }
         doneNP = (!doneN) || (!doneP);
 
+#if (FXAA_QUALITY_PS > 3)
         if (doneNP) {
-            if (!doneN) { lumaEndN = FxaaLuma(textureLod(tex, posN, 0.0)) - lumaNN * 0.5; doneN = abs(lumaEndN) >= gradientScaled; if (!doneN) posN -= offNP * fxaaQualityP3; }
-            if (!doneP) { lumaEndP = FxaaLuma(textureLod(tex, posP, 0.0)) - lumaNN * 0.5; doneP = abs(lumaEndP) >= gradientScaled; if (!doneP) posP += offNP * fxaaQualityP3; }
+            if (!doneN) { lumaEndN = FxaaLuma(textureLod(tex, posN, 0.0)) - lumaNN * 0.5; doneN = abs(lumaEndN) >= gradientScaled; if (!doneN) posN -= offNP * FXAA_QUALITY_P3; }
+            if (!doneP) { lumaEndP = FxaaLuma(textureLod(tex, posP, 0.0)) - lumaNN * 0.5; doneP = abs(lumaEndP) >= gradientScaled; if (!doneP) posP += offNP * FXAA_QUALITY_P3; }
             doneNP = (!doneN) || (!doneP);
 
+#if (FXAA_QUALITY_PS > 4)
             if (doneNP) {
-                if (!doneN) { lumaEndN = FxaaLuma(textureLod(tex, posN, 0.0)) - lumaNN * 0.5; doneN = abs(lumaEndN) >= gradientScaled; if (!doneN) posN -= offNP * fxaaQualityP4; }
-                if (!doneP) { lumaEndP = FxaaLuma(textureLod(tex, posP, 0.0)) - lumaNN * 0.5; doneP = abs(lumaEndP) >= gradientScaled; if (!doneP) posP += offNP * fxaaQualityP4; }
+                if (!doneN) { lumaEndN = FxaaLuma(textureLod(tex, posN, 0.0)) - lumaNN * 0.5; doneN = abs(lumaEndN) >= gradientScaled; if (!doneN) posN -= offNP * FXAA_QUALITY_P4; }
+                if (!doneP) { lumaEndP = FxaaLuma(textureLod(tex, posP, 0.0)) - lumaNN * 0.5; doneP = abs(lumaEndP) >= gradientScaled; if (!doneP) posP += offNP * FXAA_QUALITY_P4; }
                 doneNP = (!doneN) || (!doneP);
 
+#if (FXAA_QUALITY_PS > 5)
                 if (doneNP) {
-                    if (!doneN) { lumaEndN = FxaaLuma(textureLod(tex, posN, 0.0)) - lumaNN * 0.5; doneN = abs(lumaEndN) >= gradientScaled; if (!doneN) posN -= offNP * fxaaQualityP5; }
-                    if (!doneP) { lumaEndP = FxaaLuma(textureLod(tex, posP, 0.0)) - lumaNN * 0.5; doneP = abs(lumaEndP) >= gradientScaled; if (!doneP) posP += offNP * fxaaQualityP5; }
+                    if (!doneN) { lumaEndN = FxaaLuma(textureLod(tex, posN, 0.0)) - lumaNN * 0.5; doneN = abs(lumaEndN) >= gradientScaled; if (!doneN) posN -= offNP * FXAA_QUALITY_P5; }
+                    if (!doneP) { lumaEndP = FxaaLuma(textureLod(tex, posP, 0.0)) - lumaNN * 0.5; doneP = abs(lumaEndP) >= gradientScaled; if (!doneP) posP += offNP * FXAA_QUALITY_P5; }
                     doneNP = (!doneN) || (!doneP);
 
+#if (FXAA_QUALITY_PS > 6)
                     if (doneNP) {
-                        if (!doneN) { lumaEndN = FxaaLuma(textureLod(tex, posN, 0.0)) - lumaNN * 0.5; doneN = abs(lumaEndN) >= gradientScaled; if (!doneN) posN -= offNP * fxaaQualityP6; }
-                        if (!doneP) { lumaEndP = FxaaLuma(textureLod(tex, posP, 0.0)) - lumaNN * 0.5; doneP = abs(lumaEndP) >= gradientScaled; if (!doneP) posP += offNP * fxaaQualityP6; }
+                        if (!doneN) { lumaEndN = FxaaLuma(textureLod(tex, posN, 0.0)) - lumaNN * 0.5; doneN = abs(lumaEndN) >= gradientScaled; if (!doneN) posN -= offNP * FXAA_QUALITY_P6; }
+                        if (!doneP) { lumaEndP = FxaaLuma(textureLod(tex, posP, 0.0)) - lumaNN * 0.5; doneP = abs(lumaEndP) >= gradientScaled; if (!doneP) posP += offNP * FXAA_QUALITY_P6; }
                         doneNP = (!doneN) || (!doneP);
 
+#if (FXAA_QUALITY_PS > 7)
                         if (doneNP) {
-                            if (!doneN) { lumaEndN = FxaaLuma(textureLod(tex, posN, 0.0)) - lumaNN * 0.5; doneN = abs(lumaEndN) >= gradientScaled; if (!doneN) posN -= offNP * fxaaQualityP7; }
-                            if (!doneP) { lumaEndP = FxaaLuma(textureLod(tex, posP, 0.0)) - lumaNN * 0.5; doneP = abs(lumaEndP) >= gradientScaled; if (!doneP) posP += offNP * fxaaQualityP7; }
+                            if (!doneN) { lumaEndN = FxaaLuma(textureLod(tex, posN, 0.0)) - lumaNN * 0.5; doneN = abs(lumaEndN) >= gradientScaled; if (!doneN) posN -= offNP * FXAA_QUALITY_P7; }
+                            if (!doneP) { lumaEndP = FxaaLuma(textureLod(tex, posP, 0.0)) - lumaNN * 0.5; doneP = abs(lumaEndP) >= gradientScaled; if (!doneP) posP += offNP * FXAA_QUALITY_P7; }
                             doneNP = (!doneN) || (!doneP);
 
+#if (FXAA_QUALITY_PS > 8)
                             if (doneNP) {
-                                if (!doneN) { lumaEndN = FxaaLuma(textureLod(tex, posN, 0.0)) - lumaNN * 0.5; doneN = abs(lumaEndN) >= gradientScaled; if (!doneN) posN -= offNP * fxaaQualityP8; }
-                                if (!doneP) { lumaEndP = FxaaLuma(textureLod(tex, posP, 0.0)) - lumaNN * 0.5; doneP = abs(lumaEndP) >= gradientScaled; if (!doneP) posP += offNP * fxaaQualityP8; }
+                                if (!doneN) { lumaEndN = FxaaLuma(textureLod(tex, posN, 0.0)) - lumaNN * 0.5; doneN = abs(lumaEndN) >= gradientScaled; if (!doneN) posN -= offNP * FXAA_QUALITY_P8; }
+                                if (!doneP) { lumaEndP = FxaaLuma(textureLod(tex, posP, 0.0)) - lumaNN * 0.5; doneP = abs(lumaEndP) >= gradientScaled; if (!doneP) posP += offNP * FXAA_QUALITY_P8; }
                                 doneNP = (!doneN) || (!doneP);
 
+#if (FXAA_QUALITY_PS > 9)
                                 if (doneNP) {
-                                    if (!doneN) { lumaEndN = FxaaLuma(textureLod(tex, posN, 0.0)) - lumaNN * 0.5; doneN = abs(lumaEndN) >= gradientScaled; if (!doneN) posN -= offNP * fxaaQualityP9; }
-                                    if (!doneP) { lumaEndP = FxaaLuma(textureLod(tex, posP, 0.0)) - lumaNN * 0.5; doneP = abs(lumaEndP) >= gradientScaled; if (!doneP) posP += offNP * fxaaQualityP9; }
+                                    if (!doneN) { lumaEndN = FxaaLuma(textureLod(tex, posN, 0.0)) - lumaNN * 0.5; doneN = abs(lumaEndN) >= gradientScaled; if (!doneN) posN -= offNP * FXAA_QUALITY_P9; }
+                                    if (!doneP) { lumaEndP = FxaaLuma(textureLod(tex, posP, 0.0)) - lumaNN * 0.5; doneP = abs(lumaEndP) >= gradientScaled; if (!doneP) posP += offNP * FXAA_QUALITY_P9; }
                                     doneNP = (!doneN) || (!doneP);
 
+#if (FXAA_QUALITY_PS > 10)
                                     if (doneNP) {
-                                        if (!doneN) { lumaEndN = FxaaLuma(textureLod(tex, posN, 0.0)) - lumaNN * 0.5; doneN = abs(lumaEndN) >= gradientScaled; if (!doneN) posN -= offNP * fxaaQualityP10; }
-                                        if (!doneP) { lumaEndP = FxaaLuma(textureLod(tex, posP, 0.0)) - lumaNN * 0.5; doneP = abs(lumaEndP) >= gradientScaled; if (!doneP) posP += offNP * fxaaQualityP10; }
+                                        if (!doneN) { lumaEndN = FxaaLuma(textureLod(tex, posN, 0.0)) - lumaNN * 0.5; doneN = abs(lumaEndN) >= gradientScaled; if (!doneN) posN -= offNP * FXAA_QUALITY_P10; }
+                                        if (!doneP) { lumaEndP = FxaaLuma(textureLod(tex, posP, 0.0)) - lumaNN * 0.5; doneP = abs(lumaEndP) >= gradientScaled; if (!doneP) posP += offNP * FXAA_QUALITY_P10; }
                                         doneNP = (!doneN) || (!doneP);
 
+#if (FXAA_QUALITY_PS > 11)
                                         if (doneNP) {
-                                            if (!doneN) { lumaEndN = FxaaLuma(textureLod(tex, posN, 0.0)) - lumaNN * 0.5; doneN = abs(lumaEndN) >= gradientScaled; if (!doneN) posN -= offNP * fxaaQualityP11; }
-                                            if (!doneP) { lumaEndP = FxaaLuma(textureLod(tex, posP, 0.0)) - lumaNN * 0.5; doneP = abs(lumaEndP) >= gradientScaled; if (!doneP) posP += offNP * fxaaQualityP11; }
+                                            if (!doneN) { lumaEndN = FxaaLuma(textureLod(tex, posN, 0.0)) - lumaNN * 0.5; doneN = abs(lumaEndN) >= gradientScaled; if (!doneN) posN -= offNP * FXAA_QUALITY_P11; }
+                                            if (!doneP) { lumaEndP = FxaaLuma(textureLod(tex, posP, 0.0)) - lumaNN * 0.5; doneP = abs(lumaEndP) >= gradientScaled; if (!doneP) posP += offNP * FXAA_QUALITY_P11; }
                                         }
+#endif
                                     }
+#endif
                                 }
+#endif
                             }
+#endif
                         }
+#endif
                     }
+#endif
                 }
+#endif
             }
+#endif
         }
+#endif
     }
 
     float dstN = posM.x - posN.x;
@@ -260,4 +435,4 @@ void main() {
     );
 
     outColor = vec4(aa.rgb, 1.0);
-}
+}
\ No newline at end of file
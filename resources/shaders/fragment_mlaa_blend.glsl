@@ -0,0 +1,34 @@
+/*
+ * MLAA blending
+ * Mixes every pixel with its four neighbours by their weights.
+ */
+
+#version 430 core
+
+out vec4 FragColor;
+
+uniform sampler2D colorTex;
+// Weights of the top, bottom, left and right neighbours
+uniform sampler2D weightsTex;
+
+void main()
+{
+    ivec2 p      = ivec2(gl_FragCoord.xy);
+    ivec2 last   = textureSize(colorTex, 0) - 1;
+    vec4 colour  = texelFetch(colorTex, p, 0);
+    vec4 weights = texelFetch(weightsTex, p, 0);
+    float total  = dot(weights, vec4(1.0));
+    if (total <= 0.0)
+    {
+        FragColor = colour;
+        return;
+    }
+
+    weights /= max(total, 1.0);
+    vec4 top    = texelFetch(colorTex, min(p + ivec2(0, 1), last), 0);
+    vec4 bottom = texelFetch(colorTex, max(p - ivec2(0, 1), ivec2(0)), 0);
+    vec4 left   = texelFetch(colorTex, max(p - ivec2(1, 0), ivec2(0)), 0);
+    vec4 right  = texelFetch(colorTex, min(p + ivec2(1, 0), last), 0);
+    FragColor   = colour * (1.0 - dot(weights, vec4(1.0))) + top * weights.x
+                + bottom * weights.y + left * weights.z + right * weights.w;
+}
\ No newline at end of file
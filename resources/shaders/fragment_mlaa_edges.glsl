@@ -0,0 +1,32 @@
+/*
+ * MLAA edge detection
+ * Marks the edges of every pixel with its right (r) and top (g) neighbours:
+ * colours differing by more than `threshold` in any channel, as
+ * `src/cpu/mlaa.c` does.
+ */
+
+#version 430 core
+
+out vec4 FragColor;
+
+uniform sampler2D colorTex;
+// `AA_MLAA_THRESHOLD`
+uniform float threshold;
+
+float Difference(vec3 a, vec3 b)
+{
+    vec3 d = abs(a - b);
+    return max(d.r, max(d.g, d.b));
+}
+
+void main()
+{
+    ivec2 p    = ivec2(gl_FragCoord.xy);
+    ivec2 last = textureSize(colorTex, 0) - 1;
+    vec3 c     = texelFetch(colorTex, p, 0).rgb;
+    vec3 right = texelFetch(colorTex, min(p + ivec2(1, 0), last), 0).rgb;
+    vec3 top   = texelFetch(colorTex, min(p + ivec2(0, 1), last), 0).rgb;
+    FragColor  = vec4(
+        Difference(c, right) > threshold ? 1.0 : 0.0,
+        Difference(c, top) > threshold ? 1.0 : 0.0, 0.0, 0.0);
+}
\ No newline at end of file
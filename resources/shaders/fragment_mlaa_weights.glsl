@@ -0,0 +1,119 @@
+/*
+ * MLAA blending weights
+ * For each of its four edges, a pixel searches the run of edges it belongs to
+ * (one pixel per step, up to MLAA_MAX_SEARCH on each side), classifies both
+ * ends by the edge stepping off them, and measures the area of the pixel on
+ * the far side of the reconstructed silhouette: a line from the middle of
+ * each step to the middle of the run. This is what SMAA accelerates with its
+ * search and area textures; here both are computed, as `src/cpu/mlaa.c` does.
+ * Output: weights of the top, bottom, left and right neighbours.
+ */
+
+#version 430 core
+
+#define MLAA_MAX_SEARCH 32
+
+out vec4 FragColor;
+
+// r: edge with the right neighbour, g: edge with the top neighbour
+uniform sampler2D edgesTex;
+
+vec2 Edges(ivec2 p)
+{
+    ivec2 size = textureSize(edgesTex, 0);
+    if (any(lessThan(p, ivec2(0))) || any(greaterThanEqual(p, size)))
+        return vec2(0.0);
+    return texelFetch(edgesTex, p, 0).rg;
+}
+
+// Height of an end of a run: -0.5 if the edge steps off it on the negative
+// side, 0.5 on the positive side, 0 on both or neither
+float End(float negative, float positive)
+{
+    return 0.5 * (positive - negative);
+}
+
+// Areas of pixel `i` of a run of `length` edges on the positive and negative
+// side of the line going from `left` at its start to 0 in its middle and
+// `right` at its end
+vec2 Area(float left, float right, float length, float i)
+{
+    float middle     = 0.5 * length;
+    float areaLeft   = 0.0;
+    float areaRight  = 0.0;
+    if (i < middle)
+    {
+        float end = min(i + 1.0, middle);
+        areaLeft  = 0.5 * left * ((1.0 - i / middle) + (1.0 - end / middle))
+                   * (end - i);
+    }
+    if (i + 1.0 > middle)
+    {
+        float start = max(i, middle);
+        areaRight   = 0.5 * right
+                    * ((start / middle - 1.0) + ((i + 1.0) / middle - 1.0))
+                    * (i + 1.0 - start);
+    }
+    return vec2(max(areaLeft, 0.0) + max(areaRight, 0.0),
+                max(-areaLeft, 0.0) + max(-areaRight, 0.0));
+}
+
+// Areas of `p` along the run of top edges of its row (positive side above)
+vec2 HorizontalRun(ivec2 p)
+{
+    int left = 0;
+    while (left < MLAA_MAX_SEARCH && Edges(p - ivec2(left + 1, 0)).g > 0.5)
+        left++;
+    int right = 0;
+    while (right < MLAA_MAX_SEARCH && Edges(p + ivec2(right + 1, 0)).g > 0.5)
+        right++;
+    ivec2 start = p - ivec2(left, 0);
+    ivec2 last  = p + ivec2(right, 0);
+    // An end out of reach is taken as flat
+    float startHeight = left < MLAA_MAX_SEARCH
+        ? End(Edges(start - ivec2(1, 0)).r, Edges(start + ivec2(-1, 1)).r)
+        : 0.0;
+    float endHeight = right < MLAA_MAX_SEARCH
+        ? End(Edges(last).r, Edges(last + ivec2(0, 1)).r)
+        : 0.0;
+    return Area(startHeight, endHeight, float(left + right + 1), float(left));
+}
+
+// Areas of `p` along the run of right edges of its column (positive side on
+// the right)
+vec2 VerticalRun(ivec2 p)
+{
+    int down = 0;
+    while (down < MLAA_MAX_SEARCH && Edges(p - ivec2(0, down + 1)).r > 0.5)
+        down++;
+    int up = 0;
+    while (up < MLAA_MAX_SEARCH && Edges(p + ivec2(0, up + 1)).r > 0.5)
+        up++;
+    ivec2 start = p - ivec2(0, down);
+    ivec2 last  = p + ivec2(0, up);
+    float startHeight = down < MLAA_MAX_SEARCH
+        ? End(Edges(start - ivec2(0, 1)).g, Edges(start + ivec2(1, -1)).g)
+        : 0.0;
+    float endHeight = up < MLAA_MAX_SEARCH
+        ? End(Edges(last).g, Edges(last + ivec2(1, 0)).g)
+        : 0.0;
+    return Area(startHeight, endHeight, float(down + up + 1), float(down));
+}
+
+void main()
+{
+    ivec2 p      = ivec2(gl_FragCoord.xy);
+    vec4 weights = vec4(0.0);
+    vec2 edges   = Edges(p);
+    // Below the edge with the top neighbour, above the one with the bottom one
+    if (edges.g > 0.5)
+        weights.x = HorizontalRun(p).y;
+    if (Edges(p - ivec2(0, 1)).g > 0.5)
+        weights.y = HorizontalRun(p - ivec2(0, 1)).x;
+    // Right of the edge with the left neighbour, left of the right one
+    if (Edges(p - ivec2(1, 0)).r > 0.5)
+        weights.z = VerticalRun(p - ivec2(1, 0)).x;
+    if (edges.r > 0.5)
+        weights.w = VerticalRun(p).y;
+    FragColor = weights;
+}
\ No newline at end of file
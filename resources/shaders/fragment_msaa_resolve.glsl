@@ -0,0 +1,56 @@
+/*
+ * Custom MSAA resolve
+ * Sums the samples of the pixel and of its `reach` neighbours on each side by
+ * the weights of the filter (computed on the CPU, see `resolve.h`), skipping
+ * the zero ones. Neighbours outside the image are dropped and the weights
+ * renormalised. Optionally resolves tonemapped samples and undoes the
+ * tonemapping afterwards.
+ */
+
+#version 430 core
+
+// (2 x 1 + 1)^2 pixels of 16 samples
+#define MAX_WEIGHTS 144
+
+out vec4 FragColor;
+
+uniform sampler2DMS colorTex;
+uniform int samples;
+uniform int reach;
+uniform float weights[MAX_WEIGHTS];
+uniform bool tonemap;
+
+void main()
+{
+    ivec2 p     = ivec2(gl_FragCoord.xy);
+    ivec2 size  = textureSize(colorTex);
+    int side    = 2 * reach + 1;
+    vec4 sum    = vec4(0.0);
+    float total = 0.0;
+    for (int y = -reach; y <= reach; y++)
+    {
+        for (int x = -reach; x <= reach; x++)
+        {
+            ivec2 q = p + ivec2(x, y);
+            if (any(lessThan(q, ivec2(0))) || any(greaterThanEqual(q, size)))
+                continue;
+            int first = ((y + reach) * side + x + reach) * samples;
+            for (int s = 0; s < samples; s++)
+            {
+                float w = weights[first + s];
+                if (w == 0.0)
+                    continue;
+                vec4 c = texelFetch(colorTex, q, s);
+                if (tonemap)
+                    c.rgb /= 1.0 + max(c.r, max(c.g, c.b));
+                sum += w * c;
+                total += w;
+            }
+        }
+    }
+
+    vec4 colour = sum / max(total, 1e-6);
+    if (tonemap)
+        colour.rgb /= max(1.0 - max(colour.r, max(colour.g, colour.b)), 1e-4);
+    FragColor = colour;
+}
\ No newline at end of file
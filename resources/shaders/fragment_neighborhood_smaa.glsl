@@ -1,6 +1,7 @@
 // SMAA Neighborhood Blending Pass Fragment Shader 
 // The final resolve pass. Uses the calculated blend weights to sample 
 // neighboring pixels and produce the final anti-aliased image.
+#include "SMAA.hlsl"
 in vec2 vTexCoord;
 in vec4 vOffset;
 
@@ -8,8 +9,16 @@ out vec4 FragColor;
 
 uniform sampler2D sceneTex;
 uniform sampler2D blendTex;
+#if SMAA_REPROJECTION
+// Velocity of the scene, packed into the alpha channel for the resolve
+uniform sampler2D velocityTex;
+#endif
 
 void main()
 {
+#if SMAA_REPROJECTION
+    FragColor = SMAANeighborhoodBlendingPS(vTexCoord, vOffset, sceneTex, blendTex, velocityTex);
+#else
     FragColor = SMAANeighborhoodBlendingPS(vTexCoord, vOffset, sceneTex, blendTex);
+#endif
 }
\ No newline at end of file
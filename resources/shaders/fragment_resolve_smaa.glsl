@@ -0,0 +1,17 @@
+// SMAA Temporal Resolve Pass Fragment Shader (SMAA T2x)
+// Blends the current anti-aliased subsample with the previous one, fetched
+// where the velocity says it was. The previous subsample is faded out where
+// the velocities differ, to avoid ghosting.
+#include "SMAA.hlsl"
+in vec2 vTexCoord;
+
+out vec4 FragColor;
+
+uniform sampler2D currentColorTex;
+uniform sampler2D previousColorTex;
+uniform sampler2D velocityTex;
+
+void main()
+{
+    FragColor = SMAAResolvePS(vTexCoord, currentColorTex, previousColorTex, velocityTex);
+}
\ No newline at end of file
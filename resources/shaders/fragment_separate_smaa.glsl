@@ -0,0 +1,29 @@
+// SMAA Separate Pass Fragment Shader (SMAA S2x and 4x)
+// Splits the two samples of the multisampled scene into two textures, each
+// anti-aliased on its own afterwards. SMAA.hlsl only reads multisampled
+// textures in HLSL, the GLSL equivalents are defined here. With
+// SMAA_REPROJECTION (SMAA 4x), the velocity of the first sample is copied as
+// well, for the temporal resolve.
+#define SMAATexture2DMS2(tex) sampler2DMS tex
+#define SMAALoad(tex, pos, sample) texelFetch(tex, pos, sample)
+#include "SMAA.hlsl"
+in vec2 vTexCoord;
+
+layout(location = 0) out vec4 Sample0;
+layout(location = 1) out vec4 Sample1;
+
+uniform sampler2DMS colorTexMS;
+
+#if SMAA_REPROJECTION
+layout(location = 2) out vec2 Velocity;
+
+uniform sampler2DMS velocityTexMS;
+#endif
+
+void main()
+{
+    SMAASeparatePS(gl_FragCoord, vTexCoord, Sample0, Sample1, colorTexMS);
+#if SMAA_REPROJECTION
+    Velocity = texelFetch(velocityTexMS, ivec2(gl_FragCoord.xy), 0).rg;
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+/*
+ * SSAA downsampling, along one axis
+ * Averages the `factor` texels of the supersampled image covered by the pixel
+ * along `axis` (a box filter, as the reference). Run along x into a target as
+ * wide as the window, then along y into the window: 2 x `factor` reads per
+ * pixel instead of `factor` squared.
+ */
+
+#version 430 core
+
+out vec4 FragColor;
+
+uniform sampler2D sourceTex;
+uniform int factor;
+// (1, 0) for the rows, (0, 1) for the columns
+uniform ivec2 axis;
+
+void main()
+{
+    ivec2 p     = ivec2(gl_FragCoord.xy);
+    ivec2 first = p + axis * p * (factor - 1);
+    vec4 sum    = vec4(0.0);
+    for (int i = 0; i < factor; i++)
+        sum += texelFetch(sourceTex, first + axis * i, 0);
+    FragColor = sum / float(factor);
+}
\ No newline at end of file
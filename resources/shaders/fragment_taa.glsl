@@ -0,0 +1,126 @@
+/*
+ * Temporal Anti-Aliasing resolve
+ * Blends the jittered current frame into the history, fetched where the
+ * velocity of the scene says the pixel was in the previous frame (Catmull-Rom
+ * filtered, so that reprojection does not blur it frame after frame).
+ * Without a depth buffer, stale history (disocclusions, moving edges) is
+ * rejected by clipping it towards the variance box of the 3x3 neighbourhood of
+ * the current pixel, in YCoCg where the box fits colours more tightly.
+ * Both frames are weighted by their inverse luma, which keeps bright and dark
+ * samples from flickering.
+ */
+
+#version 430 core
+
+in vec2 frag_uv;
+out vec4 FragColor;
+
+uniform sampler2D currentTex;
+uniform sampler2D historyTex;
+// Motion since the previous frame, in texture coordinates
+uniform sampler2D velocityTex;
+// Weight of the current frame (`AA_TAA_FEEDBACK`, 1 to discard a stale history)
+uniform float feedback;
+// Width of the variance box, in standard deviations (`AA_TAA_VARIANCE_GAMMA`)
+uniform float varianceGamma;
+
+vec3 RGBToYCoCg(vec3 c)
+{
+    return vec3(dot(c, vec3(0.25, 0.5, 0.25)),
+                dot(c, vec3(0.5, 0.0, -0.5)),
+                dot(c, vec3(-0.25, 0.5, -0.25)));
+}
+
+vec3 YCoCgToRGB(vec3 c)
+{
+    return vec3(c.x + c.y - c.z, c.x + c.z, c.x - c.y - c.z);
+}
+
+// Catmull-Rom filtering of the history with 9 bilinear taps: the two inner
+// weights of each axis are merged into one linear fetch
+vec3 SampleHistory(vec2 uv, vec2 size)
+{
+    vec2 position = uv * size;
+    vec2 centre   = floor(position - 0.5) + 0.5;
+    vec2 f        = position - centre;
+
+    vec2 w0  = f * (-0.5 + f * (1.0 - 0.5 * f));
+    vec2 w1  = 1.0 + f * f * (-2.5 + 1.5 * f);
+    vec2 w2  = f * (0.5 + f * (2.0 - 1.5 * f));
+    vec2 w3  = f * f * (-0.5 + 0.5 * f);
+    vec2 w12 = w1 + w2;
+
+    vec2 texel = 1.0 / size;
+    vec2 p0    = (centre - 1.0) * texel;
+    vec2 p12   = (centre + w2 / w12) * texel;
+    vec2 p3    = (centre + 2.0) * texel;
+
+    vec3 result = vec3(0.0);
+    result += texture(historyTex, vec2(p0.x, p0.y)).rgb * w0.x * w0.y;
+    result += texture(historyTex, vec2(p12.x, p0.y)).rgb * w12.x * w0.y;
+    result += texture(historyTex, vec2(p3.x, p0.y)).rgb * w3.x * w0.y;
+    result += texture(historyTex, vec2(p0.x, p12.y)).rgb * w0.x * w12.y;
+    result += texture(historyTex, vec2(p12.x, p12.y)).rgb * w12.x * w12.y;
+    result += texture(historyTex, vec2(p3.x, p12.y)).rgb * w3.x * w12.y;
+    result += texture(historyTex, vec2(p0.x, p3.y)).rgb * w0.x * w3.y;
+    result += texture(historyTex, vec2(p12.x, p3.y)).rgb * w12.x * w3.y;
+    result += texture(historyTex, vec2(p3.x, p3.y)).rgb * w3.x * w3.y;
+    return max(result, vec3(0.0));
+}
+
+// Moves `colour` towards the centre of the box until it is inside
+vec3 ClipToBox(vec3 colour, vec3 boxMin, vec3 boxMax)
+{
+    vec3 centre  = 0.5 * (boxMax + boxMin);
+    vec3 extent  = 0.5 * (boxMax - boxMin) + 1e-5;
+    vec3 offset  = colour - centre;
+    vec3 units   = abs(offset / extent);
+    float excess = max(units.x, max(units.y, units.z));
+    return excess > 1.0 ? centre + offset / excess : colour;
+}
+
+void main()
+{
+    ivec2 size  = textureSize(currentTex, 0);
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+
+    // Mean and variance of the neighbourhood, and its longest velocity (so
+    // that the edges of moving objects are reprojected with them)
+    vec3 moment1  = vec3(0.0);
+    vec3 moment2  = vec3(0.0);
+    vec2 velocity = vec2(0.0);
+    for (int y = -1; y <= 1; y++)
+    {
+        for (int x = -1; x <= 1; x++)
+        {
+            ivec2 p  = clamp(pixel + ivec2(x, y), ivec2(0), size - 1);
+            vec3 c   = RGBToYCoCg(texelFetch(currentTex, p, 0).rgb);
+            moment1 += c;
+            moment2 += c * c;
+            vec2 v   = texelFetch(velocityTex, p, 0).rg;
+            if (dot(v, v) > dot(velocity, velocity))
+                velocity = v;
+        }
+    }
+    vec3 mean  = moment1 / 9.0;
+    vec3 sigma = sqrt(max(moment2 / 9.0 - mean * mean, 0.0));
+
+    vec3 current  = RGBToYCoCg(texelFetch(currentTex, pixel, 0).rgb);
+    vec2 previous = frag_uv - velocity;
+    if (any(lessThan(previous, vec2(0.0))) || any(greaterThan(previous, vec2(1.0))))
+    {
+        // The pixel was off screen: there is no history
+        FragColor = vec4(YCoCgToRGB(current), 1.0);
+        return;
+    }
+
+    vec3 history = RGBToYCoCg(SampleHistory(previous, vec2(size)));
+    history      = ClipToBox(
+        history, mean - varianceGamma * sigma, mean + varianceGamma * sigma);
+
+    float currentWeight = feedback / (1.0 + current.x);
+    float historyWeight = (1.0 - feedback) / (1.0 + history.x);
+    vec3 result = (current * currentWeight + history * historyWeight)
+                / (currentWeight + historyWeight);
+    FragColor = vec4(YCoCgToRGB(result), 1.0);
+}
\ No newline at end of file
@@ -1,5 +1,6 @@
 // SMAA Blend Weight Calculation Pass Vertex Shader 
 // Computes offsets for searching the edges detected in the previous pass.
+#include "SMAA.hlsl"
 layout(location = 0) in vec2 aPos;
 layout(location = 1) in vec2 aTexCoords;
 
@@ -1,7 +1,34 @@
 // Passes raw vertex positions directly to clip space without
 #version 430 core
 layout(location = 0) in vec3 pos;
+// Index of the instance in `objects`, offset by the base instance of the draw
+layout(location = 1) in uint object;
+// Transform of an instance (see `aa_batch_object`)
+struct Object
+{
+  vec2 offset;
+  vec2 axis_x;
+  vec2 axis_y;
+};
+layout(std430, binding = 0) readonly buffer Objects
+{
+  Object objects[];
+};
+// Sub-pixel offset in clip space, only set while drawing a jittered reference
+// or a temporal technique
+uniform vec2 u_jitter = vec2(0.0);
+// Motion of the scene in this frame and the previous one (clip space)
+uniform mat2 u_motion          = mat2(1.0);
+uniform mat2 u_previous_motion = mat2(1.0);
+// Screen-space motion since the previous frame, in texture coordinates
+out vec2 v_velocity;
 void main()
 {
-  gl_Position = vec4(pos.x, pos.y, pos.z, 1.0);
+  Object o      = objects[object];
+  vec2 xy       = o.offset + pos.x * o.axis_x + pos.y * o.axis_y;
+  vec2 current  = u_motion * xy;
+  vec2 previous = u_previous_motion * xy;
+  // The motion is linear: the velocity is interpolated exactly
+  v_velocity  = (current - previous) * 0.5;
+  gl_Position = vec4(current + u_jitter, pos.z, 1.0);
 }
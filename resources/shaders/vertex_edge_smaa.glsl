@@ -1,5 +1,6 @@
 // SMAA Edge Detection Pass Vertex Shader 
 // Calculates pixel offsets required for the luma/color edge detection algorithm
+#include "SMAA.hlsl"
 layout(location = 0) in vec2 aPos;
 layout(location = 1) in vec2 aTexCoords;
 
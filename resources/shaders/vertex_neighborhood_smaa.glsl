@@ -1,5 +1,6 @@
 // SMAA Neighborhood Blending Pass Vertex Shader 
 // Prepares texture coordinates for the final resolve pass.
+#include "SMAA.hlsl"
 layout(location = 0) in vec2 aPos;
 layout(location = 1) in vec2 aTexCoords;
 
@@ -0,0 +1,13 @@
+// SMAA Temporal Resolve and Separate Passes Vertex Shader
+// Passes the texture coordinates of the fullscreen quad.
+#include "SMAA.hlsl"
+layout(location = 0) in vec2 aPos;
+layout(location = 1) in vec2 aTexCoords;
+
+out vec2 vTexCoord;
+
+void main()
+{
+    vTexCoord = aTexCoords;
+    gl_Position = vec4(aPos, 0.0, 1.0);
+}
\ No newline at end of file
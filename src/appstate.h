@@ -11,9 +11,20 @@
 #include "gl/vertex_array.h"
 #include "gl/vertex_buffer.h"
 #include "gl/shaders.h"
+#include "gl/shader_assembly.h"
 #include "gl/query.h"
+#include "gl/readback.h"
 #include "dartboard.h"
+#include "stress.h"
 #include "smaa_helper.h"
+#include "cmaa2.h"
+#include "resolve.h"
+#include "fxaa.h"
+#include "cpu/mlaa.h"
+#include "trace.h"
+#include "frame_stats.h"
+#include "reference.h"
+#include "metrics.h"
 
 /// @brief The number of samples to try to capture
 extern uint32_t AA_SAMPLE_COUNT;
@@ -30,16 +41,123 @@ typedef enum
   AA_SMAA_LOW,
   AA_SMAA_MEDIUM,
   AA_SMAA_HIGH,
-  AA_SMAA_ULTRA
+  AA_SMAA_ULTRA,
+  // SMAA with runtime parameters (`aa_smaa_parameters`)
+  AA_SMAA_CUSTOM,
+  // SMAA T2x on the medium preset: jittered frames and temporal resolve
+  AA_SMAA_T2X,
+  // SMAA S2x on the high preset: SMAA 1x on each sample of MSAA x2
+  AA_SMAA_S2X,
+  // SMAA 4x on the high preset: S2x on jittered frames and temporal resolve
+  AA_SMAA_4X,
+  // Temporal anti-aliasing: Halton jitter, reprojected and clipped history
+  AA_TAA,
+  // Conservative morphological anti-aliasing (compute, see `cmaa2.h`)
+  AA_CMAA2,
+  // Morphological anti-aliasing (see `cpu/mlaa.h`), on the GPU and on the CPU
+  AA_MLAA,
+  AA_MLAA_CPU,
+  // Supersampling: the scene drawn `AA_SSAA_SCALE` times larger on each axis
+  // and downsampled (4 and 16 shaded samples per pixel)
+  AA_SSAA_2X,
+  AA_SSAA_4X,
+  // MSAA x4 shading every sample (`GL_SAMPLE_SHADING`) instead of every pixel
+  AA_MSAAx4_SAMPLE_SHADING,
+  // MSAA resolved by a shader with a selectable filter (`resolve.h`)
+  AA_MSAAx4_RESOLVE,
+  AA_MSAAx8_RESOLVE,
+  AA_MSAAx16_RESOLVE
 } aa_algorithm;
 
+/// @brief Scale of the SSAA target on each axis, for SSAA 2x (0) and 4x (1)
+#define AA_SSAA_SCALE(index) (2 << (index))
+
 /// @brief The scene to draw
 typedef enum
 {
   SCENE_TRIANGLE,
-  SCENE_DARTBOARD
+  SCENE_DARTBOARD,
+  // Generated stress scenes (see `stress.h`)
+  SCENE_SIEMENS_STAR,
+  SCENE_GRID,
+  SCENE_SLIVERS,
+  // Number of scenes
+  SCENE_COUNT
 } SceneType;
 
+/// @brief What the scene batch was generated for (see `aa_scene_prepare`)
+typedef struct
+{
+  SceneType scene;
+  aa_scene_parameters parameters;
+  int width;
+  int height;
+} aa_scene_key;
+
+/// @brief A configuration measured by the automation mode
+typedef struct
+{
+  aa_algorithm algorithm;
+  SceneType scene;
+  // Only used by the scalable scenes (dartboard and stress scenes)
+  aa_scene_parameters scene_parameters;
+  // Only used by AA_SMAA_CUSTOM
+  aa_smaa_parameters smaa;
+  // Only used by AA_FXAA_ITERATIVE
+  aa_fxaa_parameters fxaa;
+  // Only used by the custom MSAA resolves
+  aa_resolve_parameters resolve;
+} aa_matrix_cell;
+
+/// @brief A configuration measured by the tuner
+typedef struct
+{
+  aa_matrix_cell cell;
+  // Median GPU time (ms)
+  double gpu_ms;
+  // Quality against the supersampled reference (PSNR, dB)
+  double quality;
+  double ssim;
+} aa_tuning_point;
+
+/// @brief Options parsed from the command line
+typedef struct
+{
+  // Run every algorithm on every scene, save the logs, then close (`--auto`)
+  bool automation_mode;
+  // File receiving the CPU/GPU timeline, NULL if not tracing (`--trace [file]`)
+  const char* trace_file_name;
+  // Skip the UI while recording, and disable multi-viewports (`--isolate`)
+  bool isolate_measurements;
+  // Directory to read shaders from instead of the embedded ones (`--shader-dir`)
+  const char* shader_directory;
+  // File listing the configurations to measure, NULL for the default matrix
+  // (`--matrix <file>`, implies `--auto`)
+  const char* matrix_file_name;
+  // Score the last frame of every configuration against a reference
+  // (`--quality`)
+  bool measure_quality;
+  // Samples per pixel of the reference, 0 for the default (`--reference <n>`)
+  uint32_t reference_samples;
+  // Accumulate jittered passes instead of drawing a supersampled target
+  // (`--reference-jitter`)
+  bool reference_jitter;
+  // Compute the reference from exact coverage on the CPU
+  // (`--reference exact`)
+  bool reference_exact;
+  // Frame-time budget of the tuner in ms, 0 if not tuning (`--tune <ms>`)
+  double tune_budget_ms;
+  // Minimum quality accepted by the tuner, in dB of PSNR (`--quality-floor`)
+  double quality_floor;
+  // Window size, 0 for the default (`--size <width>x<height>`)
+  int window_width;
+  int window_height;
+  // Print the duration of every initialisation phase at exit (`--time-startup`)
+  bool time_startup;
+  // Hidden window, no UI and no font atlas (`--headless`)
+  bool headless;
+} AppOptions;
+
 /// @brief Application state, across frames
 typedef struct
 {
@@ -63,10 +181,6 @@ typedef struct
   aa_algorithm anti_aliasing;
   // The time query responsible for measuring algorithms performance
   aa_time_query query;
-  // The vertex array object for position only vertices
-  aa_vertex_array vao;
-  // The position only vertex buffer object
-  aa_vertex_buffer vbo;
   // The veryex array object for position and uv attributes vertices
   aa_vertex_array fullscreen_vao;
   // The position and uv attributes vertex buffer object
@@ -75,23 +189,60 @@ typedef struct
   aa_program program;
   // Program used to apply FXAA
   aa_program fxaa_program;
-  // Program used to apply FXAA
-  aa_program fxaa_iterative_program;
+  // Programs used to apply iterative FXAA, one per preset (see `fxaa.h`)
+  aa_fxaa_iterative fxaa_iterative;
+  // Program blending the frame into the TAA history
+  aa_program taa_program;
   // Vertex shader which takes as input position only vertices
   aa_fragment_shader default_fragment_shader;
   // Fragment shader which simply draws vertex shader outputs without any additional effect
   aa_vertex_shader default_vertex_shader;
   // Fragment shader containing FXAA post processing algorithm
   aa_fragment_shader fxaa_fragment_shader;
-  // Fragment shader containing FXAA post processing algorithm
-  aa_fragment_shader fxaa_iterative_fragment_shader;
+  aa_fragment_shader taa_fragment_shader;
+  // MLAA passes: edges, blending weights and blending
+  aa_program mlaa_edge_program;
+  aa_program mlaa_weight_program;
+  aa_program mlaa_blend_program;
+  aa_fragment_shader mlaa_edge_fragment_shader;
+  aa_fragment_shader mlaa_weight_fragment_shader;
+  aa_fragment_shader mlaa_blend_fragment_shader;
+  // SSAA downsampling, along the rows then the columns
+  aa_program ssaa_program;
+  aa_fragment_shader ssaa_fragment_shader;
+  // Custom MSAA resolve
+  aa_program resolve_program;
+  aa_fragment_shader resolve_fragment_shader;
+  // Resolve weights of the MSAA x4, x8 and x16 targets, for the current filter
+  aa_resolve_table resolve_tables[3];
   // Vertex shader used to render a texture on the screen
   aa_vertex_shader fullscreen_quad_vertex_shader;
+  // Every compiled shader, shared between programs with identical sources
+  aa_shader_cache shader_cache;
   // SMAA Pipelines (Programs + Shaders bundled)
   aa_smaa_pipeline smaa_low;
   aa_smaa_pipeline smaa_medium;
   aa_smaa_pipeline smaa_high;
   aa_smaa_pipeline smaa_ultra;
+  // SMAA pipeline driven by `smaa_parameters`
+  aa_smaa_custom smaa_custom;
+  // SMAA T2x pipeline (SMAA 1x with reprojection, and the temporal resolve)
+  aa_smaa_temporal smaa_t2x;
+  // SMAA 4x pipeline (high preset), and the separate passes of S2x and 4x
+  aa_smaa_temporal smaa_4x;
+  aa_smaa_separate smaa_separate;
+  aa_smaa_separate smaa_separate_4x;
+  aa_smaa_parameters smaa_parameters;
+  // CMAA2 kernels, images and lists
+  aa_cmaa2 cmaa2;
+  // CPU MLAA, started by its first frame, and its input and output frames
+  // (RGBA8, one after the other)
+  aa_cpu_mlaa cpu_mlaa;
+  uint8_t* cpu_mlaa_pixels;
+  // Parameters of the iterative FXAA program
+  aa_fxaa_parameters fxaa_parameters;
+  // Filter of the custom MSAA resolves
+  aa_resolve_parameters resolve_parameters;
   // Default fbo, with id 0
   aa_frame_buffer default_fbo;
   // MSAA multisampling fbo and textures
@@ -101,32 +252,114 @@ typedef struct
   aa_texture msaa_color_texture_x4;
   aa_texture msaa_color_texture_x8;
   aa_texture msaa_color_texture_x16;
-  // FXAA fbo and screen texture
+  // SSAA 2x and 4x: supersampled scene, and its rows downsampled (as wide as
+  // the window, as high as the scene)
+  aa_frame_buffer ssaa_fbos[2];
+  aa_texture ssaa_color_textures[2];
+  aa_frame_buffer ssaa_row_fbos[2];
+  aa_texture ssaa_row_textures[2];
+  // FXAA, CMAA2 and CPU MLAA fbo and screen texture (processed in place by
+  // CMAA2, overwritten by CPU MLAA)
   aa_frame_buffer fxaa_fbo;
   aa_texture fxaa_color_texture;
-  // FXAA fbo and required textures
+  // SMAA fbo and required textures (also used by the MLAA passes)
   aa_frame_buffer smaa_fbo;
   aa_frame_buffer smaa_edge_fbo;
   aa_frame_buffer smaa_blend_fbo;
   aa_texture smaa_color_texture;
+  // Depth of the scene, only written for the custom SMAA edge detection modes
+  // reading it (see `aa_smaa_edge_mode_depth`)
+  aa_texture smaa_depth_texture;
   aa_texture smaa_area_texture;
   aa_texture smaa_search_texture;
   aa_texture smaa_edge_texture;
   aa_texture smaa_blend_texture;
+  // SMAA T2x and TAA: scene colour (`smaa_color_texture`) and velocity
+  aa_frame_buffer smaa_t2x_fbo;
+  aa_texture smaa_velocity_texture;
+  // SMAA T2x: anti-aliased subsamples, alternately current and previous
+  aa_frame_buffer smaa_history_fbos[2];
+  aa_texture smaa_history_textures[2];
+  // SMAA S2x: scene drawn with MSAA x2, and its separated samples
+  aa_frame_buffer msaa_fbo_x2;
+  aa_texture msaa_color_texture_x2;
+  aa_frame_buffer smaa_separate_fbo;
+  aa_texture smaa_sample_textures[2];
+  // SMAA 4x: multisampled velocity next to the colour, and the separate pass
+  // writing the velocity of the first sample to `smaa_velocity_texture`
+  aa_frame_buffer smaa_4x_fbo;
+  aa_texture msaa_velocity_texture_x2;
+  aa_frame_buffer smaa_separate_4x_fbo;
+  // Offset of the scene and `subsampleIndices` of each sample (see
+  // `aa_smaa_separate_indices`)
+  float smaa_s2x_centre[2];
+  float smaa_s2x_indices[2][4];
+  float smaa_4x_indices[2][2][4];
+  // TAA: history, alternately current and previous (RGBA16F, so that the
+  // small weight of each frame is not lost to rounding)
+  aa_frame_buffer taa_fbos[2];
+  aa_texture taa_history_textures[2];
+  // The history holds the frame `taa_history_frame` (false after a resize, and
+  // until the first TAA frame)
+  bool taa_history_valid;
+  uint64_t taa_history_frame;
   // File in which we write the time values
   const char* current_algorithm_file_name;
+  // Storage of `current_algorithm_file_name` for names built at runtime
+  char custom_file_name[128];
   // samples buffer
   bool is_recording;
   uint64_t samples_total;
   uint64_t samples_current;
   uint32_t* samples;
+  // CPU time spent issuing the algorithm's commands, one per GPU sample (ns)
+  uint32_t* cpu_samples;
+  // GPU time and CPU submit time of the last frame (ns)
+  uint32_t last_gpu_ns;
+  uint32_t last_cpu_submit_ns;
   // Automation flags
   bool automation_mode;
   int warmup_frames;
+  // Configurations measured by the automation mode, and the current one
+  aa_matrix_cell* matrix;
+  size_t matrix_count;
+  size_t matrix_index;
+  // Set by a frame that could not be rendered, drops the configuration
+  bool configuration_failed;
+  // If true, the last recorded frame of a configuration is scored against the
+  // reference, and the background is not animated
+  bool measure_quality;
+  // Supersampled reference images of the scenes
+  aa_reference reference;
+  // Frames captured for `aa_quality_collect`
+  aa_readback readback;
+  // Thread pool and buffers of the metrics, started by the first measure
+  aa_metrics_context metrics;
+  // Scores of the last measured frame (`psnr` negative if not measured)
+  aa_metrics last_quality;
+  // Results of the tuner, one per matrix cell (NULL if not tuning)
+  aa_tuning_point* tuning_points;
+  double tuning_budget_ms;
+  double tuning_quality_floor;
   // The scene to be drawn
   SceneType current_scene;
-  // The dartboard scene data
-  DartboardScene dartboard;
+  // Slices, triangle count and thickness of the scalable scenes, and the spin
+  // of every scene
+  aa_scene_parameters scene_parameters;
+  // Frame the scene is posed at (`frame_count` while drawing, the captured
+  // frame while scoring)
+  uint64_t scene_frame;
+  // Meshes and instances of the current scene, submitted in one call
+  aa_batch scene_batch;
+  aa_scene_key scene_key;
+  // CPU/GPU timeline exported as `trace.json` (enabled by `--trace`)
+  aa_trace trace;
+  // If true, the control panel is not built or drawn while recording samples
+  bool isolate_measurements;
+  // If true, nothing is shown: the UI is neither built nor drawn
+  bool headless;
+  // Recent GPU frame times (in milliseconds) shown by the overlay
+  aa_frame_ring frame_times;
 } AppState;
 
 #endif // !__AA_HG_APPSTATE
@@ -0,0 +1,203 @@
+#include "batch.h"
+#include "gl/error.h"
+#include "gl/extensions.h"
+#include <stdlib.h>
+#include <string.h>
+
+const aa_batch_object AA_BATCH_IDENTITY = {{0.0f, 0.0f}, {1.0f, 0.0f}, {0.0f, 1.0f}};
+
+int aa_batch_geometry_single(
+    aa_batch_geometry* out, float* vertices, uint32_t vertex_count)
+{
+  memset(out, 0, sizeof(aa_batch_geometry));
+  out->commands = malloc(sizeof(aa_batch_command));
+  out->objects  = malloc(sizeof(aa_batch_object));
+  if (vertices == NULL || out->commands == NULL || out->objects == NULL)
+  {
+    free(vertices);
+    aa_batch_geometry_free(out);
+    return -1;
+  }
+  out->vertices                   = vertices;
+  out->vertex_count               = vertex_count;
+  out->commands[0].count          = vertex_count;
+  out->commands[0].instance_count = 1;
+  out->commands[0].first          = 0;
+  out->commands[0].base_instance  = 0;
+  out->command_count              = 1;
+  out->objects[0]                 = AA_BATCH_IDENTITY;
+  out->object_count               = 1;
+  return 0;
+}
+
+float* aa_batch_geometry_expand(
+    const aa_batch_geometry* geometry, uint32_t* vertex_count)
+{
+  size_t count = 0;
+  for (uint32_t c = 0; c < geometry->command_count; c++)
+  {
+    count += (size_t)geometry->commands[c].count
+           * geometry->commands[c].instance_count;
+  }
+  *vertex_count = (uint32_t)count;
+  float* out    = malloc((count ? count : 1) * 3 * sizeof(float));
+  if (out == NULL)
+    return NULL;
+
+  float* vertex = out;
+  for (uint32_t c = 0; c < geometry->command_count; c++)
+  {
+    const aa_batch_command* command = &geometry->commands[c];
+    for (uint32_t i = 0; i < command->instance_count; i++)
+    {
+      const aa_batch_object* object =
+          &geometry->objects[command->base_instance + i];
+      const float* in = geometry->vertices + (size_t)command->first * 3;
+      for (uint32_t v = 0; v < command->count; v++, in += 3, vertex += 3)
+      {
+        vertex[0] = object->offset[0] + in[0] * object->axis_x[0]
+                  + in[1] * object->axis_y[0];
+        vertex[1] = object->offset[1] + in[0] * object->axis_x[1]
+                  + in[1] * object->axis_y[1];
+        vertex[2] = in[2];
+      }
+    }
+  }
+  return out;
+}
+
+void aa_batch_geometry_free(aa_batch_geometry* geometry)
+{
+  free(geometry->vertices);
+  free(geometry->commands);
+  free(geometry->objects);
+  memset(geometry, 0, sizeof(aa_batch_geometry));
+}
+
+/// @brief Makes room for `count` commands in the indirect buffer
+static void aa_batch_reserve_commands(aa_batch* batch, uint32_t count)
+{
+  if (batch->commands != 0 && count <= batch->command_capacity)
+  {
+    // The GPU may still read the persistent commands of the previous frames
+    if (batch->mapped != NULL)
+      glCall(glFinish());
+    return;
+  }
+
+  if (batch->commands != 0)
+  {
+    if (batch->mapped != NULL)
+    {
+      glCall(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, batch->commands));
+      glCall(glUnmapBuffer(GL_DRAW_INDIRECT_BUFFER));
+      batch->mapped = NULL;
+    }
+    glCall(glDeleteBuffers(1, &batch->commands));
+  }
+
+  batch->command_capacity = count;
+  GLsizeiptr size         = (GLsizeiptr)count * sizeof(aa_batch_command);
+  glCall(glGenBuffers(1, &batch->commands));
+  glCall(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, batch->commands));
+  if (aa_gl_ext.buffer_storage)
+  {
+    const GLbitfield FLAGS =
+        GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glCall(aa_gl_ext.BufferStorage(GL_DRAW_INDIRECT_BUFFER, size, NULL, FLAGS));
+    glCall(
+        batch->mapped =
+            glMapBufferRange(GL_DRAW_INDIRECT_BUFFER, 0, size, FLAGS));
+  }
+  else
+  {
+    glCall(glBufferData(GL_DRAW_INDIRECT_BUFFER, size, NULL, GL_STATIC_DRAW));
+  }
+  glCall(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0));
+}
+
+void aa_batch_upload(aa_batch* batch, const aa_batch_geometry* geometry)
+{
+  if (batch->vao.id == 0)
+  {
+    aa_vertex_array_create(&batch->vao);
+    aa_vertex_buffer_create(&batch->vbo);
+    aa_vertex_buffer_create(&batch->indices);
+    glCall(glGenBuffers(1, &batch->objects));
+  }
+
+  aa_vertex_buffer_update(
+      &batch->vbo, geometry->vertices,
+      (size_t)geometry->vertex_count * 3 * sizeof(float));
+  aa_vertex_array_bind(&batch->vao);
+  aa_vertex_buffer_bind(&batch->vbo);
+  aa_vertex_array_position_attribute(&batch->vao);
+
+  uint32_t* indices = malloc(
+      (geometry->object_count ? geometry->object_count : 1) * sizeof(uint32_t));
+  if (indices == NULL)
+  {
+    batch->command_count = 0;
+    return;
+  }
+  for (uint32_t i = 0; i < geometry->object_count; i++)
+    indices[i] = i;
+  aa_vertex_buffer_update(
+      &batch->indices, indices, (size_t)geometry->object_count * sizeof(uint32_t));
+  aa_vertex_array_instance_index_attribute(&batch->vao);
+  free(indices);
+
+  glCall(glBindBuffer(GL_SHADER_STORAGE_BUFFER, batch->objects));
+  glCall(glBufferData(
+      GL_SHADER_STORAGE_BUFFER,
+      (GLsizeiptr)geometry->object_count * sizeof(aa_batch_object),
+      geometry->objects, GL_STATIC_DRAW));
+  glCall(glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0));
+
+  aa_batch_reserve_commands(batch, geometry->command_count);
+  GLsizeiptr size = (GLsizeiptr)geometry->command_count * sizeof(aa_batch_command);
+  if (batch->mapped != NULL)
+  {
+    memcpy(batch->mapped, geometry->commands, (size_t)size);
+  }
+  else
+  {
+    glCall(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, batch->commands));
+    glCall(
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, size, geometry->commands));
+    glCall(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0));
+  }
+  batch->command_count = geometry->command_count;
+}
+
+void aa_batch_render(aa_batch* batch)
+{
+  if (batch->command_count == 0)
+    return;
+  aa_vertex_array_bind(&batch->vao);
+  glCall(glBindBufferBase(
+      GL_SHADER_STORAGE_BUFFER, AA_BATCH_OBJECT_BINDING, batch->objects));
+  glCall(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, batch->commands));
+  glCall(glMultiDrawArraysIndirect(
+      GL_TRIANGLES, NULL, (GLsizei)batch->command_count, 0));
+  glCall(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0));
+}
+
+void aa_batch_delete(aa_batch* batch)
+{
+  if (batch->vao.id == 0)
+    return;
+  if (batch->mapped != NULL)
+  {
+    glCall(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, batch->commands));
+    glCall(glUnmapBuffer(GL_DRAW_INDIRECT_BUFFER));
+    glCall(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0));
+  }
+  if (batch->commands != 0)
+    glCall(glDeleteBuffers(1, &batch->commands));
+  glCall(glDeleteBuffers(1, &batch->objects));
+  aa_vertex_buffer_delete(&batch->indices);
+  aa_vertex_buffer_delete(&batch->vbo);
+  aa_vertex_array_delete(&batch->vao);
+  memset(batch, 0, sizeof(aa_batch));
+}
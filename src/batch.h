@@ -0,0 +1,103 @@
+#ifndef __AA_HG_BATCH
+#define __AA_HG_BATCH
+
+#include <glad/glad.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "gl/vertex_array.h"
+#include "gl/vertex_buffer.h"
+
+// Scene submission through a single multi-draw-indirect call
+// A batch holds every object of a scene: the vertices of its meshes in one
+// vertex buffer, one draw command per mesh (`aa_batch_command`) drawing its
+// instances, and the transform of every instance (`aa_batch_object`) in a
+// shader storage buffer (binding `AA_BATCH_OBJECT_BINDING`). The whole scene
+// is drawn by one `glMultiDrawArraysIndirect`, whatever its number of meshes
+// and instances, so the CPU cost of a scene does not grow with its complexity
+// and the AA passes remain what is measured.
+// OpenGL 4.3 has no `gl_BaseInstance`: every instance finds its transform
+// through an instanced vertex attribute (1) holding 0, 1, 2..., which the
+// `base_instance` of its command offsets.
+// The commands are written into a persistently mapped buffer
+// (GL_ARB_buffer_storage), otherwise into a static buffer.
+
+/// @brief Binding point of the object buffer (see `vertex_default.glsl`)
+#define AA_BATCH_OBJECT_BINDING 0
+
+/// @brief A draw command, laid out like `DrawArraysIndirectCommand`
+typedef struct
+{
+  uint32_t count;
+  uint32_t instance_count;
+  uint32_t first;
+  uint32_t base_instance;
+} aa_batch_command;
+
+/// @brief Transform of an instance, laid out like its std430 counterpart
+/// @details A mesh vertex (x, y) is drawn at
+///          `offset + x * axis_x + y * axis_y` (clip space)
+typedef struct
+{
+  float offset[2];
+  float axis_x[2];
+  float axis_y[2];
+} aa_batch_object;
+
+/// @brief The identity transform
+extern const aa_batch_object AA_BATCH_IDENTITY;
+
+/// @brief Meshes and instances of a scene, on the CPU
+typedef struct
+{
+  // xyz positions of every mesh, one after the other
+  float* vertices;
+  uint32_t vertex_count;
+  // One per mesh: its range of vertices and of objects
+  aa_batch_command* commands;
+  uint32_t command_count;
+  aa_batch_object* objects;
+  uint32_t object_count;
+} aa_batch_geometry;
+
+/// @brief Wraps a single mesh, drawn once untransformed
+/// @param out The geometry, taking ownership of `vertices`
+/// @return 0 on success, -1 on allocation failure (`vertices` is then freed)
+int aa_batch_geometry_single(
+    aa_batch_geometry* out, float* vertices, uint32_t vertex_count);
+
+/// @brief Returns the triangles of a geometry with every instance transformed
+/// @return xyz positions (3 per triangle), to be freed by the caller, or NULL
+///         on failure
+float* aa_batch_geometry_expand(
+    const aa_batch_geometry* geometry, uint32_t* vertex_count);
+
+/// @brief Releases the arrays of a geometry
+void aa_batch_geometry_free(aa_batch_geometry* geometry);
+
+typedef struct
+{
+  aa_vertex_array vao;
+  aa_vertex_buffer vbo;
+  // Instanced object indices (0, 1, 2...)
+  aa_vertex_buffer indices;
+  // Shader storage buffer of the objects
+  unsigned int objects;
+  // Indirect buffer, and its persistent mapping (NULL if not persistent)
+  unsigned int commands;
+  aa_batch_command* mapped;
+  uint32_t command_capacity;
+  uint32_t command_count;
+} aa_batch;
+
+/// @brief Uploads a geometry into a batch
+/// @details The command buffer is kept while it is large enough; overwriting
+///          persistent commands waits for the GPU to be done with them.
+void aa_batch_upload(aa_batch* batch, const aa_batch_geometry* geometry);
+
+/// @brief Draws a batch with the bound program, in a single call
+void aa_batch_render(aa_batch* batch);
+
+/// @brief Deletes the buffers of a batch
+void aa_batch_delete(aa_batch* batch);
+
+#endif // !__AA_HG_BATCH
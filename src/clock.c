@@ -0,0 +1,27 @@
+#include "clock.h"
+
+#ifdef _WIN32
+  #define WIN32_LEAN_AND_MEAN
+  #include <windows.h>
+#else
+  #include <time.h>
+#endif
+
+uint64_t aa_clock_ns(void)
+{
+#ifdef _WIN32
+  static LARGE_INTEGER frequency = {0};
+  LARGE_INTEGER counter;
+  if (frequency.QuadPart == 0)
+    QueryPerformanceFrequency(&frequency);
+  QueryPerformanceCounter(&counter);
+  // Split the conversion to avoid overflowing 64 bits
+  uint64_t ticks = (uint64_t)counter.QuadPart;
+  uint64_t freq  = (uint64_t)frequency.QuadPart;
+  return (ticks / freq) * 1000000000ull + (ticks % freq) * 1000000000ull / freq;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
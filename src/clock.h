@@ -0,0 +1,12 @@
+#ifndef __AA_HG_CLOCK
+#define __AA_HG_CLOCK
+
+#include <stdint.h>
+
+/// @brief Reads a monotonic, high resolution CPU clock
+/// @details Does not depend on GLFW, so it can be used before `glfwInit`
+///          and from any thread.
+/// @return Nanoseconds elapsed since an arbitrary (but fixed) origin
+uint64_t aa_clock_ns(void);
+
+#endif // !__AA_HG_CLOCK
@@ -0,0 +1,129 @@
+#include "cmaa2.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/// @brief Assembles, compiles and links the kernel selected by `define`
+static int aa_cmaa2_kernel(
+    aa_program* program, aa_compute_shader* shader, aa_shader_cache* cache,
+    const char* define)
+{
+  aa_shader_assembly assembly;
+  aa_shader_assembly_begin(&assembly, "#version 430 core\n");
+  aa_shader_assembly_text(&assembly, define);
+  aa_shader_assembly_file(&assembly, "compute_cmaa2.glsl");
+  if (aa_shader_cache_compute(cache, &assembly, shader) != 0)
+    return -1;
+  aa_program_create(program);
+  aa_program_attach_compute(program, shader);
+  aa_program_link_submit(program);
+  return 0;
+}
+
+int aa_cmaa2_init(aa_cmaa2* c, aa_shader_cache* cache)
+{
+  int result = 0;
+  result |= aa_cmaa2_kernel(
+      &c->edges_program, &c->edges_cs, cache, "#define CMAA2_EDGES 1\n");
+  result |= aa_cmaa2_kernel(
+      &c->args_program, &c->args_cs, cache, "#define CMAA2_ARGS 1\n");
+  result |= aa_cmaa2_kernel(
+      &c->process_program, &c->process_cs, cache, "#define CMAA2_PROCESS 1\n");
+  result |= aa_cmaa2_kernel(
+      &c->apply_program, &c->apply_cs, cache, "#define CMAA2_APPLY 1\n");
+  if (result != 0)
+  {
+    printf("Error: Could not assemble CMAA2 kernels\n");
+    return -1;
+  }
+  return 0;
+}
+
+int aa_cmaa2_check(aa_cmaa2* c)
+{
+  return aa_program_link_check(&c->edges_program)
+         | aa_program_link_check(&c->args_program)
+         | aa_program_link_check(&c->process_program)
+         | aa_program_link_check(&c->apply_program);
+}
+
+uint32_t aa_cmaa2_ready(aa_cmaa2* c)
+{
+  return (uint32_t)aa_program_link_ready(&c->edges_program)
+         + (uint32_t)aa_program_link_ready(&c->args_program)
+         + (uint32_t)aa_program_link_ready(&c->process_program)
+         + (uint32_t)aa_program_link_ready(&c->apply_program);
+}
+
+/// @brief (Re)allocates a storage buffer of `size` bytes, left undefined
+static void aa_cmaa2_buffer(unsigned int* buffer, GLsizeiptr size)
+{
+  if (*buffer == 0)
+    glCall(glGenBuffers(1, buffer));
+  glCall(glBindBuffer(GL_SHADER_STORAGE_BUFFER, *buffer));
+  glCall(glBufferData(GL_SHADER_STORAGE_BUFFER, size, NULL, GL_DYNAMIC_COPY));
+}
+
+/// @brief Allocates an unsigned integer image, filled with `zeros`
+static void aa_cmaa2_image(
+    aa_texture* texture, GLenum format, GLenum type, int width, int height,
+    const void* zeros)
+{
+  if (texture->id == 0)
+  {
+    texture->target = GL_TEXTURE_2D;
+    glCall(glGenTextures(1, &texture->id));
+  }
+  texture->format = format;
+  glCall(glBindTexture(GL_TEXTURE_2D, texture->id));
+  glCall(glTexImage2D(
+      GL_TEXTURE_2D, 0, format, width, height, 0, GL_RED_INTEGER, type, zeros));
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+}
+
+int aa_cmaa2_dimensions(aa_cmaa2* c, int width, int height)
+{
+  size_t pixels = (size_t)width * (size_t)height;
+
+  // Every list starts empty, and is emptied again by the apply kernel
+  // (glClearTexImage needs OpenGL 4.4)
+  uint32_t* zeros = calloc(pixels ? pixels : 1, sizeof(uint32_t));
+  c->sized         = zeros != NULL;
+  if (zeros == NULL)
+  {
+    printf("Error: Could not allocate the CMAA2 lists (%dx%d)\n", width, height);
+    return -1;
+  }
+  aa_cmaa2_image(
+      &c->edges_texture, GL_R8UI, GL_UNSIGNED_BYTE, width, height, NULL);
+  aa_cmaa2_image(
+      &c->heads_texture, GL_R32UI, GL_UNSIGNED_INT, width, height, zeros);
+  free(zeros);
+
+  // The counters start at zero, then the args kernel resets them
+  static const uint32_t CONTROL[AA_CMAA2_CONTROL_SIZE / sizeof(uint32_t)] = {0};
+  aa_cmaa2_buffer(&c->control, AA_CMAA2_CONTROL_SIZE);
+  glCall(glBufferSubData(
+      GL_SHADER_STORAGE_BUFFER, 0, AA_CMAA2_CONTROL_SIZE, CONTROL));
+  // A pixel is a candidate and a location at most once
+  aa_cmaa2_buffer(&c->candidates, (GLsizeiptr)(pixels * sizeof(uint32_t)));
+  aa_cmaa2_buffer(&c->locations, (GLsizeiptr)(pixels * sizeof(uint32_t)));
+  // Blends beyond the capacity are dropped
+  c->item_capacity = (uint32_t)(pixels * AA_CMAA2_ITEMS_PER_PIXEL);
+  aa_cmaa2_buffer(
+      &c->items, (GLsizeiptr)c->item_capacity * 2 * sizeof(uint32_t));
+  glCall(glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0));
+  return 0;
+}
+
+void aa_cmaa2_delete(aa_cmaa2* c)
+{
+  aa_program_delete(&c->edges_program);
+  aa_program_delete(&c->args_program);
+  aa_program_delete(&c->process_program);
+  aa_program_delete(&c->apply_program);
+  aa_texture_delete(&c->edges_texture);
+  aa_texture_delete(&c->heads_texture);
+  unsigned int buffers[] = {c->control, c->candidates, c->locations, c->items};
+  glCall(glDeleteBuffers(4, buffers));
+}
@@ -0,0 +1,91 @@
+#ifndef __AA_HG_CMAA2
+#define __AA_HG_CMAA2
+
+#include <glad/glad.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "gl/frame_buffer.h"
+#include "gl/program.h"
+#include "gl/shader_assembly.h"
+
+// Conservative morphological anti-aliasing (after CMAA 2.0), in compute
+// The colour image is processed in place by four kernels of
+// `compute_cmaa2.glsl`:
+// - edges: every pixel with an edge is appended to a candidate list
+// - process (indirect, one thread per candidate): simple shapes and Z shapes
+//   are blended into per-pixel lists, the pixels touched are appended to a
+//   location list
+// - apply (indirect, one thread per location): the lists are averaged into
+//   the image
+// A one-thread kernel turns each list length into dispatch arguments, so the
+// work follows the number of edges instead of the number of pixels.
+
+/// @brief Edge threshold (the high preset of CMAA 2.0)
+#define AA_CMAA2_THRESHOLD 0.07f
+
+/// @brief Blended colours per pixel the item buffer is sized for
+#define AA_CMAA2_ITEMS_PER_PIXEL 2
+
+/// @brief Image units and storage buffer bindings of `compute_cmaa2.glsl`
+enum
+{
+  AA_CMAA2_COLOR_UNIT,
+  AA_CMAA2_EDGES_UNIT,
+  AA_CMAA2_HEADS_UNIT
+};
+enum
+{
+  AA_CMAA2_CONTROL_BINDING,
+  AA_CMAA2_CANDIDATES_BINDING,
+  AA_CMAA2_LOCATIONS_BINDING,
+  AA_CMAA2_ITEMS_BINDING
+};
+
+/// @brief Byte offsets of the dispatch arguments in the control buffer
+#define AA_CMAA2_CANDIDATE_ARGS 20
+#define AA_CMAA2_LOCATION_ARGS  32
+/// @brief Size of the control buffer (counters and dispatch arguments)
+#define AA_CMAA2_CONTROL_SIZE 44
+
+typedef struct
+{
+  aa_program edges_program;
+  aa_program args_program;
+  aa_program process_program;
+  aa_program apply_program;
+
+  // Shaders are owned by the shader cache they were taken from
+  aa_compute_shader edges_cs, args_cs, process_cs, apply_cs;
+
+  // Edges of every pixel (R8UI), and the head of its list (R32UI)
+  aa_texture edges_texture;
+  aa_texture heads_texture;
+  // Storage buffers, see `compute_cmaa2.glsl`
+  unsigned int control;
+  unsigned int candidates;
+  unsigned int locations;
+  unsigned int items;
+  uint32_t item_capacity;
+  // False when the images and buffers could not be allocated for the window
+  bool sized;
+} aa_cmaa2;
+
+/// @brief Submits the compilation and linking of the CMAA2 kernels
+/// @return 0 on success, -1 if a shader could not be assembled
+int aa_cmaa2_init(aa_cmaa2* cmaa2, aa_shader_cache* cache);
+
+/// @brief Waits for the kernels to be linked
+/// @return 0 on success, -1 if a program failed to link
+int aa_cmaa2_check(aa_cmaa2* cmaa2);
+
+/// @brief Counts the kernels that finished linking, without blocking
+uint32_t aa_cmaa2_ready(aa_cmaa2* cmaa2);
+
+/// @brief (Re)allocates the images and buffers for a window size
+/// @return 0 on success, -1 if the empty lists could not be allocated
+int aa_cmaa2_dimensions(aa_cmaa2* cmaa2, int width, int height);
+
+/// @brief Deletes the programs, images and buffers (shaders belong to the cache)
+void aa_cmaa2_delete(aa_cmaa2* cmaa2);
+
+#endif // !__AA_HG_CMAA2
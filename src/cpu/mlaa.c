@@ -0,0 +1,434 @@
+#include "mlaa.h"
+#include "../clock.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+  #define AA_MLAA_X86
+  #include <immintrin.h>
+  #if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+    // MSVC compiles intrinsics of any instruction set
+    #define AA_TARGET_AVX2
+  #else
+    #define AA_TARGET_AVX2 __attribute__((target("avx2")))
+  #endif
+#endif
+
+/// @brief `AA_MLAA_THRESHOLD` in 8-bit steps (an edge differs by more)
+#define AA_MLAA_THRESHOLD_8 ((int)(AA_MLAA_THRESHOLD * 255.0f))
+
+/// @brief Edge bits
+#define AA_MLAA_RIGHT 1u
+#define AA_MLAA_TOP   2u
+
+/// @brief Indices of the neighbour weights of a pixel
+enum
+{
+  AA_MLAA_W_TOP,
+  AA_MLAA_W_BOTTOM,
+  AA_MLAA_W_LEFT,
+  AA_MLAA_W_RIGHT
+};
+
+/// @brief Detects the edges of a row with its right and top neighbours
+/// @param row The row, `width` RGBA8 pixels
+/// @param above The row above, `row` itself for the top row (no edge)
+/// @param edges Receives the edge bits of the row
+typedef void (*aa_mlaa_edges_kernel)(
+    const uint8_t* row, const uint8_t* above, int width, uint8_t* edges);
+
+/// @brief Largest difference between the RGB channels of two pixels
+static int aa_mlaa_difference(const uint8_t* a, const uint8_t* b)
+{
+  int max = 0;
+  for (int c = 0; c < 3; c++)
+  {
+    int d = a[c] > b[c] ? a[c] - b[c] : b[c] - a[c];
+    max   = d > max ? d : max;
+  }
+  return max;
+}
+
+/// @brief Edges of the pixels `first` to `width` of a row
+static void aa_mlaa_edges_range(
+    const uint8_t* row, const uint8_t* above, int first, int width,
+    uint8_t* edges)
+{
+  for (int x = first; x < width; x++)
+  {
+    const uint8_t* p = row + (size_t)x * 4;
+    uint8_t bits     = 0;
+    if (x + 1 < width && aa_mlaa_difference(p, p + 4) > AA_MLAA_THRESHOLD_8)
+      bits |= AA_MLAA_RIGHT;
+    if (aa_mlaa_difference(p, above + (size_t)x * 4) > AA_MLAA_THRESHOLD_8)
+      bits |= AA_MLAA_TOP;
+    edges[x] = bits;
+  }
+}
+
+static void aa_mlaa_edges_scalar(
+    const uint8_t* row, const uint8_t* above, int width, uint8_t* edges)
+{
+  aa_mlaa_edges_range(row, above, 0, width, edges);
+}
+
+#ifdef AA_MLAA_X86
+/// @brief Per pixel, 1 (all bits of the lane) where two sets of 8 pixels
+///        differ by more than the threshold
+AA_TARGET_AVX2 static __m256i aa_mlaa_compare_avx2(__m256i a, __m256i b)
+{
+  const __m256i RGB       = _mm256_set1_epi32(0x00FFFFFF);
+  const __m256i LOW       = _mm256_set1_epi32(0xFF);
+  const __m256i THRESHOLD = _mm256_set1_epi32(AA_MLAA_THRESHOLD_8);
+  __m256i d = _mm256_or_si256(_mm256_subs_epu8(a, b), _mm256_subs_epu8(b, a));
+  d         = _mm256_and_si256(d, RGB);
+  __m256i m = _mm256_max_epu8(d, _mm256_srli_epi32(d, 8));
+  m         = _mm256_max_epu8(m, _mm256_srli_epi32(d, 16));
+  return _mm256_cmpgt_epi32(_mm256_and_si256(m, LOW), THRESHOLD);
+}
+
+AA_TARGET_AVX2 static void aa_mlaa_edges_avx2(
+    const uint8_t* row, const uint8_t* above, int width, uint8_t* edges)
+{
+  int x = 0;
+  // The right neighbours of the last pixel of a vector are read too
+  for (; x + 8 < width; x += 8)
+  {
+    const uint8_t* p = row + (size_t)x * 4;
+    __m256i centre   = _mm256_loadu_si256((const __m256i*)p);
+    __m256i right    = _mm256_loadu_si256((const __m256i*)(p + 4));
+    __m256i top = _mm256_loadu_si256((const __m256i*)(above + (size_t)x * 4));
+    int right_mask =
+        _mm256_movemask_ps(_mm256_castsi256_ps(aa_mlaa_compare_avx2(centre, right)));
+    int top_mask =
+        _mm256_movemask_ps(_mm256_castsi256_ps(aa_mlaa_compare_avx2(centre, top)));
+    for (int i = 0; i < 8; i++)
+    {
+      edges[x + i] = (uint8_t)(((right_mask >> i) & 1) * AA_MLAA_RIGHT
+                               | ((top_mask >> i) & 1) * AA_MLAA_TOP);
+    }
+  }
+  aa_mlaa_edges_range(row, above, x, width, edges);
+}
+
+/// @brief Checks that the CPU and the OS support AVX2
+static bool aa_mlaa_has_avx2(void)
+{
+  #if defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7)
+    return false;
+  __cpuid(info, 1);
+  bool osxsave = (info[2] & (1 << 27)) != 0;
+  __cpuidex(info, 7, 0);
+  bool avx2 = (info[1] & (1 << 5)) != 0;
+  // The OS must save the YMM registers
+  return avx2 && osxsave && (_xgetbv(0) & 6) == 6;
+  #else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+  #endif
+}
+#endif
+
+/// @brief The kernel, picked once by `aa_cpu_mlaa_init`
+static aa_mlaa_edges_kernel aa_mlaa_edges = aa_mlaa_edges_scalar;
+
+/// @brief A pass over the bands of an image
+typedef struct
+{
+  aa_cpu_mlaa* context;
+  const uint8_t* in;
+  uint8_t* out;
+  int width;
+  int height;
+  // Number of bands of rows, the bands of columns come after them
+  uint32_t row_bands;
+} aa_mlaa_pass;
+
+static uint32_t aa_mlaa_band_count(int size)
+{
+  if (size <= 0)
+    return 0;
+  return (uint32_t)((size + AA_MLAA_BAND - 1) / AA_MLAA_BAND);
+}
+
+static void aa_mlaa_edges_task(void* data, uint32_t task, uint32_t worker)
+{
+  (void)worker;
+  aa_mlaa_pass* pass = data;
+  int first          = (int)task * AA_MLAA_BAND;
+  int last           = first + AA_MLAA_BAND;
+  last               = last < pass->height ? last : pass->height;
+  size_t stride      = (size_t)pass->width * 4;
+  for (int y = first; y < last; y++)
+  {
+    const uint8_t* row   = pass->in + y * stride;
+    const uint8_t* above = y + 1 < pass->height ? row + stride : row;
+    uint8_t* edges       = pass->context->edges + (size_t)y * pass->width;
+    aa_mlaa_edges(row, above, pass->width, edges);
+  }
+  memset(
+      pass->context->weights + (size_t)first * pass->width * 4, 0,
+      (size_t)(last - first) * pass->width * 4 * sizeof(float));
+}
+
+/// @brief Height of the end of a run: -0.5 if the edge steps off it on the
+///        negative side, 0.5 on the positive side, 0 on both or neither
+static float aa_mlaa_end(bool negative, bool positive)
+{
+  if (negative == positive)
+    return 0.0f;
+  return negative ? -0.5f : 0.5f;
+}
+
+/// @brief Areas of pixel `i` of a run of `length` edges on the positive and
+///        negative side of the line going from `left` at the start of the run
+///        to 0 in its middle and `right` at its end
+static void aa_mlaa_area(
+    float left, float right, int length, int i, float* positive,
+    float* negative)
+{
+  float middle = 0.5f * (float)length;
+  float a      = (float)i;
+  float b      = (float)(i + 1);
+  // Signed area of each half of the pixel, the line does not cross the edge
+  // within a half
+  float area_left  = 0.0f;
+  float area_right = 0.0f;
+  if (a < middle)
+  {
+    float end = b < middle ? b : middle;
+    area_left = 0.5f * left * ((1.0f - a / middle) + (1.0f - end / middle))
+                * (end - a);
+  }
+  if (b > middle)
+  {
+    float start = a > middle ? a : middle;
+    area_right  = 0.5f * right
+                 * ((start / middle - 1.0f) + (b / middle - 1.0f)) * (b - start);
+  }
+  *positive = (area_left > 0.0f ? area_left : 0.0f)
+              + (area_right > 0.0f ? area_right : 0.0f);
+  *negative = (area_left < 0.0f ? -area_left : 0.0f)
+              + (area_right < 0.0f ? -area_right : 0.0f);
+}
+
+/// @brief Edge bits of a pixel, 0 outside the image
+static uint8_t aa_mlaa_edge(const aa_mlaa_pass* pass, int x, int y)
+{
+  if (x < 0 || y < 0 || x >= pass->width || y >= pass->height)
+    return 0;
+  return pass->context->edges[(size_t)y * pass->width + x];
+}
+
+/// @brief Follows the runs of top edges of row `y`, weighting the pixels on
+///        both sides (the positive side is the row above)
+static void aa_mlaa_row(const aa_mlaa_pass* pass, int y)
+{
+  float* weights = pass->context->weights;
+  int x          = 0;
+  while (x < pass->width)
+  {
+    if ((aa_mlaa_edge(pass, x, y) & AA_MLAA_TOP) == 0)
+    {
+      x++;
+    }
+    else
+    {
+      int start = x;
+      while (x < pass->width && (aa_mlaa_edge(pass, x, y) & AA_MLAA_TOP) != 0)
+        x++;
+      float left = aa_mlaa_end(
+          aa_mlaa_edge(pass, start - 1, y) & AA_MLAA_RIGHT,
+          aa_mlaa_edge(pass, start - 1, y + 1) & AA_MLAA_RIGHT);
+      float right = aa_mlaa_end(
+          aa_mlaa_edge(pass, x - 1, y) & AA_MLAA_RIGHT,
+          aa_mlaa_edge(pass, x - 1, y + 1) & AA_MLAA_RIGHT);
+      for (int i = 0; i < x - start; i++)
+      {
+        float positive, negative;
+        aa_mlaa_area(left, right, x - start, i, &positive, &negative);
+        size_t below = (size_t)y * pass->width + start + i;
+        weights[below * 4 + AA_MLAA_W_TOP] = negative;
+        weights[(below + pass->width) * 4 + AA_MLAA_W_BOTTOM] = positive;
+      }
+    }
+  }
+}
+
+/// @brief Follows the runs of right edges of column `x`, weighting the pixels
+///        on both sides (the positive side is the column on the right)
+static void aa_mlaa_column(const aa_mlaa_pass* pass, int x)
+{
+  float* weights = pass->context->weights;
+  int y          = 0;
+  while (y < pass->height)
+  {
+    if ((aa_mlaa_edge(pass, x, y) & AA_MLAA_RIGHT) == 0)
+    {
+      y++;
+    }
+    else
+    {
+      int start = y;
+      while (y < pass->height && (aa_mlaa_edge(pass, x, y) & AA_MLAA_RIGHT) != 0)
+        y++;
+      float bottom = aa_mlaa_end(
+          aa_mlaa_edge(pass, x, start - 1) & AA_MLAA_TOP,
+          aa_mlaa_edge(pass, x + 1, start - 1) & AA_MLAA_TOP);
+      float top = aa_mlaa_end(
+          aa_mlaa_edge(pass, x, y - 1) & AA_MLAA_TOP,
+          aa_mlaa_edge(pass, x + 1, y - 1) & AA_MLAA_TOP);
+      for (int i = 0; i < y - start; i++)
+      {
+        float positive, negative;
+        aa_mlaa_area(bottom, top, y - start, i, &positive, &negative);
+        size_t left = (size_t)(start + i) * pass->width + x;
+        weights[left * 4 + AA_MLAA_W_RIGHT]      = negative;
+        weights[(left + 1) * 4 + AA_MLAA_W_LEFT] = positive;
+      }
+    }
+  }
+}
+
+/// @brief Rows write the top and bottom weights, columns the left and right
+///        ones: both kinds of bands run at the same time
+static void aa_mlaa_shapes_task(void* data, uint32_t task, uint32_t worker)
+{
+  (void)worker;
+  aa_mlaa_pass* pass = data;
+  bool rows          = task < pass->row_bands;
+  int size           = rows ? pass->height : pass->width;
+  int first          = (int)(rows ? task : task - pass->row_bands) * AA_MLAA_BAND;
+  int last           = first + AA_MLAA_BAND;
+  last               = last < size ? last : size;
+  for (int i = first; i < last; i++)
+  {
+    if (rows)
+      aa_mlaa_row(pass, i);
+    else
+      aa_mlaa_column(pass, i);
+  }
+}
+
+static void aa_mlaa_blend_task(void* data, uint32_t task, uint32_t worker)
+{
+  (void)worker;
+  aa_mlaa_pass* pass = data;
+  int first          = (int)task * AA_MLAA_BAND;
+  int last           = first + AA_MLAA_BAND;
+  last               = last < pass->height ? last : pass->height;
+  int width          = pass->width;
+  for (int y = first; y < last; y++)
+  {
+    for (int x = 0; x < width; x++)
+    {
+      size_t i         = (size_t)y * width + x;
+      const float* w   = pass->context->weights + i * 4;
+      const uint8_t* c = pass->in + i * 4;
+      uint8_t* out     = pass->out + i * 4;
+      float total = w[AA_MLAA_W_TOP] + w[AA_MLAA_W_BOTTOM] + w[AA_MLAA_W_LEFT]
+                  + w[AA_MLAA_W_RIGHT];
+      if (total <= 0.0f)
+      {
+        memcpy(out, c, 4);
+      }
+      else
+      {
+        // Weights only exist towards neighbours inside the image
+        const uint8_t* neighbours[4] = {
+            c + (size_t)width * 4 * (y + 1 < pass->height),
+            c - (size_t)width * 4 * (y > 0), c - 4 * (x > 0),
+            c + 4 * (x + 1 < width)};
+        float scale = total > 1.0f ? 1.0f / total : 1.0f;
+        for (int k = 0; k < 4; k++)
+        {
+          float value = (float)c[k] * (1.0f - total * scale);
+          for (int n = 0; n < 4; n++)
+            value += (float)neighbours[n][k] * w[n] * scale;
+          out[k] = (uint8_t)(value + 0.5f);
+        }
+      }
+    }
+  }
+}
+
+int aa_cpu_mlaa_init(aa_cpu_mlaa* context, uint32_t thread_count)
+{
+  memset(context, 0, sizeof(aa_cpu_mlaa));
+  // Still usable with fewer threads
+  aa_thread_pool_init(&context->pool, thread_count);
+  if (context->pool.shared == NULL)
+    return -1;
+#ifdef AA_MLAA_X86
+  context->avx2 = aa_mlaa_has_avx2();
+  if (context->avx2)
+    aa_mlaa_edges = aa_mlaa_edges_avx2;
+#endif
+  context->initialized = true;
+  return 0;
+}
+
+/// @brief Sizes the buffers for a resolution
+/// @return 0 on success, -1 on allocation failure
+static int aa_cpu_mlaa_resize(aa_cpu_mlaa* context, int width, int height)
+{
+  if (context->width == width && context->height == height)
+    return 0;
+  free(context->edges);
+  free(context->weights);
+  context->edges   = NULL;
+  context->weights = NULL;
+  context->width   = 0;
+  context->height  = 0;
+  if (width <= 0 || height <= 0)
+    return 0;
+
+  size_t pixels    = (size_t)width * height;
+  context->edges   = malloc(pixels);
+  context->weights = malloc(pixels * 4 * sizeof(float));
+  if (context->edges == NULL || context->weights == NULL)
+    return -1;
+  context->width  = width;
+  context->height = height;
+  return 0;
+}
+
+int aa_cpu_mlaa_apply(
+    aa_cpu_mlaa* context, const uint8_t* in, uint8_t* out, int width,
+    int height)
+{
+  uint64_t begin_ns = aa_clock_ns();
+  if (width <= 0 || height <= 0 || aa_cpu_mlaa_resize(context, width, height) != 0)
+    return -1;
+
+  aa_mlaa_pass pass;
+  pass.context   = context;
+  pass.in        = in;
+  pass.out       = out;
+  pass.width     = width;
+  pass.height    = height;
+  pass.row_bands = aa_mlaa_band_count(height);
+
+  aa_thread_pool_run(&context->pool, aa_mlaa_edges_task, &pass, pass.row_bands);
+  aa_thread_pool_run(
+      &context->pool, aa_mlaa_shapes_task, &pass,
+      pass.row_bands + aa_mlaa_band_count(width));
+  aa_thread_pool_run(&context->pool, aa_mlaa_blend_task, &pass, pass.row_bands);
+
+  context->last_duration_ns = aa_clock_ns() - begin_ns;
+  return 0;
+}
+
+void aa_cpu_mlaa_delete(aa_cpu_mlaa* context)
+{
+  if (!context->initialized)
+    return;
+  aa_thread_pool_delete(&context->pool);
+  // Frees every buffer
+  aa_cpu_mlaa_resize(context, 0, 0);
+  context->initialized = false;
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#ifndef __AA_HG_CPU_MLAA
+#define __AA_HG_CPU_MLAA
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "../thread_pool.h"
+
+// Morphological anti-aliasing (Reshetov 2009), on the CPU
+// Works on any RGBA8 image, bottom row first (a frame read back from the GPU
+// as well as an offline render):
+// - edges: a pixel and its right (top) neighbour are separated by an edge when
+//   one of their colour channels differs by more than `AA_MLAA_THRESHOLD`,
+// - shapes: every run of edges along a row (column) is followed once, and
+//   each end is classified by the edge stepping off it, on one side or the
+//   other or neither. The silhouette is reconstructed as a line from the
+//   middle of each step to the middle of the run, and the area of every pixel
+//   of the run on the far side of that line gives the weight of its
+//   neighbour across the run,
+// - blending: every pixel is mixed with its four neighbours by their weights.
+// `fragment_mlaa_*.glsl` computes the same areas per pixel on the GPU, with
+// neither the search nor the area lookup tables of SMAA.
+// Every pass runs on bands of rows (columns) spread over a thread pool, and
+// edge detection uses AVX2 when the CPU supports it (checked at runtime).
+
+/// @brief Smallest colour difference, per channel, making an edge
+#define AA_MLAA_THRESHOLD 0.1f
+/// @brief Number of rows (columns) in a task
+#define AA_MLAA_BAND 32
+
+typedef struct
+{
+  aa_thread_pool pool;
+  bool initialized;
+  // True if the AVX2 kernel detects the edges
+  bool avx2;
+  // Resolution the buffers are allocated for
+  int width;
+  int height;
+  // Bit 0: edge with the right neighbour, bit 1: edge with the top neighbour
+  uint8_t* edges;
+  // Weights of the top, bottom, left and right neighbours of every pixel
+  float* weights;
+  // Duration of the last `aa_cpu_mlaa_apply`
+  uint64_t last_duration_ns;
+} aa_cpu_mlaa;
+
+/// @brief Starts the thread pool and picks the kernels
+/// @param context The context
+/// @param thread_count Number of threads, 0 for one per logical processor
+/// @return 0 on success, -1 on failure
+int aa_cpu_mlaa_init(aa_cpu_mlaa* context, uint32_t thread_count);
+
+/// @brief Anti-aliases an image
+/// @param context The context (buffers grow with the resolution)
+/// @param in RGBA8 pixels
+/// @param out Receives the anti-aliased RGBA8 pixels (not `in`)
+/// @param width Width of both images
+/// @param height Height of both images
+/// @return 0 on success, -1 on allocation failure
+int aa_cpu_mlaa_apply(
+    aa_cpu_mlaa* context, const uint8_t* in, uint8_t* out, int width,
+    int height);
+
+/// @brief Stops the thread pool and releases the buffers
+void aa_cpu_mlaa_delete(aa_cpu_mlaa* context);
+
+#endif // !__AA_HG_CPU_MLAA
\ No newline at end of file
@@ -0,0 +1,320 @@
+#include "raster.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// @brief Maximum number of vertices of a pixel square clipped by a triangle
+#define AA_CPU_RASTER_MAX_POLYGON 8
+
+typedef struct
+{
+  // Edge functions a * x + b * y + c, positive inside (pixel units)
+  double a[3];
+  double b[3];
+  double c[3];
+  // Pixel bounds, inclusive
+  int min_x;
+  int min_y;
+  int max_x;
+  int max_y;
+} aa_cpu_raster_triangle;
+
+typedef struct
+{
+  const aa_cpu_raster_triangle* triangles;
+  // Triangles of each tile: `bins[offsets[t]]` to `bins[offsets[t + 1]]`
+  const uint32_t* offsets;
+  const uint32_t* bins;
+  int tiles_x;
+  int width;
+  int height;
+  float* coverage;
+} aa_cpu_raster_pass;
+
+/// @brief Sets up the edge functions and bounds of a triangle
+/// @return false if the triangle is degenerate or outside the image
+static bool aa_cpu_raster_setup(
+    aa_cpu_raster_triangle* out, const float* positions, int width, int height)
+{
+  double x[3];
+  double y[3];
+  for (int i = 0; i < 3; i++)
+  {
+    x[i] = ((double)positions[i * 3 + 0] + 1.0) * 0.5 * width;
+    y[i] = ((double)positions[i * 3 + 1] + 1.0) * 0.5 * height;
+  }
+  double area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+  if (area == 0.0 || !isfinite(area))
+    return false;
+
+  // Counter-clockwise triangles are inside on the left of their edges
+  double sign = area > 0.0 ? 1.0 : -1.0;
+  for (int i = 0; i < 3; i++)
+  {
+    int j     = (i + 1) % 3;
+    out->a[i] = -(y[j] - y[i]) * sign;
+    out->b[i] = (x[j] - x[i]) * sign;
+    out->c[i] = -(out->a[i] * x[i] + out->b[i] * y[i]);
+  }
+
+  double min_x = fmin(x[0], fmin(x[1], x[2]));
+  double min_y = fmin(y[0], fmin(y[1], y[2]));
+  double max_x = fmax(x[0], fmax(x[1], x[2]));
+  double max_y = fmax(y[0], fmax(y[1], y[2]));
+  if (max_x <= 0.0 || max_y <= 0.0 || min_x >= width || min_y >= height)
+    return false;
+  out->min_x = min_x < 0.0 ? 0 : (int)floor(min_x);
+  out->min_y = min_y < 0.0 ? 0 : (int)floor(min_y);
+  out->max_x = max_x > width ? width - 1 : (int)ceil(max_x) - 1;
+  out->max_y = max_y > height ? height - 1 : (int)ceil(max_y) - 1;
+  return out->min_x <= out->max_x && out->min_y <= out->max_y;
+}
+
+/// @brief Area of the pixel square clipped by the edges it straddles
+/// @param triangle The triangle
+/// @param offsets Edge functions at the bottom left corner of the pixel
+/// @param clipped Which edges cross the pixel
+static double aa_cpu_raster_clipped_area(
+    const aa_cpu_raster_triangle* triangle, const double offsets[3],
+    const bool clipped[3])
+{
+  // Pixel-local coordinates, the square is [0, 1]^2
+  double u[2][AA_CPU_RASTER_MAX_POLYGON] = {{0.0, 1.0, 1.0, 0.0}};
+  double v[2][AA_CPU_RASTER_MAX_POLYGON] = {{0.0, 0.0, 1.0, 1.0}};
+  int count                              = 4;
+  int current                            = 0;
+
+  for (int e = 0; e < 3 && count > 0; e++)
+  {
+    if (!clipped[e])
+      continue;
+    const double A = triangle->a[e];
+    const double B = triangle->b[e];
+    const double C = offsets[e];
+    const double* pu = u[current];
+    const double* pv = v[current];
+    double* qu       = u[1 - current];
+    double* qv       = v[1 - current];
+    int kept         = 0;
+    for (int i = 0; i < count; i++)
+    {
+      int j     = (i + 1) % count;
+      double ei = A * pu[i] + B * pv[i] + C;
+      double ej = A * pu[j] + B * pv[j] + C;
+      if (ei >= 0.0)
+      {
+        qu[kept] = pu[i];
+        qv[kept] = pv[i];
+        kept++;
+      }
+      if ((ei >= 0.0) != (ej >= 0.0))
+      {
+        double t = ei / (ei - ej);
+        qu[kept] = pu[i] + t * (pu[j] - pu[i]);
+        qv[kept] = pv[i] + t * (pv[j] - pv[i]);
+        kept++;
+      }
+    }
+    count   = kept;
+    current = 1 - current;
+  }
+
+  // Shoelace formula
+  double area = 0.0;
+  for (int i = 0; i < count; i++)
+  {
+    int j = (i + 1) % count;
+    area += u[current][i] * v[current][j] - u[current][j] * v[current][i];
+  }
+  return 0.5 * area;
+}
+
+/// @brief Adds the coverage of a triangle to the pixels of a tile
+static void aa_cpu_raster_triangle_tile(
+    const aa_cpu_raster_pass* pass, const aa_cpu_raster_triangle* triangle,
+    int tile_x, int tile_y)
+{
+  int x0 = tile_x * AA_CPU_RASTER_TILE;
+  int y0 = tile_y * AA_CPU_RASTER_TILE;
+  int x1 = x0 + AA_CPU_RASTER_TILE - 1;
+  int y1 = y0 + AA_CPU_RASTER_TILE - 1;
+  x0     = triangle->min_x > x0 ? triangle->min_x : x0;
+  y0     = triangle->min_y > y0 ? triangle->min_y : y0;
+  x1     = triangle->max_x < x1 ? triangle->max_x : x1;
+  y1     = triangle->max_y < y1 ? triangle->max_y : y1;
+
+  // Half extent of the pixel square along each edge normal
+  double radius[3];
+  for (int e = 0; e < 3; e++)
+    radius[e] = 0.5 * (fabs(triangle->a[e]) + fabs(triangle->b[e]));
+
+  for (int y = y0; y <= y1; y++)
+  {
+    float* row = pass->coverage + (size_t)y * pass->width;
+    for (int x = x0; x <= x1; x++)
+    {
+      double offsets[3];
+      bool clipped[3];
+      bool outside = false;
+      bool inside  = true;
+      for (int e = 0; e < 3; e++)
+      {
+        offsets[e] = triangle->a[e] * x + triangle->b[e] * y + triangle->c[e];
+        double centre =
+            offsets[e] + 0.5 * (triangle->a[e] + triangle->b[e]);
+        outside |= centre + radius[e] <= 0.0;
+        clipped[e] = centre - radius[e] < 0.0;
+        inside &= !clipped[e];
+      }
+      if (outside)
+        continue;
+      if (inside)
+        row[x] += 1.0f;
+      else
+        row[x] += (float)aa_cpu_raster_clipped_area(triangle, offsets, clipped);
+    }
+  }
+}
+
+static void aa_cpu_raster_tile_task(void* argument, uint32_t task, uint32_t worker)
+{
+  (void)worker;
+  const aa_cpu_raster_pass* pass = argument;
+  int tile_x = (int)task % pass->tiles_x;
+  int tile_y = (int)task / pass->tiles_x;
+  int x0     = tile_x * AA_CPU_RASTER_TILE;
+  int y0     = tile_y * AA_CPU_RASTER_TILE;
+  int x1     = x0 + AA_CPU_RASTER_TILE > pass->width ? pass->width
+                                                     : x0 + AA_CPU_RASTER_TILE;
+  int y1     = y0 + AA_CPU_RASTER_TILE > pass->height ? pass->height
+                                                      : y0 + AA_CPU_RASTER_TILE;
+
+  for (int y = y0; y < y1; y++)
+  {
+    memset(
+        pass->coverage + (size_t)y * pass->width + x0, 0,
+        (size_t)(x1 - x0) * sizeof(float));
+  }
+  for (uint32_t i = pass->offsets[task]; i < pass->offsets[task + 1]; i++)
+  {
+    aa_cpu_raster_triangle_tile(
+        pass, &pass->triangles[pass->bins[i]], tile_x, tile_y);
+  }
+  // Overlapping triangles cannot cover more than the whole pixel
+  for (int y = y0; y < y1; y++)
+  {
+    float* row = pass->coverage + (size_t)y * pass->width;
+    for (int x = x0; x < x1; x++)
+      row[x] = row[x] > 1.0f ? 1.0f : row[x];
+  }
+}
+
+/// @brief Bins the visible triangles into the tiles
+/// @param triangles Receives the set up triangles
+/// @param offsets Receives the start of the bin of each tile, and the total
+/// @return The bins (indices in `triangles`), or NULL on allocation failure
+static uint32_t* aa_cpu_raster_bin(
+    aa_cpu_raster_triangle* triangles, uint32_t* offsets,
+    const float* positions, uint32_t triangle_count, int width, int height)
+{
+  const int TILES_X    = (width + AA_CPU_RASTER_TILE - 1) / AA_CPU_RASTER_TILE;
+  const int TILES_Y    = (height + AA_CPU_RASTER_TILE - 1) / AA_CPU_RASTER_TILE;
+  const uint32_t TILES = (uint32_t)(TILES_X * TILES_Y);
+
+  // Counts the triangles of each tile, keeping only the visible ones
+  uint32_t visible = 0;
+  for (uint32_t i = 0; i < triangle_count; i++)
+  {
+    aa_cpu_raster_triangle* triangle = &triangles[visible];
+    if (!aa_cpu_raster_setup(triangle, positions + i * 9, width, height))
+      continue;
+    visible++;
+    for (int ty = triangle->min_y / AA_CPU_RASTER_TILE;
+         ty <= triangle->max_y / AA_CPU_RASTER_TILE; ty++)
+    {
+      for (int tx = triangle->min_x / AA_CPU_RASTER_TILE;
+           tx <= triangle->max_x / AA_CPU_RASTER_TILE; tx++)
+        offsets[ty * TILES_X + tx + 1]++;
+    }
+  }
+  for (uint32_t t = 0; t < TILES; t++)
+    offsets[t + 1] += offsets[t];
+
+  uint32_t* bins    = malloc((offsets[TILES] + 1) * sizeof(uint32_t));
+  uint32_t* cursors = malloc(TILES * sizeof(uint32_t));
+  if (bins == NULL || cursors == NULL)
+  {
+    free(bins);
+    free(cursors);
+    return NULL;
+  }
+  // Keeps the triangles of a tile in submission order
+  memcpy(cursors, offsets, TILES * sizeof(uint32_t));
+  for (uint32_t i = 0; i < visible; i++)
+  {
+    const aa_cpu_raster_triangle* triangle = &triangles[i];
+    for (int ty = triangle->min_y / AA_CPU_RASTER_TILE;
+         ty <= triangle->max_y / AA_CPU_RASTER_TILE; ty++)
+    {
+      for (int tx = triangle->min_x / AA_CPU_RASTER_TILE;
+           tx <= triangle->max_x / AA_CPU_RASTER_TILE; tx++)
+        bins[cursors[ty * TILES_X + tx]++] = i;
+    }
+  }
+  free(cursors);
+  return bins;
+}
+
+int aa_cpu_raster_coverage(
+    aa_thread_pool* pool, const float* positions, uint32_t vertex_count,
+    int width, int height, float* coverage)
+{
+  if (width <= 0 || height <= 0)
+    return 0;
+
+  const int TILES_X       = (width + AA_CPU_RASTER_TILE - 1) / AA_CPU_RASTER_TILE;
+  const int TILES_Y       = (height + AA_CPU_RASTER_TILE - 1) / AA_CPU_RASTER_TILE;
+  const uint32_t TILES    = (uint32_t)(TILES_X * TILES_Y);
+  uint32_t triangle_count = vertex_count / 3;
+
+  aa_cpu_raster_triangle* triangles =
+      malloc((triangle_count + 1) * sizeof(aa_cpu_raster_triangle));
+  uint32_t* offsets = calloc(TILES + 1, sizeof(uint32_t));
+  uint32_t* bins    = NULL;
+  if (triangles != NULL && offsets != NULL)
+  {
+    bins = aa_cpu_raster_bin(
+        triangles, offsets, positions, triangle_count, width, height);
+  }
+  if (bins == NULL)
+  {
+    free(triangles);
+    free(offsets);
+    return -1;
+  }
+
+  aa_cpu_raster_pass pass = {
+      .triangles = triangles,
+      .offsets   = offsets,
+      .bins      = bins,
+      .tiles_x   = TILES_X,
+      .width     = width,
+      .height    = height,
+      .coverage  = coverage,
+  };
+  if (pool != NULL)
+  {
+    aa_thread_pool_run(pool, aa_cpu_raster_tile_task, &pass, TILES);
+  }
+  else
+  {
+    for (uint32_t t = 0; t < TILES; t++)
+      aa_cpu_raster_tile_task(&pass, t, 0);
+  }
+
+  free(triangles);
+  free(offsets);
+  free(bins);
+  return 0;
+}
@@ -0,0 +1,36 @@
+#ifndef __AA_HG_CPU_RASTER
+#define __AA_HG_CPU_RASTER
+
+#include <stdint.h>
+#include "../thread_pool.h"
+
+// Analytic-coverage rasterisation, on the CPU
+// Every pixel receives the exact area of the pixel square covered by the
+// triangles, i.e. the value an infinitely supersampled box filter would give,
+// with no sampling noise at all: the ground truth of anti-aliasing.
+// Triangles are binned into tiles of `AA_CPU_RASTER_TILE` pixels, and the
+// tiles are rasterised in parallel on a thread pool. Inside a tile, the edge
+// functions classify each pixel of a triangle's bounds as fully inside, fully
+// outside, or crossed by an edge; only crossed pixels are clipped against the
+// triangle (Sutherland-Hodgman, in doubles) to measure their covered area.
+// Coverages of overlapping triangles add up, and are clamped to 1.
+
+/// @brief Side of a tile in pixels
+#define AA_CPU_RASTER_TILE 32
+
+/// @brief Computes the exact coverage of a set of triangles
+/// @param pool Thread pool running the tiles, NULL to run them on the calling
+///        thread
+/// @param positions xyz positions in clip space (z is ignored), 3 vertices per
+///        triangle, mapped to the pixels like the default viewport would
+/// @param vertex_count Number of vertices
+/// @param width Width of the image
+/// @param height Height of the image
+/// @param coverage Receives `width` * `height` coverages in [0, 1], bottom row
+///        first (like `glReadPixels`)
+/// @return 0 on success, -1 on allocation failure
+int aa_cpu_raster_coverage(
+    aa_thread_pool* pool, const float* positions, uint32_t vertex_count,
+    int width, int height, float* coverage);
+
+#endif // !__AA_HG_CPU_RASTER
@@ -1,22 +1,22 @@
 #include "dartboard.h"
 #include <math.h>
 #include <stdlib.h>
-#include <glad/glad.h>
 
 #ifndef M_PI
   #define M_PI 3.14159265358979323846
 #endif
 
-int dartboard_init(DartboardScene* scene)
+float* dartboard_vertices(uint32_t slices, uint32_t* vertex_count)
 {
-  // 180 slices total, we only draw half of them
-  int total_slices    = 180;
-  int spokes          = total_slices / 2;
-  scene->vertex_count = spokes * 3;
+  // We only draw half of the slices
+  int total_slices = (int)slices;
+  int spokes       = (total_slices + 1) / 2;
+  *vertex_count    = spokes * 3;
 
   // Position only
-  size_t buffer_size = scene->vertex_count * 3 * sizeof(float);
-  float* vertices    = (float*)malloc(buffer_size);
+  float* vertices = (float*)malloc(*vertex_count * 3 * sizeof(float));
+  if (vertices == NULL)
+    return NULL;
 
   float radius = 1.5f;
 
@@ -41,34 +41,5 @@ int dartboard_init(DartboardScene* scene)
     vertices[idx++] = radius * sinf(theta2);
     vertices[idx++] = 0.0f;
   }
-
-  // Create and fill the VBO
-  aa_vertex_buffer_create(&scene->vbo);
-  aa_vertex_buffer_update(&scene->vbo, vertices, buffer_size);
-
-  // Create the VAO
-  aa_vertex_array_create(&scene->vao);
-
-  // Bind the VAO so we can configure it
-  aa_vertex_array_bind(&scene->vao);
-
-  // Bind the VBO while the VAO is bound (Crucial Step!)
-  aa_vertex_buffer_bind(&scene->vbo);
-
-  aa_vertex_array_position_attribute(&scene->vao);
-
-  free(vertices);
-  return 0;
+  return vertices;
 }
-
-void dartboard_render(DartboardScene* scene)
-{
-  aa_vertex_array_bind(&scene->vao);
-  glDrawArrays(GL_TRIANGLES, 0, scene->vertex_count);
-}
-
-void dartboard_cleanup(DartboardScene* scene)
-{
-  aa_vertex_buffer_delete(&scene->vbo);
-  aa_vertex_array_delete(&scene->vao);
-}
\ No newline at end of file
@@ -2,24 +2,9 @@
 #define __HG_AA_DARTBOARD
 
 #include <stdint.h>
-#include "gl/vertex_array.h"
-#include "gl/vertex_buffer.h"
 
-// Struct to hold dartboard specific data
-typedef struct
-{
-  aa_vertex_array vao;
-  aa_vertex_buffer vbo;
-  uint32_t vertex_count;
-} DartboardScene;
-
-// Initialize the dartboard geometry
-int dartboard_init(DartboardScene* scene);
-
-// Render the dartboard (binds VAO and draws)
-void dartboard_render(DartboardScene* scene);
-
-// Deletes dartboard specific data
-void dartboard_cleanup(DartboardScene* scene);
+// Generates the dartboard triangles (xyz positions, to be freed by the caller)
+// Half of the slices are drawn; the scene submits them through its batch
+float* dartboard_vertices(uint32_t slices, uint32_t* vertex_count);
 
 #endif
\ No newline at end of file
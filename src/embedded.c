@@ -0,0 +1,15 @@
+#include "embedded.h"
+#include <string.h>
+
+const aa_embedded_file* aa_embedded_find(const char* path)
+{
+  if (path == NULL)
+    return NULL;
+  // A handful of entries, a linear search is enough
+  for (size_t i = 0; i < aa_embedded_file_count; i++)
+  {
+    if (strcmp(aa_embedded_files[i].path, path) == 0)
+      return &aa_embedded_files[i];
+  }
+  return NULL;
+}
@@ -0,0 +1,28 @@
+#ifndef __AA_HG_EMBEDDED
+#define __AA_HG_EMBEDDED
+
+#include <stddef.h>
+
+// Resources compiled into the executable
+// The table is generated at build time by `cmake/embed_resources.cmake` from the
+// shaders and the SMAA lookup tables in `resources/`, so the application does not
+// depend on files next to the binary to start.
+
+typedef struct
+{
+  // Path relative to `resources/` (e.g. "shaders/SMAA.hlsl")
+  const char* path;
+  // Content, followed by a NUL byte that is not counted in `size`
+  const unsigned char* data;
+  size_t size;
+} aa_embedded_file;
+
+extern const aa_embedded_file aa_embedded_files[];
+extern const size_t aa_embedded_file_count;
+
+/// @brief Finds an embedded resource
+/// @param path Path relative to `resources/`
+/// @return The resource, or NULL if it was not embedded
+const aa_embedded_file* aa_embedded_find(const char* path);
+
+#endif // !__AA_HG_EMBEDDED
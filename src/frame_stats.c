@@ -0,0 +1,74 @@
+#include "frame_stats.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+  #include <intrin.h>
+static uint64_t aa_frame_ring_load(const aa_frame_ring* ring)
+{
+  // Volatile accesses have acquire/release semantics with /volatile:ms
+  uint64_t head = (uint64_t)ring->head;
+  _ReadWriteBarrier();
+  return head;
+}
+static void aa_frame_ring_store(aa_frame_ring* ring, uint64_t head)
+{
+  _ReadWriteBarrier();
+  _InterlockedExchange64(&ring->head, (long long)head);
+}
+#else
+static uint64_t aa_frame_ring_load(const aa_frame_ring* ring)
+{
+  return atomic_load_explicit(
+      (aa_frame_ring_index*)&ring->head, memory_order_acquire);
+}
+static void aa_frame_ring_store(aa_frame_ring* ring, uint64_t head)
+{
+  atomic_store_explicit(&ring->head, head, memory_order_release);
+}
+#endif
+
+void aa_frame_ring_push(aa_frame_ring* ring, float value)
+{
+  // Only the producer writes `head`, so reading it back cannot race
+  uint64_t head = aa_frame_ring_load(ring);
+  ring->values[head & (AA_FRAME_RING_CAPACITY - 1)] = value;
+  aa_frame_ring_store(ring, head + 1);
+}
+
+uint32_t aa_frame_ring_snapshot(const aa_frame_ring* ring, float* out)
+{
+  uint64_t head  = aa_frame_ring_load(ring);
+  uint32_t count = head < AA_FRAME_RING_CAPACITY ? (uint32_t)head
+                                                 : AA_FRAME_RING_CAPACITY;
+  for (uint32_t i = 0; i < count; i++)
+  {
+    uint64_t index = head - count + i;
+    out[i]         = ring->values[index & (AA_FRAME_RING_CAPACITY - 1)];
+  }
+  return count;
+}
+
+static int aa_compare_float(const void* a, const void* b)
+{
+  float fa = *(const float*)a;
+  float fb = *(const float*)b;
+  return (fa > fb) - (fa < fb);
+}
+
+aa_frame_stats aa_frame_stats_compute(const float* values, uint32_t count)
+{
+  aa_frame_stats stats = {0.0f, 0.0f, 0.0f};
+  if (count == 0)
+    return stats;
+  float sorted[AA_FRAME_RING_CAPACITY];
+  if (count > AA_FRAME_RING_CAPACITY)
+    count = AA_FRAME_RING_CAPACITY;
+  memcpy(sorted, values, count * sizeof(float));
+  qsort(sorted, count, sizeof(float), aa_compare_float);
+  // Nearest-rank percentiles
+  stats.p50 = sorted[(count - 1) * 50 / 100];
+  stats.p99 = sorted[(count - 1) * 99 / 100];
+  stats.max = sorted[count - 1];
+  return stats;
+}
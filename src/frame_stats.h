@@ -0,0 +1,48 @@
+#ifndef __AA_HG_FRAME_STATS
+#define __AA_HG_FRAME_STATS
+
+#include <stdint.h>
+
+// Rolling window of frame times for the live overlay
+// Single producer (the render loop) / single consumer ring buffer: the producer
+// publishes a value by bumping `head` with release semantics, readers take a
+// snapshot without any lock. A reader lapped by the producer may see a few values
+// from the newer lap, which is harmless for a rolling graph.
+
+/// @brief Number of frames kept (power of two)
+#define AA_FRAME_RING_CAPACITY 256
+
+#if defined(_MSC_VER) && !defined(__clang__)
+typedef volatile long long aa_frame_ring_index;
+#else
+  #include <stdatomic.h>
+typedef _Atomic uint64_t aa_frame_ring_index;
+#endif
+
+typedef struct
+{
+  float values[AA_FRAME_RING_CAPACITY];
+  aa_frame_ring_index head;
+} aa_frame_ring;
+
+/// @brief Percentiles of a snapshot, in the unit of the pushed values
+typedef struct
+{
+  float p50;
+  float p99;
+  float max;
+} aa_frame_stats;
+
+/// @brief Appends a value, overwriting the oldest one once the ring is full
+void aa_frame_ring_push(aa_frame_ring* ring, float value);
+
+/// @brief Copies the most recent values, oldest first
+/// @param ring The ring
+/// @param out Buffer of at least `AA_FRAME_RING_CAPACITY` values
+/// @return The number of values copied
+uint32_t aa_frame_ring_snapshot(const aa_frame_ring* ring, float* out);
+
+/// @brief Computes the percentiles of a snapshot (does not modify `values`)
+aa_frame_stats aa_frame_stats_compute(const float* values, uint32_t count);
+
+#endif // !__AA_HG_FRAME_STATS
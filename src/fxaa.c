@@ -0,0 +1,113 @@
+#include "fxaa.h"
+#include <stdio.h>
+#include <string.h>
+
+const aa_fxaa_parameters AA_FXAA_DEFAULTS = {0.75f, 0.166f, 0.0833f, 39, false};
+
+const int AA_FXAA_PRESETS[AA_FXAA_PRESET_COUNT] = {
+    10, 11, 12, 13, 14, 15, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 39};
+
+int aa_fxaa_preset_index(int preset)
+{
+  for (int i = 0; i < AA_FXAA_PRESET_COUNT; i++)
+  {
+    if (AA_FXAA_PRESETS[i] == preset)
+      return i;
+  }
+  return -1;
+}
+
+/// @brief Index of the default variant (preset 39, luma computed)
+#define AA_FXAA_DEFAULT_VARIANT (2 * (AA_FXAA_PRESET_COUNT - 1))
+
+/// @brief Submits a variant: `preset | luma_alpha` (see `AA_FXAA_VARIANTS`)
+static int aa_fxaa_iterative_submit(aa_fxaa_iterative* fxaa, uint32_t variant)
+{
+  char macros[128];
+  snprintf(
+      macros, sizeof(macros), "#define FXAA_QUALITY_PRESET %d\n%s",
+      AA_FXAA_PRESETS[variant / 2],
+      (variant & 1u) ? "#define FXAA_LUMA_ALPHA 1\n" : "");
+
+  aa_shader_assembly assembly;
+  aa_shader_assembly_begin(&assembly, "#version 430 core\n");
+  aa_shader_assembly_text(&assembly, macros);
+  aa_shader_assembly_file(&assembly, "fragment_fxaa_iterative.glsl");
+  if (aa_shader_cache_fragment(
+          fxaa->cache, &assembly, &fxaa->fragment_shaders[variant])
+      != 0)
+  {
+    printf("Error: Could not assemble iterative FXAA\n");
+    return -1;
+  }
+
+  aa_program* program = &fxaa->programs[variant];
+  aa_program_create(program);
+  aa_program_attach_shaders(
+      program, fxaa->vertex_shader, &fxaa->fragment_shaders[variant]);
+  aa_program_link_submit(program);
+  return 0;
+}
+
+int aa_fxaa_iterative_init(
+    aa_fxaa_iterative* fxaa, aa_shader_cache* cache,
+    aa_vertex_shader* vertex_shader)
+{
+  memset(fxaa, 0, sizeof(aa_fxaa_iterative));
+  fxaa->cache         = cache;
+  fxaa->vertex_shader = vertex_shader;
+  if (aa_fxaa_iterative_submit(fxaa, AA_FXAA_DEFAULT_VARIANT) != 0)
+    return -1;
+  // Checked with the other programs at startup, which fails if it does not link
+  fxaa->initialized[AA_FXAA_DEFAULT_VARIANT] = true;
+  return 0;
+}
+
+aa_program* aa_fxaa_iterative_default(aa_fxaa_iterative* fxaa)
+{
+  return &fxaa->programs[AA_FXAA_DEFAULT_VARIANT];
+}
+
+aa_program* aa_fxaa_iterative_get(
+    aa_fxaa_iterative* fxaa, const aa_fxaa_parameters* parameters)
+{
+  int preset = aa_fxaa_preset_index(parameters->quality_preset);
+  if (preset < 0)
+    return NULL;
+  uint32_t variant = (uint32_t)preset * 2 + (parameters->luma_alpha ? 1u : 0u);
+  if (fxaa->failed[variant])
+    return NULL;
+  if (!fxaa->initialized[variant])
+  {
+    if (aa_fxaa_iterative_submit(fxaa, variant) != 0)
+    {
+      fxaa->failed[variant] = true;
+      return NULL;
+    }
+    if (aa_shader_cache_check(fxaa->cache) != 0
+        || aa_program_link_check(&fxaa->programs[variant]) != 0)
+    {
+      printf(
+          "Error: Iterative FXAA variant (preset %d) failed, it is disabled\n",
+          parameters->quality_preset);
+      aa_program_delete(&fxaa->programs[variant]);
+      fxaa->failed[variant] = true;
+      return NULL;
+    }
+    fxaa->initialized[variant] = true;
+    printf(
+        "Compiled iterative FXAA variant (preset %d, luma %s)\n",
+        parameters->quality_preset,
+        parameters->luma_alpha ? "in alpha" : "computed");
+  }
+  return &fxaa->programs[variant];
+}
+
+void aa_fxaa_iterative_delete(aa_fxaa_iterative* fxaa)
+{
+  for (uint32_t i = 0; i < AA_FXAA_VARIANTS; i++)
+  {
+    if (fxaa->initialized[i])
+      aa_program_delete(&fxaa->programs[i]);
+  }
+}
@@ -0,0 +1,85 @@
+#ifndef __AA_HG_FXAA
+#define __AA_HG_FXAA
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gl/program.h"
+#include "gl/shader_assembly.h"
+
+// Iterative FXAA (FXAA 3.11 quality, `fragment_fxaa_iterative.glsl`)
+// The search along an edge steps by the table of a quality preset
+// (FXAA_QUALITY__PRESET of FXAA 3.11): 10 to 15 search 3 to 8 steps ending on
+// a 12 pixel step, 20 to 29 search 3 to 12 steps ending on an 8 pixel step,
+// and 39 (the historical table) searches 12 steps, the first five of a pixel.
+// The table is compiled into the shader, one variant per preset, so that the
+// unrolled search only holds the steps of its preset.
+// With `luma_alpha`, the scene pass writes the luma of every pixel into the
+// alpha of the colour target, as FXAA 3.11 expects it, and the shader reads it
+// at every tap instead of computing it.
+
+/// @brief Parameters of the iterative FXAA shader (FXAA 3.11 quality settings)
+typedef struct
+{
+  // fxaaQualitySubpix: amount of sub-pixel aliasing removal (0 to 1)
+  float subpix;
+  // fxaaQualityEdgeThreshold: minimum local contrast to process (0.063 to 0.333)
+  float edge_threshold;
+  // fxaaQualityEdgeThresholdMin: skips dark areas (0.0312 to 0.0833)
+  float edge_threshold_min;
+  // FXAA_QUALITY__PRESET: search steps, compiled in (one of `AA_FXAA_PRESETS`)
+  int quality_preset;
+  // The luma is written into the alpha by the scene pass (compiled in)
+  bool luma_alpha;
+} aa_fxaa_parameters;
+
+/// @brief The defaults of `fragment_fxaa_iterative.glsl`
+extern const aa_fxaa_parameters AA_FXAA_DEFAULTS;
+
+/// @brief Number of quality presets
+#define AA_FXAA_PRESET_COUNT 17
+/// @brief The quality presets of FXAA 3.11, in increasing order
+extern const int AA_FXAA_PRESETS[AA_FXAA_PRESET_COUNT];
+
+/// @brief Finds a quality preset
+/// @return Its index in `AA_FXAA_PRESETS`, or -1 if it does not exist
+int aa_fxaa_preset_index(int preset);
+
+/// @brief Number of compiled variants (every preset, luma in alpha or not)
+#define AA_FXAA_VARIANTS (2 * AA_FXAA_PRESET_COUNT)
+
+// The variants of the iterative FXAA program, compiled on first use
+typedef struct
+{
+  aa_program programs[AA_FXAA_VARIANTS];
+  // Linked, or failed to compile or link (and never submitted again)
+  bool initialized[AA_FXAA_VARIANTS];
+  bool failed[AA_FXAA_VARIANTS];
+  // Shaders are owned by the shader cache they were taken from
+  aa_vertex_shader* vertex_shader;
+  aa_fragment_shader fragment_shaders[AA_FXAA_VARIANTS];
+  aa_shader_cache* cache;
+} aa_fxaa_iterative;
+
+/// @brief Initializes the variants
+/// @details Only submits the default variant (preset 39, luma computed), check
+///          it with `aa_program_link_check(aa_fxaa_iterative_default(fxaa))`
+/// @param vertex_shader The full screen quad, referenced by every variant
+/// @return 0 on success, -1 if the shader could not be assembled
+int aa_fxaa_iterative_init(
+    aa_fxaa_iterative* fxaa, aa_shader_cache* cache,
+    aa_vertex_shader* vertex_shader);
+
+/// @brief The variant submitted by `aa_fxaa_iterative_init`
+aa_program* aa_fxaa_iterative_default(aa_fxaa_iterative* fxaa);
+
+/// @brief Returns the variant matching `parameters`
+/// @details A variant used for the first time is compiled and linked on the spot
+/// @return The program, or NULL if the preset does not exist or the variant
+///         failed to compile
+aa_program* aa_fxaa_iterative_get(
+    aa_fxaa_iterative* fxaa, const aa_fxaa_parameters* parameters);
+
+/// @brief Deletes the programs of every initialized variant
+void aa_fxaa_iterative_delete(aa_fxaa_iterative* fxaa);
+
+#endif // !__AA_HG_FXAA
@@ -0,0 +1,47 @@
+#include "capabilities.h"
+#include <stdio.h>
+#include <string.h>
+#include "extensions.h"
+
+aa_gl_capabilities aa_gl_caps;
+
+void aa_gl_capabilities_probe(void)
+{
+  memset(&aa_gl_caps, 0, sizeof(aa_gl_capabilities));
+  glGetIntegerv(GL_MAJOR_VERSION, &aa_gl_caps.major);
+  glGetIntegerv(GL_MINOR_VERSION, &aa_gl_caps.minor);
+  glGetIntegerv(GL_MAX_SAMPLES, &aa_gl_caps.max_samples);
+  glGetIntegerv(
+      GL_MAX_COLOR_TEXTURE_SAMPLES, &aa_gl_caps.max_color_texture_samples);
+  glGetIntegerv(GL_MAX_TEXTURE_SIZE, &aa_gl_caps.max_texture_size);
+  aa_gl_caps.compute =
+      (aa_gl_caps.major == 4 && aa_gl_caps.minor >= 3) || aa_gl_caps.major > 4
+      || aa_gl_has_extension("GL_ARB_compute_shader");
+  if (aa_gl_caps.compute)
+  {
+    glGetIntegerv(
+        GL_MAX_COMPUTE_WORK_GROUP_INVOCATIONS,
+        &aa_gl_caps.max_compute_invocations);
+  }
+  glGetQueryiv(GL_TIME_ELAPSED, GL_QUERY_COUNTER_BITS, &aa_gl_caps.timer_bits);
+  // Queries of unsupported limits leave errors behind
+  while (glGetError() != GL_NO_ERROR)
+    ;
+
+  printf(
+      "Device: %s, OpenGL %d.%d, %d samples (%d in textures), textures up to "
+      "%d, compute %s, %d-bit timer, parallel compile %s, buffer storage %s\n",
+      (const char*)glGetString(GL_RENDERER), aa_gl_caps.major, aa_gl_caps.minor,
+      aa_gl_caps.max_samples, aa_gl_caps.max_color_texture_samples,
+      aa_gl_caps.max_texture_size, aa_gl_caps.compute ? "on" : "off",
+      aa_gl_caps.timer_bits, aa_gl_ext.parallel_shader_compile ? "on" : "off",
+      aa_gl_ext.buffer_storage ? "on" : "off");
+  if (aa_gl_caps.timer_bits == 0)
+    printf("Warning: No GPU timer, GPU times will read 0\n");
+}
+
+bool aa_gl_supports_samples(GLint samples)
+{
+  return samples <= aa_gl_caps.max_samples
+         && samples <= aa_gl_caps.max_color_texture_samples;
+}
@@ -0,0 +1,41 @@
+#ifndef __HG_AA_GL_CAPABILITIES
+#define __HG_AA_GL_CAPABILITIES
+
+#include <glad/glad.h>
+#include <stdbool.h>
+
+// Limits of the current context, probed once after loading
+// Render targets beyond them are never created, and the configurations that
+// would need them are left out of the benchmark matrix (see
+// `aa_algorithm_supported`) instead of timing incomplete frame buffers.
+
+typedef struct
+{
+  // Version of the context
+  GLint major;
+  GLint minor;
+  // GL_MAX_SAMPLES: most samples of a multisampled render target
+  GLint max_samples;
+  // GL_MAX_COLOR_TEXTURE_SAMPLES: most samples of a multisampled colour texture
+  GLint max_color_texture_samples;
+  // GL_MAX_TEXTURE_SIZE: widest and highest texture
+  GLint max_texture_size;
+  // Compute shaders (OpenGL 4.3 or GL_ARB_compute_shader)
+  bool compute;
+  // GL_MAX_COMPUTE_WORK_GROUP_INVOCATIONS (0 without compute shaders)
+  GLint max_compute_invocations;
+  // GL_QUERY_COUNTER_BITS of GL_TIME_ELAPSED (0: GPU times are meaningless)
+  GLint timer_bits;
+} aa_gl_capabilities;
+
+/// @brief The limits of the current context, filled by
+///        `aa_gl_capabilities_probe`
+extern aa_gl_capabilities aa_gl_caps;
+
+/// @brief Queries the limits of the current context and prints them
+void aa_gl_capabilities_probe(void);
+
+/// @brief Checks if a colour texture with `samples` samples can be rendered to
+bool aa_gl_supports_samples(GLint samples);
+
+#endif // !__HG_AA_GL_CAPABILITIES
@@ -0,0 +1,45 @@
+#include "extensions.h"
+#include <string.h>
+
+aa_gl_extensions aa_gl_ext;
+
+bool aa_gl_has_extension(const char* name)
+{
+  GLint count = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+  for (GLint i = 0; i < count; i++)
+  {
+    const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+    if (extension != NULL && strcmp(extension, name) == 0)
+      return true;
+  }
+  return false;
+}
+
+void aa_gl_extensions_load(GLADloadproc load)
+{
+  memset(&aa_gl_ext, 0, sizeof(aa_gl_extensions));
+
+  if (aa_gl_has_extension("GL_KHR_parallel_shader_compile"))
+  {
+    aa_gl_ext.MaxShaderCompilerThreads =
+        (PFNAAMAXSHADERCOMPILERTHREADSKHRPROC)load("glMaxShaderCompilerThreadsKHR");
+  }
+  else if (aa_gl_has_extension("GL_ARB_parallel_shader_compile"))
+  {
+    aa_gl_ext.MaxShaderCompilerThreads =
+        (PFNAAMAXSHADERCOMPILERTHREADSKHRPROC)load("glMaxShaderCompilerThreadsARB");
+  }
+  aa_gl_ext.parallel_shader_compile = aa_gl_ext.MaxShaderCompilerThreads != NULL;
+
+  GLint major = 0;
+  GLint minor = 0;
+  glGetIntegerv(GL_MAJOR_VERSION, &major);
+  glGetIntegerv(GL_MINOR_VERSION, &minor);
+  if ((major == 4 && minor >= 4) || major > 4
+      || aa_gl_has_extension("GL_ARB_buffer_storage"))
+  {
+    aa_gl_ext.BufferStorage = (PFNAABUFFERSTORAGEPROC)load("glBufferStorage");
+  }
+  aa_gl_ext.buffer_storage = aa_gl_ext.BufferStorage != NULL;
+}
@@ -0,0 +1,54 @@
+#ifndef __HG_AA_GL_EXTENSIONS
+#define __HG_AA_GL_EXTENSIONS
+
+#include <glad/glad.h>
+#include <stdbool.h>
+
+// Optional OpenGL extensions
+// The glad loader only covers core OpenGL 4.3, so the entry points of the
+// extensions used opportunistically are loaded here. Every feature has a
+// fallback: callers check the corresponding flag before using it.
+
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+#ifndef GL_CLIENT_STORAGE_BIT
+#define GL_CLIENT_STORAGE_BIT 0x0200
+#endif
+
+typedef void(APIENTRYP PFNAAMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+typedef void(APIENTRYP PFNAABUFFERSTORAGEPROC)(
+    GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+typedef struct
+{
+  // GL_KHR_parallel_shader_compile (or the ARB variant)
+  bool parallel_shader_compile;
+  PFNAAMAXSHADERCOMPILERTHREADSKHRPROC MaxShaderCompilerThreads;
+  // GL_ARB_buffer_storage (core in OpenGL 4.4): immutable, persistently mapped
+  // buffers
+  bool buffer_storage;
+  PFNAABUFFERSTORAGEPROC BufferStorage;
+} aa_gl_extensions;
+
+/// @brief The extensions of the current context, filled by `aa_gl_extensions_load`
+extern aa_gl_extensions aa_gl_ext;
+
+/// @brief Checks if the current context exposes an extension
+/// @param name The extension name (e.g. "GL_KHR_parallel_shader_compile")
+bool aa_gl_has_extension(const char* name);
+
+/// @brief Detects the optional extensions and loads their entry points
+/// @param load The function loader (e.g. `glfwGetProcAddress`)
+void aa_gl_extensions_load(GLADloadproc load);
+
+#endif // !__HG_AA_GL_EXTENSIONS
@@ -1,13 +1,35 @@
 #include "frame_buffer.h"
 
+/// @brief Format of the (absent) pixels uploaded with an internal format
+static GLenum aa_texture_transfer_format(GLenum format)
+{
+  switch (format)
+  {
+  case GL_DEPTH_COMPONENT16:
+  case GL_DEPTH_COMPONENT24:
+  case GL_DEPTH_COMPONENT32:
+  case GL_DEPTH_COMPONENT32F:
+    return GL_DEPTH_COMPONENT;
+  default:
+    return GL_RGBA;
+  }
+}
+
 void aa_texture_create(aa_texture* out, size_t width, size_t height)
+{
+  aa_texture_create_format(out, width, height, GL_RGBA8);
+}
+
+void aa_texture_create_format(
+    aa_texture* out, size_t width, size_t height, GLenum format)
 {
   out->target = GL_TEXTURE_2D;
+  out->format = format;
   glCall(glGenTextures(1, &out->id));
   glCall(glBindTexture(out->target, out->id));
   glCall(glTexImage2D(
-      GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
-      NULL));
+      GL_TEXTURE_2D, 0, format, width, height, 0,
+      aa_texture_transfer_format(format), GL_UNSIGNED_BYTE, NULL));
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -15,8 +37,14 @@ void aa_texture_create(aa_texture* out, size_t width, size_t height)
 }
 
 void aa_texture_msaa_create(aa_texture* out)
+{
+  aa_texture_msaa_create_format(out, GL_RGBA8);
+}
+
+void aa_texture_msaa_create_format(aa_texture* out, GLenum format)
 {
   out->target = GL_TEXTURE_2D_MULTISAMPLE;
+  out->format = format;
   glCall(glGenTextures(1, &out->id));
 }
 void aa_texture_from_data(
@@ -89,15 +117,15 @@ void aa_texture_msaa_dimensions(
 {
   glCall(glBindTexture(out->target, out->id));
   glCall(glTexImage2DMultisample(
-      out->target, samples, GL_RGBA8, width, height, GL_TRUE));
+      out->target, samples, out->format, width, height, GL_TRUE));
 }
 
 void aa_texture_dimensions(aa_texture* out, size_t width, size_t height)
 {
   glCall(glBindTexture(out->target, out->id));
   glCall(glTexImage2D(
-      GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
-      NULL));
+      GL_TEXTURE_2D, 0, out->format, width, height, 0,
+      aa_texture_transfer_format(out->format), GL_UNSIGNED_BYTE, NULL));
 }
 
 void aa_frame_buffer_create(aa_frame_buffer* out)
@@ -137,3 +165,34 @@ void aa_frame_buffer_color_texture(aa_frame_buffer* out, aa_texture* texture)
     printf("FBO error: 0x%x\n", status);
   }
 }
+
+void aa_frame_buffer_depth_texture(aa_frame_buffer* out, aa_texture* texture)
+{
+  glCall(glBindFramebuffer(GL_FRAMEBUFFER, out->id));
+  glCall(glFramebufferTexture2D(
+      GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, texture->target, texture->id, 0));
+  GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+  if (status != GL_FRAMEBUFFER_COMPLETE)
+  {
+    printf("FBO error: 0x%x\n", status);
+  }
+}
+
+void aa_frame_buffer_color_textures(
+    aa_frame_buffer* out, aa_texture* const* textures, uint32_t count)
+{
+  GLenum attachments[8];
+  glCall(glBindFramebuffer(GL_FRAMEBUFFER, out->id));
+  for (uint32_t i = 0; i < count && i < 8; i++)
+  {
+    attachments[i] = GL_COLOR_ATTACHMENT0 + i;
+    glCall(glFramebufferTexture2D(
+        GL_FRAMEBUFFER, attachments[i], textures[i]->target, textures[i]->id, 0));
+  }
+  glCall(glDrawBuffers(count < 8 ? (GLsizei)count : 8, attachments));
+  GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+  if (status != GL_FRAMEBUFFER_COMPLETE)
+  {
+    printf("FBO error: 0x%x\n", status);
+  }
+}
@@ -13,10 +13,15 @@ typedef struct
 {
   unsigned int id;
   GLenum target;
+  // Internal format, kept when resized (GL_RGBA8 unless created with a format)
+  GLenum format;
 } aa_texture;
 
 void aa_texture_create(aa_texture* out, size_t width, size_t height);
+void aa_texture_create_format(
+    aa_texture* out, size_t width, size_t height, GLenum format);
 void aa_texture_msaa_create(aa_texture* out);
+void aa_texture_msaa_create_format(aa_texture* out, GLenum format);
 void aa_texture_from_data(
     aa_texture* out, const unsigned char* data, size_t width, size_t height);
 void aa_smaa_search_texture(
@@ -38,6 +43,13 @@ void aa_frame_buffer_create(aa_frame_buffer* out);
 void aa_frame_buffer_bind(aa_frame_buffer* out);
 void aa_frame_buffer_delete(aa_frame_buffer* out);
 void aa_frame_buffer_color_texture(aa_frame_buffer* out, aa_texture* texture);
+/// @brief Attaches a depth texture (e.g. GL_DEPTH_COMPONENT32F) to the depth
+///        attachment
+void aa_frame_buffer_depth_texture(aa_frame_buffer* out, aa_texture* texture);
+/// @brief Attaches `count` textures to the colour attachments 0, 1... and
+///        draws into all of them
+void aa_frame_buffer_color_textures(
+    aa_frame_buffer* out, aa_texture* const* textures, uint32_t count);
 void aa_frame_buffer_blit(
     aa_frame_buffer* out, aa_frame_buffer* multisample_fbo, size_t width,
     size_t height);
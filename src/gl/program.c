@@ -1,5 +1,6 @@
 #include "program.h"
 #include "error.h"
+#include "extensions.h"
 #include <glad/glad.h>
 
 void aa_fragment_shader_create(aa_fragment_shader* out, const char* source)
@@ -82,6 +83,34 @@ void aa_program_link(aa_program* out)
   glValidateProgram(out->id);
 }
 
+void aa_program_link_submit(aa_program* out)
+{
+  glCall(glLinkProgram(out->id));
+}
+
+bool aa_program_link_ready(aa_program* out)
+{
+  if (!aa_gl_ext.parallel_shader_compile)
+    return true;
+  int done;
+  glCall(glGetProgramiv(out->id, GL_COMPLETION_STATUS_KHR, &done));
+  return done != 0;
+}
+
+int aa_program_link_check(aa_program* out)
+{
+  int success;
+  char infoLog[512];
+  glCall(glGetProgramiv(out->id, GL_LINK_STATUS, &success));
+  if (!success)
+  {
+    glCall(glGetProgramInfoLog(out->id, 512, NULL, infoLog));
+    printf("ERROR: PROGRAM LINKING FAILED\n%s", infoLog);
+    return -1;
+  }
+  return 0;
+}
+
 void aa_program_attach_shaders(
     aa_program* out, aa_vertex_shader* vertex_shader,
     aa_fragment_shader* fragment_shader)
@@ -90,6 +119,11 @@ void aa_program_attach_shaders(
   glCall(glAttachShader(out->id, fragment_shader->id));
 }
 
+void aa_program_attach_compute(aa_program* out, aa_compute_shader* compute_shader)
+{
+  glCall(glAttachShader(out->id, compute_shader->id));
+}
+
 void aa_program_use(aa_program* out)
 {
   glCall(glUseProgram(out->id));
@@ -2,6 +2,7 @@
 #define __HG_AA_GL_PROGRAM
 
 #include <glad/glad.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
 
@@ -19,6 +20,11 @@ typedef struct
   unsigned int id;
 } aa_vertex_shader;
 
+typedef struct
+{
+  unsigned int id;
+} aa_compute_shader;
+
 void aa_fragment_shader_create(aa_fragment_shader* out, const char* source);
 void aa_vertex_shader_create(aa_vertex_shader* out, const char* source);
 void aa_fragment_shader_source(aa_fragment_shader* out, const char* source);
@@ -35,9 +41,24 @@ typedef struct
 
 void aa_program_create(aa_program* out);
 void aa_program_link(aa_program* out);
+
+/// @brief Starts linking a program without waiting for the result
+/// @details With GL_KHR_parallel_shader_compile the driver links in the
+///          background, other work can be done until `aa_program_link_check`
+void aa_program_link_submit(aa_program* out);
+
+/// @brief Checks if a submitted link finished, without blocking
+/// @return True if `aa_program_link_check` would not wait (always true when
+///         the driver can not report it)
+bool aa_program_link_ready(aa_program* out);
+
+/// @brief Waits for a submitted link and reports failures
+/// @return 0 on success, -1 if the program failed to link
+int aa_program_link_check(aa_program* out);
 void aa_program_attach_shaders(
     aa_program* out, aa_vertex_shader* vertex_shader,
     aa_fragment_shader* fragment_shader);
+void aa_program_attach_compute(aa_program* out, aa_compute_shader* compute_shader);
 void aa_program_use(aa_program* out);
 void aa_program_delete(aa_program* out);
 
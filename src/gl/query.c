@@ -24,3 +24,40 @@ void aa_time_query_result(aa_time_query* out)
 {
   glCall(glGetQueryObjectuiv(out->id, GL_QUERY_RESULT, &out->result));
 }
+
+void aa_timestamp_query_create(aa_timestamp_query* out)
+{
+  glCall(glGenQueries(1, &out->id));
+  out->result = 0;
+}
+
+void aa_timestamp_query_delete(aa_timestamp_query* out)
+{
+  glCall(glDeleteQueries(1, &out->id));
+}
+
+void aa_timestamp_query_record(aa_timestamp_query* out)
+{
+  glCall(glQueryCounter(out->id, GL_TIMESTAMP));
+}
+
+bool aa_timestamp_query_available(aa_timestamp_query* out)
+{
+  GLuint available = GL_FALSE;
+  glCall(glGetQueryObjectuiv(out->id, GL_QUERY_RESULT_AVAILABLE, &available));
+  return available == GL_TRUE;
+}
+
+void aa_timestamp_query_result(aa_timestamp_query* out)
+{
+  GLuint64 result = 0;
+  glCall(glGetQueryObjectui64v(out->id, GL_QUERY_RESULT, &result));
+  out->result = result;
+}
+
+int64_t aa_gpu_timestamp_now(void)
+{
+  GLint64 now = 0;
+  glCall(glGetInteger64v(GL_TIMESTAMP, &now));
+  return now;
+}
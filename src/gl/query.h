@@ -21,4 +21,23 @@ void aa_time_query_begin(aa_time_query* out);
 void aa_time_query_end(aa_time_query* out);
 void aa_time_query_result(aa_time_query* out);
 
+// Wrappers for OpenGL timestamp queries
+// Records the GPU clock once all previous commands have completed, which allows
+// placing individual passes on a timeline instead of only measuring durations
+
+typedef struct
+{
+  unsigned int id;
+  uint64_t result;
+} aa_timestamp_query;
+
+void aa_timestamp_query_create(aa_timestamp_query* out);
+void aa_timestamp_query_delete(aa_timestamp_query* out);
+void aa_timestamp_query_record(aa_timestamp_query* out);
+bool aa_timestamp_query_available(aa_timestamp_query* out);
+void aa_timestamp_query_result(aa_timestamp_query* out);
+
+/// @brief Reads the current GPU time (in nanoseconds) without waiting for the GPU
+int64_t aa_gpu_timestamp_now(void);
+
 #endif // !__HG_AA_GL_QUERY
@@ -0,0 +1,164 @@
+#include "readback.h"
+#include "extensions.h"
+#include <string.h>
+
+void aa_readback_create(aa_readback* out)
+{
+  memset(out, 0, sizeof(aa_readback));
+}
+
+/// @brief Deletes the buffers and their mappings
+static void aa_readback_free_buffers(aa_readback* out)
+{
+  for (uint32_t i = 0; i < AA_READBACK_RING_SIZE; i++)
+  {
+    if (out->buffers[i] == 0)
+      continue;
+    if (out->mapped[i])
+    {
+      glCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, out->buffers[i]));
+      glCall(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+      out->mapped[i] = NULL;
+    }
+    glCall(glDeleteBuffers(1, &out->buffers[i]));
+    out->buffers[i] = 0;
+  }
+  glCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+  out->capacity = 0;
+}
+
+/// @brief Allocates buffers of at least `size` bytes
+static void aa_readback_allocate(aa_readback* out, size_t size)
+{
+  aa_readback_free_buffers(out);
+  out->persistent = aa_gl_ext.buffer_storage;
+  glCall(glGenBuffers(AA_READBACK_RING_SIZE, out->buffers));
+  for (uint32_t i = 0; i < AA_READBACK_RING_SIZE; i++)
+  {
+    glCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, out->buffers[i]));
+    if (out->persistent)
+    {
+      // Client storage: the CPU reads the whole buffer, keep it in system memory
+      const GLbitfield FLAGS =
+          GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+      glCall(aa_gl_ext.BufferStorage(
+          GL_PIXEL_PACK_BUFFER, (GLsizeiptr)size, NULL,
+          FLAGS | GL_CLIENT_STORAGE_BIT));
+      glCall(
+          out->mapped[i] =
+              glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)size, FLAGS));
+    }
+    else
+    {
+      glCall(glBufferData(
+          GL_PIXEL_PACK_BUFFER, (GLsizeiptr)size, NULL, GL_STREAM_READ));
+    }
+  }
+  glCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+  out->capacity = size;
+}
+
+int aa_readback_capture(
+    aa_readback* out, unsigned int fbo, int width, int height, uint64_t tag)
+{
+  if (out->count == AA_READBACK_RING_SIZE)
+    return -1;
+  size_t size = (size_t)width * height * 4;
+  if (size > out->capacity)
+  {
+    // Buffers can only be replaced once every capture was consumed
+    if (out->count > 0)
+      return -1;
+    aa_readback_allocate(out, size);
+  }
+
+  uint32_t slot            = (out->tail + out->count) % AA_READBACK_RING_SIZE;
+  aa_readback_frame* frame = &out->frames[slot];
+  frame->pixels            = NULL;
+  frame->width             = width;
+  frame->height            = height;
+  frame->tag               = tag;
+
+  glCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo));
+  glCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, out->buffers[slot]));
+  glCall(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+  // With a pack buffer bound, the last argument is an offset into it
+  glCall(glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, 0));
+  glCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+  glCall(out->fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+  out->count++;
+  return 0;
+}
+
+const aa_readback_frame* aa_readback_acquire(aa_readback* out, bool wait)
+{
+  if (out->count == 0)
+    return NULL;
+  uint32_t slot = out->tail;
+  if (out->acquired)
+    return &out->frames[slot];
+
+  // The flush makes sure the fence is submitted, so waiting on it terminates
+  GLuint64 timeout = wait ? UINT64_MAX : 0;
+  GLenum status;
+  glCall(
+      status = glClientWaitSync(
+          out->fences[slot], GL_SYNC_FLUSH_COMMANDS_BIT, timeout));
+  if (status == GL_TIMEOUT_EXPIRED)
+    return NULL;
+  if (status == GL_WAIT_FAILED)
+  {
+    printf("Error: Waiting for a readback failed\n");
+    return NULL;
+  }
+
+  aa_readback_frame* frame = &out->frames[slot];
+  if (out->persistent)
+  {
+    frame->pixels = out->mapped[slot];
+  }
+  else
+  {
+    glCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, out->buffers[slot]));
+    glCall(
+        frame->pixels = glMapBufferRange(
+            GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)frame->width * frame->height * 4,
+            GL_MAP_READ_BIT));
+    glCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+    if (frame->pixels == NULL)
+      return NULL;
+  }
+  out->acquired = true;
+  return frame;
+}
+
+void aa_readback_release(aa_readback* out)
+{
+  if (out->count == 0)
+    return;
+  uint32_t slot = out->tail;
+  if (out->acquired && !out->persistent)
+  {
+    glCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, out->buffers[slot]));
+    glCall(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+    glCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+  }
+  glCall(glDeleteSync(out->fences[slot]));
+  out->fences[slot]        = NULL;
+  out->frames[slot].pixels = NULL;
+  out->acquired            = false;
+  out->tail                = (out->tail + 1) % AA_READBACK_RING_SIZE;
+  out->count--;
+}
+
+uint32_t aa_readback_pending(const aa_readback* out)
+{
+  return out->count;
+}
+
+void aa_readback_delete(aa_readback* out)
+{
+  while (out->count > 0)
+    aa_readback_release(out);
+  aa_readback_free_buffers(out);
+}
@@ -0,0 +1,80 @@
+#ifndef __HG_AA_GL_READBACK
+#define __HG_AA_GL_READBACK
+
+#include <glad/glad.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "error.h"
+
+// Asynchronous readback of framebuffers through a ring of pixel pack buffers
+// `aa_readback_capture` queues a copy of the colour of a framebuffer into the
+// next buffer of the ring, followed by a fence: nothing waits for the GPU, so
+// the copy adds no bubble to the measured frames. Frames are then consumed in
+// order, a few frames later, once their fence signaled: `aa_readback_acquire`
+// hands out a pointer to the buffer itself (no copy) until
+// `aa_readback_release`.
+// With GL_ARB_buffer_storage the buffers are mapped once, persistently and
+// coherently; otherwise each buffer is mapped while it is acquired.
+
+/// @brief Number of buffers: a frame is typically consumed 2 frames later
+#define AA_READBACK_RING_SIZE 3
+
+/// @brief A captured frame
+typedef struct
+{
+  // RGBA8, bottom row first, tightly packed
+  const uint8_t* pixels;
+  int width;
+  int height;
+  // Value given to `aa_readback_capture`, to identify the frame
+  uint64_t tag;
+} aa_readback_frame;
+
+typedef struct
+{
+  unsigned int buffers[AA_READBACK_RING_SIZE];
+  // Persistent mappings, or NULL if the buffers are only mapped while acquired
+  void* mapped[AA_READBACK_RING_SIZE];
+  GLsync fences[AA_READBACK_RING_SIZE];
+  aa_readback_frame frames[AA_READBACK_RING_SIZE];
+  // Size of every buffer, in bytes
+  size_t capacity;
+  bool persistent;
+  // Oldest pending capture, and number of pending captures
+  uint32_t tail;
+  uint32_t count;
+  // True while the oldest capture is acquired
+  bool acquired;
+} aa_readback;
+
+/// @brief Creates an empty ring (buffers are allocated by the first capture)
+void aa_readback_create(aa_readback* out);
+
+/// @brief Queues a copy of the colour buffer of a framebuffer
+/// @param out The ring
+/// @param fbo The framebuffer to read (0 for the default framebuffer)
+/// @param width Width of the region read, from the bottom left corner
+/// @param height Height of the region read
+/// @param tag Value returned with the frame
+/// @return 0 on success, -1 if the ring is full (the capture is dropped)
+int aa_readback_capture(
+    aa_readback* out, unsigned int fbo, int width, int height, uint64_t tag);
+
+/// @brief Returns the oldest capture if the GPU finished writing it
+/// @param out The ring
+/// @param wait If true, blocks until the capture is available
+/// @return The frame, valid until `aa_readback_release`, or NULL if there is no
+///         capture or it is not available yet
+const aa_readback_frame* aa_readback_acquire(aa_readback* out, bool wait);
+
+/// @brief Returns the buffer of the acquired capture to the ring
+void aa_readback_release(aa_readback* out);
+
+/// @brief Returns the number of captures not released yet
+uint32_t aa_readback_pending(const aa_readback* out);
+
+/// @brief Drops the pending captures and deletes the buffers
+void aa_readback_delete(aa_readback* out);
+
+#endif // !__HG_AA_GL_READBACK
@@ -0,0 +1,251 @@
+#include "shader_assembly.h"
+#include "shaders.h"
+#include "error.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void aa_shader_assembly_push(
+    aa_shader_assembly* out, const char* text, size_t length)
+{
+  if (length == 0)
+    return;
+  if (out->count == AA_SHADER_ASSEMBLY_MAX_PIECES)
+  {
+    printf("Error: Shader assembled from too many pieces\n");
+    out->failed = true;
+    return;
+  }
+  out->strings[out->count] = text;
+  out->lengths[out->count] = (GLint)length;
+  out->count++;
+}
+
+/// @brief Checks if `line` is the preprocessor directive `directive`
+/// @return Pointer past the directive name, or NULL
+static const char* aa_match_directive(const char* line, const char* directive)
+{
+  while (*line == ' ' || *line == '\t')
+    line++;
+  if (*line != '#')
+    return NULL;
+  line++;
+  while (*line == ' ' || *line == '\t')
+    line++;
+  size_t length = strlen(directive);
+  if (strncmp(line, directive, length) != 0)
+    return NULL;
+  return line + length;
+}
+
+void aa_shader_assembly_begin(aa_shader_assembly* out, const char* version)
+{
+  memset(out, 0, sizeof(aa_shader_assembly));
+  aa_shader_assembly_text(out, version);
+}
+
+void aa_shader_assembly_text(aa_shader_assembly* out, const char* text)
+{
+  if (text == NULL)
+  {
+    out->failed = true;
+    return;
+  }
+  aa_shader_assembly_push(out, text, strlen(text));
+}
+
+void aa_shader_assembly_source(aa_shader_assembly* out, const char* source)
+{
+  if (source == NULL)
+  {
+    out->failed = true;
+    return;
+  }
+
+  const char* piece = source;
+  const char* line  = source;
+  while (*line != '\0')
+  {
+    const char* end     = strchr(line, '\n');
+    const char* next    = end ? end + 1 : line + strlen(line);
+    const char* include = aa_match_directive(line, "include");
+    bool is_version     = aa_match_directive(line, "version") != NULL;
+
+    if (include || is_version)
+    {
+      // Everything before the directive is kept as is
+      aa_shader_assembly_push(out, piece, (size_t)(line - piece));
+      piece = next;
+    }
+    if (include)
+    {
+      const char* open  = strchr(include, '"');
+      const char* close = open ? strchr(open + 1, '"') : NULL;
+      if (close == NULL || (end && close > end))
+      {
+        printf("Error: Malformed #include in shader\n");
+        out->failed = true;
+        return;
+      }
+      char name[128];
+      snprintf(name, sizeof(name), "%.*s", (int)(close - open - 1), open + 1);
+      aa_shader_assembly_file(out, name);
+    }
+    if (include || is_version)
+    {
+      // The directive is replaced by an empty line
+      aa_shader_assembly_push(out, "\n", 1);
+    }
+    line = next;
+  }
+  aa_shader_assembly_push(out, piece, (size_t)(line - piece));
+  // Sources do not always end with a new line
+  aa_shader_assembly_push(out, "\n", 1);
+}
+
+void aa_shader_assembly_file(aa_shader_assembly* out, const char* name)
+{
+  const char* source = aa_shader_source(name);
+  // Only the top-level file names the shader (`name` of includes is temporary)
+  if (out->name == NULL)
+    out->name = name;
+  if (source == NULL)
+  {
+    printf("Error: Could not resolve shader `%s`\n", name);
+    out->failed = true;
+    return;
+  }
+  // Like `#pragma once`: the same file is never pasted twice
+  for (uint32_t i = 0; i < out->include_count; i++)
+  {
+    if (out->includes[i] == source)
+      return;
+  }
+  if (out->include_count == AA_SHADER_ASSEMBLY_MAX_INCLUDES)
+  {
+    printf("Error: Shader includes too many files\n");
+    out->failed = true;
+    return;
+  }
+  out->includes[out->include_count++] = source;
+  aa_shader_assembly_source(out, source);
+}
+
+uint64_t aa_shader_assembly_hash(const aa_shader_assembly* assembly)
+{
+  uint64_t hash = 14695981039346656037ull;
+  for (uint32_t i = 0; i < assembly->count; i++)
+  {
+    const unsigned char* bytes = (const unsigned char*)assembly->strings[i];
+    for (GLint j = 0; j < assembly->lengths[i]; j++)
+    {
+      hash ^= bytes[j];
+      hash *= 1099511628211ull;
+    }
+  }
+  return hash;
+}
+
+/// @brief Finds or compiles the shader of an assembly
+/// @return The shader id, or 0 on failure
+static unsigned int aa_shader_cache_get(
+    aa_shader_cache* cache, const aa_shader_assembly* assembly, GLenum type)
+{
+  if (assembly->failed)
+    return 0;
+
+  uint64_t hash = aa_shader_assembly_hash(assembly);
+  for (size_t i = 0; i < cache->count; i++)
+  {
+    if (cache->entries[i].hash == hash && cache->entries[i].type == type)
+    {
+      cache->hits++;
+      return cache->entries[i].id;
+    }
+  }
+
+  if (cache->count == cache->capacity)
+  {
+    size_t capacity = cache->capacity ? cache->capacity * 2 : 32;
+    aa_shader_cache_entry* entries =
+        realloc(cache->entries, capacity * sizeof(aa_shader_cache_entry));
+    if (entries == NULL)
+      return 0;
+    cache->entries  = entries;
+    cache->capacity = capacity;
+  }
+
+  unsigned int id = glCreateShader(type);
+  glCall(glShaderSource(
+      id, (GLsizei)assembly->count, assembly->strings, assembly->lengths));
+  glCall(glCompileShader(id));
+  aa_shader_cache_entry* entry = &cache->entries[cache->count++];
+  entry->hash                  = hash;
+  entry->type                  = type;
+  entry->id                    = id;
+  entry->name                  = assembly->name;
+  entry->checked               = false;
+  return id;
+}
+
+int aa_shader_cache_vertex(
+    aa_shader_cache* cache, const aa_shader_assembly* assembly,
+    aa_vertex_shader* out)
+{
+  out->id = aa_shader_cache_get(cache, assembly, GL_VERTEX_SHADER);
+  return out->id == 0 ? -1 : 0;
+}
+
+int aa_shader_cache_fragment(
+    aa_shader_cache* cache, const aa_shader_assembly* assembly,
+    aa_fragment_shader* out)
+{
+  out->id = aa_shader_cache_get(cache, assembly, GL_FRAGMENT_SHADER);
+  return out->id == 0 ? -1 : 0;
+}
+
+int aa_shader_cache_compute(
+    aa_shader_cache* cache, const aa_shader_assembly* assembly,
+    aa_compute_shader* out)
+{
+  out->id = aa_shader_cache_get(cache, assembly, GL_COMPUTE_SHADER);
+  return out->id == 0 ? -1 : 0;
+}
+
+int aa_shader_cache_check(aa_shader_cache* cache)
+{
+  int result = 0;
+  for (size_t i = 0; i < cache->count; i++)
+  {
+    aa_shader_cache_entry* entry = &cache->entries[i];
+    if (entry->checked)
+      continue;
+    entry->checked = true;
+
+    int success;
+    char infoLog[512];
+    glCall(glGetShaderiv(entry->id, GL_COMPILE_STATUS, &success));
+    if (!success)
+    {
+      glCall(glGetShaderInfoLog(entry->id, 512, NULL, infoLog));
+      const char* type = entry->type == GL_VERTEX_SHADER     ? "VERTEX"
+                         : entry->type == GL_COMPUTE_SHADER ? "COMPUTE"
+                                                            : "FRAGMENT";
+      printf(
+          "ERROR: %s SHADER COMPILATION FAILED (%s)\n%s", type,
+          entry->name ? entry->name : "?", infoLog);
+      result = -1;
+    }
+  }
+  return result;
+}
+
+void aa_shader_cache_delete(aa_shader_cache* cache)
+{
+  for (size_t i = 0; i < cache->count; i++)
+    glCall(glDeleteShader(cache->entries[i].id));
+  free(cache->entries);
+  cache->entries  = NULL;
+  cache->count    = 0;
+  cache->capacity = 0;
+}
@@ -0,0 +1,109 @@
+#ifndef __HG_AA_GL_SHADER_ASSEMBLY
+#define __HG_AA_GL_SHADER_ASSEMBLY
+
+#include <glad/glad.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "program.h"
+
+// Shader source assembly and compiled shader memoisation
+// A shader is assembled from pieces (version line, per-variant defines, sources)
+// that are handed to `glShaderSource` as an array: nothing is concatenated, so a
+// large library such as SMAA.hlsl is never duplicated in memory.
+// `#include "name"` lines are resolved through `aa_shader_source` (each file is
+// included at most once), and `#version` lines inside sources are dropped since
+// the assembly always starts with its own version line.
+
+/// @brief Maximum number of pieces a shader can be assembled from
+#define AA_SHADER_ASSEMBLY_MAX_PIECES 48
+/// @brief Maximum number of distinct files included by a shader
+#define AA_SHADER_ASSEMBLY_MAX_INCLUDES 8
+
+typedef struct
+{
+  const char* strings[AA_SHADER_ASSEMBLY_MAX_PIECES];
+  GLint lengths[AA_SHADER_ASSEMBLY_MAX_PIECES];
+  uint32_t count;
+  // Files already included
+  const char* includes[AA_SHADER_ASSEMBLY_MAX_INCLUDES];
+  uint32_t include_count;
+  // Name of the first file appended, used in error messages
+  const char* name;
+  // Set if a piece did not fit or an include could not be resolved
+  bool failed;
+} aa_shader_assembly;
+
+/// @brief Starts an assembly
+/// @param out The assembly
+/// @param version The version line (e.g. "#version 430 core\n")
+void aa_shader_assembly_begin(aa_shader_assembly* out, const char* version);
+
+/// @brief Appends a piece of text as is (e.g. "#define SMAA_PRESET_LOW 1\n")
+/// @details The text is referenced, not copied: it must outlive the compilation
+void aa_shader_assembly_text(aa_shader_assembly* out, const char* text);
+
+/// @brief Appends a shader source, resolving its `#include` lines
+/// @details The source is referenced, not copied: it must outlive the compilation
+void aa_shader_assembly_source(aa_shader_assembly* out, const char* source);
+
+/// @brief Appends the source of a shader file (see `aa_shader_source`)
+void aa_shader_assembly_file(aa_shader_assembly* out, const char* name);
+
+/// @brief Hashes the assembled text (64 bit FNV-1a), independently of how it is
+///        split into pieces
+uint64_t aa_shader_assembly_hash(const aa_shader_assembly* assembly);
+
+typedef struct
+{
+  uint64_t hash;
+  GLenum type;
+  unsigned int id;
+  const char* name;
+  // True once the compile status was checked
+  bool checked;
+} aa_shader_cache_entry;
+
+// Compiled shaders, indexed by the hash of their assembled source
+// Identical sources (e.g. a vertex shader shared by several variants) are only
+// compiled once. The cache owns the shaders it returns.
+// Compiles are only submitted: the status of every shader is checked at once
+// by `aa_shader_cache_check`, so the driver can compile them in parallel.
+typedef struct
+{
+  aa_shader_cache_entry* entries;
+  size_t count;
+  size_t capacity;
+  // Number of requests served without compiling
+  size_t hits;
+} aa_shader_cache;
+
+/// @brief Returns the vertex shader for an assembly, submitting its compilation
+///        on first use
+/// @return 0 on success, -1 if the assembly failed
+int aa_shader_cache_vertex(
+    aa_shader_cache* cache, const aa_shader_assembly* assembly,
+    aa_vertex_shader* out);
+
+/// @brief Returns the fragment shader for an assembly, submitting its
+///        compilation on first use
+/// @return 0 on success, -1 if the assembly failed
+int aa_shader_cache_fragment(
+    aa_shader_cache* cache, const aa_shader_assembly* assembly,
+    aa_fragment_shader* out);
+
+/// @brief Returns the compute shader for an assembly, submitting its
+///        compilation on first use
+/// @return 0 on success, -1 if the assembly failed
+int aa_shader_cache_compute(
+    aa_shader_cache* cache, const aa_shader_assembly* assembly,
+    aa_compute_shader* out);
+
+/// @brief Waits for the submitted compilations and reports failures
+/// @return 0 if every shader compiled, -1 otherwise
+int aa_shader_cache_check(aa_shader_cache* cache);
+
+/// @brief Deletes every shader of the cache
+void aa_shader_cache_delete(aa_shader_cache* cache);
+
+#endif // !__HG_AA_GL_SHADER_ASSEMBLY
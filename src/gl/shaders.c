@@ -1,6 +1,8 @@
 #include "shaders.h"
+#include "../embedded.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 char* aa_load_file(const char* file_path)
 {
@@ -29,4 +31,65 @@ char* aa_load_file(const char* file_path)
   ret[fread(ret, 1, size, file)] = '\0';
   fclose(file);
   return ret;
-}
\ No newline at end of file
+}
+
+/// @brief Maximum number of shader files read from the override directory
+#define AA_SHADER_FILES_MAX 64
+
+static const char* aa_shader_directory = NULL;
+static struct
+{
+  char name[128];
+  char* source;
+} aa_shader_files[AA_SHADER_FILES_MAX];
+static size_t aa_shader_file_count = 0;
+
+void aa_shaders_set_directory(const char* directory)
+{
+  aa_shader_directory = directory;
+}
+
+const char* aa_shader_source(const char* name)
+{
+  if (name == NULL)
+    return NULL;
+
+  if (aa_shader_directory == NULL)
+  {
+    // Embedded copies need no I/O and no allocation
+    char path[160];
+    snprintf(path, sizeof(path), "shaders/%s", name);
+    const aa_embedded_file* file = aa_embedded_find(path);
+    return file ? (const char*)file->data : NULL;
+  }
+
+  // Files are only read once, even when requested by several pipelines
+  for (size_t i = 0; i < aa_shader_file_count; i++)
+  {
+    if (strcmp(aa_shader_files[i].name, name) == 0)
+      return aa_shader_files[i].source;
+  }
+  if (aa_shader_file_count == AA_SHADER_FILES_MAX)
+    return NULL;
+  char path[512];
+  snprintf(path, sizeof(path), "%s/%s", aa_shader_directory, name);
+  char* source = aa_load_file(path);
+  if (source == NULL)
+  {
+    printf("Error: Could not load shader `%s`\n", path);
+    return NULL;
+  }
+  snprintf(
+      aa_shader_files[aa_shader_file_count].name,
+      sizeof(aa_shader_files[aa_shader_file_count].name), "%s", name);
+  aa_shader_files[aa_shader_file_count].source = source;
+  aa_shader_file_count++;
+  return source;
+}
+
+void aa_shaders_release(void)
+{
+  for (size_t i = 0; i < aa_shader_file_count; i++)
+    free(aa_shader_files[i].source);
+  aa_shader_file_count = 0;
+}
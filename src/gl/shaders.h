@@ -6,4 +6,19 @@
 /// @return Content of the file (must be freed using `free`) or NULL on errors
 char* aa_load_file(const char* file_path);
 
+/// @brief Reads shaders from a directory instead of the embedded copies
+/// @details Meant for development: edited shaders are picked up without
+///          rebuilding. Pass NULL to go back to the embedded shaders.
+/// @param directory The directory (e.g. "resources/shaders"), must outlive its use
+void aa_shaders_set_directory(const char* directory);
+
+/// @brief Returns the source of a shader
+/// @param name The shader file name (e.g. "vertex_default.glsl")
+/// @return The NUL-terminated source, or NULL if not found. The memory is owned
+///         by this module and stays valid until `aa_shaders_release`.
+const char* aa_shader_source(const char* name);
+
+/// @brief Frees the shader files read from the override directory
+void aa_shaders_release(void);
+
 #endif // !__HG_AA_GL_SHADERS
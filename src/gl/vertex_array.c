@@ -47,3 +47,11 @@ void aa_vertex_array_position_uv_attribute(aa_vertex_array* out)
       glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float))));
   glCall(glEnableVertexAttribArray(1));
 }
+
+void aa_vertex_array_instance_index_attribute(aa_vertex_array* out)
+{
+  glCall(glBindVertexArray(out->id));
+  glCall(glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, sizeof(GLuint), (void*)0));
+  glCall(glEnableVertexAttribArray(1));
+  glCall(glVertexAttribDivisor(1, 1));
+}
@@ -18,4 +18,6 @@ void aa_vertex_array_bind(aa_vertex_array* out);
 void aa_vertex_array_position_attribute(aa_vertex_array* out);
 void aa_vertex_array_position_color_attribute(aa_vertex_array* out);
 void aa_vertex_array_position_uv_attribute(aa_vertex_array* out);
+// Per-instance uint index in attribute 1, read from the bound buffer
+void aa_vertex_array_instance_index_attribute(aa_vertex_array* out);
 #endif // !__HG_AA_GL_VERTEX_BUFFER
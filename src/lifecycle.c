@@ -1,10 +1,127 @@
 #include "lifecycle.h"
+#include <stdio.h>
+
+/// @brief Number of samples of the multisampled target of an algorithm
+/// @return The number of samples, 0 if it has none
+static int aa_algorithm_samples(aa_algorithm algorithm)
+{
+  switch (algorithm)
+  {
+  case AA_SMAA_S2X:
+  case AA_SMAA_4X:
+    return 2;
+  case AA_MSAAx4:
+  case AA_MSAAx4_SAMPLE_SHADING:
+  case AA_MSAAx4_RESOLVE:
+    return 4;
+  case AA_MSAAx8:
+  case AA_MSAAx8_RESOLVE:
+    return 8;
+  case AA_MSAAx16:
+  case AA_MSAAx16_RESOLVE:
+    return 16;
+  default:
+    return 0;
+  }
+}
+
+bool aa_algorithm_supported(
+    const AppState* state, aa_algorithm algorithm, char* reason, size_t size)
+{
+  char unused[8];
+  if (reason == NULL)
+  {
+    reason = unused;
+    size   = sizeof(unused);
+  }
+  int samples = aa_algorithm_samples(algorithm);
+  if (samples > 0 && !aa_gl_supports_samples(samples))
+  {
+    int maximum = aa_gl_caps.max_samples < aa_gl_caps.max_color_texture_samples
+                      ? aa_gl_caps.max_samples
+                      : aa_gl_caps.max_color_texture_samples;
+    snprintf(reason, size, "%d samples (device maximum %d)", samples, maximum);
+    return false;
+  }
+  if (algorithm == AA_CMAA2 && !aa_gl_caps.compute)
+  {
+    snprintf(reason, size, "compute shaders");
+    return false;
+  }
+  if (algorithm == AA_SSAA_2X || algorithm == AA_SSAA_4X)
+  {
+    int scale  = AA_SSAA_SCALE(algorithm - AA_SSAA_2X);
+    int width  = state->window_width * scale;
+    int height = state->window_height * scale;
+    if (width > aa_gl_caps.max_texture_size
+        || height > aa_gl_caps.max_texture_size)
+    {
+      snprintf(
+          reason, size, "%dx%d target (device maximum %d)", width, height,
+          aa_gl_caps.max_texture_size);
+      return false;
+    }
+  }
+  return true;
+}
+
+/// @brief Sizes the MSAA x4, x8 and x16 targets the device supports
+static void aa_msaa_dimensions(AppState* state)
+{
+  aa_frame_buffer* fbos[] = {
+      &state->msaa_fbo_x4, &state->msaa_fbo_x8, &state->msaa_fbo_x16};
+  aa_texture* textures[] = {
+      &state->msaa_color_texture_x4, &state->msaa_color_texture_x8,
+      &state->msaa_color_texture_x16};
+  for (uint32_t i = 0; i < 3; i++)
+  {
+    uint8_t samples = (uint8_t)(4 << i);
+    if (!aa_gl_supports_samples(samples))
+      continue;
+    aa_texture_msaa_dimensions(
+        textures[i], state->window_width, state->window_height, samples);
+    aa_frame_buffer_color_texture(fbos[i], textures[i]);
+    // The weights of the custom resolve follow the sample positions
+    aa_frame_buffer_bind(fbos[i]);
+    aa_resolve_table_positions(&state->resolve_tables[i]);
+  }
+}
+
+/// @brief Sizes the SSAA targets that fit in the largest texture
+static void aa_ssaa_dimensions(AppState* state)
+{
+  for (uint32_t i = 0; i < 2; i++)
+  {
+    if (!aa_algorithm_supported(state, AA_SSAA_2X + i, NULL, 0))
+      continue;
+    aa_texture_dimensions(
+        &state->ssaa_color_textures[i], state->window_width * AA_SSAA_SCALE(i),
+        state->window_height * AA_SSAA_SCALE(i));
+    aa_frame_buffer_color_texture(
+        &state->ssaa_fbos[i], &state->ssaa_color_textures[i]);
+    aa_texture_dimensions(
+        &state->ssaa_row_textures[i], state->window_width,
+        state->window_height * AA_SSAA_SCALE(i));
+    aa_frame_buffer_color_texture(
+        &state->ssaa_row_fbos[i], &state->ssaa_row_textures[i]);
+  }
+}
+
+/// @brief Clears both TAA histories (fresh storage holds undefined values,
+///        which the recursive blend would never flush) and marks them stale
+static void aa_taa_history_reset(AppState* state)
+{
+  static const float ZERO[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  for (uint32_t i = 0; i < 2; i++)
+  {
+    aa_frame_buffer_bind(&state->taa_fbos[i]);
+    glClearBufferfv(GL_COLOR, 0, ZERO);
+  }
+  state->taa_history_valid = false;
+}
 
 int on_init(AppState* state)
 {
-  // triangle vertices position
-  static const float vertices[] = {-0.5f, -0.5f, 0.0f, 0.5f, -0.5f,
-                                   0.0f,  0.0f,  0.5f, 0.0f};
   // fullscreenquad positions and uv coordinates, used for fxaa
   static const float fullscreen_vertices[] = {
       -1.0f, -1.0f, 0.0f,  0.0f, 0.0f, 1.0f, -1.0f, 0.0f,
@@ -13,143 +130,209 @@ int on_init(AppState* state)
       -1.0f, -1.0f, 0.0f,  0.0f, 0.0f, 1.0f, 1.0f,  0.0f,
       1.0f,  1.0f,  -1.0f, 1.0f, 0.0f, 0.0f, 1.0f};
 
-  // Basic shaders
-  char* VERTEX_DEFAULT   = aa_load_file("resources/shaders/vertex_default.glsl");
-  char* FRAGMENT_DEFAULT = aa_load_file("resources/shaders/fragment_default.glsl");
-
-  char* VERTEX_FULLSCREEN_QUAD =
-      aa_load_file("resources/shaders/vertex_fullscreen_quad.glsl");
-  char* FRAGMENT_FXAA = aa_load_file("resources/shaders/fragment_fxaa.glsl");
-  char* FRAGMENT_FXAA_ITER =
-      aa_load_file("resources/shaders/fragment_fxaa_iterative.glsl");
-
-  // SMAA shaders common part across settings
-  char* VERTEX_EDGE_SMAA_BODY =
-      aa_load_file("resources/shaders/vertex_edge_smaa.glsl");
-  char* VERTEX_BLEND_SMAA_BODY =
-      aa_load_file("resources/shaders/vertex_blend_smaa.glsl");
-  char* VERTEX_NEIGHBORHOOD_SMAA_BODY =
-      aa_load_file("resources/shaders/vertex_neighborhood_smaa.glsl");
-  char* FRAGMENT_EDGE_SMAA_BODY =
-      aa_load_file("resources/shaders/fragment_edge_smaa.glsl");
-  char* FRAGMENT_BLEND_SMAA_BODY =
-      aa_load_file("resources/shaders/fragment_blend_smaa.glsl");
-  char* FRAGMENT_NEIGHBORHOOD_SMAA_BODY =
-      aa_load_file("resources/shaders/fragment_neighborhood_smaa.glsl");
-
-  // Assembling SMAA shaders
-  char* SMAA_LIB = aa_load_file("resources/shaders/SMAA.hlsl");
-  if (!SMAA_LIB)
+  // Scenes read their instance transforms from a storage buffer (batch.h),
+  // which OpenGL 4.3 does not require vertex shaders to support
+  GLint vertex_storage_blocks = 0;
+  glCall(
+      glGetIntegerv(GL_MAX_VERTEX_SHADER_STORAGE_BLOCKS, &vertex_storage_blocks));
+  if (vertex_storage_blocks < 1)
   {
-    printf("Error loading SMAA.hlsl\n");
+    printf("Error: vertex shaders cannot read shader storage buffers.\n");
     return -1;
   }
-  // LOW
-  aa_smaa_pipeline_init(
-      &state->smaa_low, "#define SMAA_PRESET_LOW 1\n", SMAA_LIB,
-      VERTEX_EDGE_SMAA_BODY, FRAGMENT_EDGE_SMAA_BODY, VERTEX_BLEND_SMAA_BODY,
-      FRAGMENT_BLEND_SMAA_BODY, VERTEX_NEIGHBORHOOD_SMAA_BODY,
-      FRAGMENT_NEIGHBORHOOD_SMAA_BODY);
-  // MEDIUM
-  aa_smaa_pipeline_init(
-      &state->smaa_medium, "#define SMAA_PRESET_MEDIUM 1\n", SMAA_LIB,
-      VERTEX_EDGE_SMAA_BODY, FRAGMENT_EDGE_SMAA_BODY, VERTEX_BLEND_SMAA_BODY,
-      FRAGMENT_BLEND_SMAA_BODY, VERTEX_NEIGHBORHOOD_SMAA_BODY,
-      FRAGMENT_NEIGHBORHOOD_SMAA_BODY);
-  
-  // HIGH
-  aa_smaa_pipeline_init(
-      &state->smaa_high, "#define SMAA_PRESET_HIGH 1\n", SMAA_LIB,
-      VERTEX_EDGE_SMAA_BODY, FRAGMENT_EDGE_SMAA_BODY, VERTEX_BLEND_SMAA_BODY,
-      FRAGMENT_BLEND_SMAA_BODY, VERTEX_NEIGHBORHOOD_SMAA_BODY,
-      FRAGMENT_NEIGHBORHOOD_SMAA_BODY);
-  // ULTRA
-  aa_smaa_pipeline_init(
-      &state->smaa_ultra, "#define SMAA_PRESET_ULTRA 1\n", SMAA_LIB,
-      VERTEX_EDGE_SMAA_BODY, FRAGMENT_EDGE_SMAA_BODY, VERTEX_BLEND_SMAA_BODY,
-      FRAGMENT_BLEND_SMAA_BODY, VERTEX_NEIGHBORHOOD_SMAA_BODY,
-      FRAGMENT_NEIGHBORHOOD_SMAA_BODY);
 
-  // Sampling logic
-  state->samples_total   = AA_SAMPLE_COUNT;
-  state->samples_current = 0;
-  size_t samples_bytes   = sizeof(uint32_t) * state->samples_total;
-  state->samples         = malloc(samples_bytes);
-  state->is_recording    = false;
-  if (state->samples == NULL)
+  // SMAA lookup tables
+  aa_startup_begin("lookup tables");
+  const aa_embedded_file* AREA_TEX   = aa_embedded_find("smaa/AreaTex.bin");
+  const aa_embedded_file* SEARCH_TEX = aa_embedded_find("smaa/SearchTex.bin");
+  if (AREA_TEX == NULL || AREA_TEX->size != AREATEX_SIZE || SEARCH_TEX == NULL
+      || SEARCH_TEX->size != SEARCHTEX_SIZE)
+  {
+    printf("Error: SMAA lookup tables are missing or corrupted.\n");
     return -1;
-  memset(state->samples, 0, samples_bytes);
-  state->current_algorithm_file_name = "aa_NONE.txt";
-
-  // Check if any file failed to load
-  if (VERTEX_DEFAULT == NULL || FRAGMENT_DEFAULT == NULL
-      || VERTEX_FULLSCREEN_QUAD == NULL || FRAGMENT_FXAA == NULL
-      || FRAGMENT_FXAA_ITER == NULL || SMAA_LIB == NULL
-      || VERTEX_EDGE_SMAA_BODY == NULL || VERTEX_BLEND_SMAA_BODY == NULL
-      || VERTEX_NEIGHBORHOOD_SMAA_BODY == NULL || FRAGMENT_EDGE_SMAA_BODY == NULL
-      || FRAGMENT_BLEND_SMAA_BODY == NULL || FRAGMENT_NEIGHBORHOOD_SMAA_BODY == NULL)
+  }
+  aa_startup_end();
+
+  aa_startup_begin("shader submission");
+  uint64_t startup_begin_ns = aa_clock_ns();
+  // Let the driver compile on as many threads as it wants
+  if (aa_gl_ext.parallel_shader_compile)
+    aa_gl_ext.MaxShaderCompilerThreads(0xFFFFFFFFu);
+
+  // Every compile and link below is only submitted: their status is checked
+  // once the remaining resources are set up, so the driver compiles meanwhile.
+
+  // Assembling SMAA shaders (sources are embedded at build time, or read
+  // from `--shader-dir`)
+  aa_startup_begin("smaa pipelines");
+  if (aa_smaa_pipeline_init(
+          &state->smaa_low, &state->shader_cache, "#define SMAA_PRESET_LOW 1\n")
+          != 0
+      || aa_smaa_pipeline_init(
+             &state->smaa_medium, &state->shader_cache,
+             "#define SMAA_PRESET_MEDIUM 1\n")
+             != 0
+      || aa_smaa_pipeline_init(
+             &state->smaa_high, &state->shader_cache,
+             "#define SMAA_PRESET_HIGH 1\n")
+             != 0
+      || aa_smaa_pipeline_init(
+             &state->smaa_ultra, &state->shader_cache,
+             "#define SMAA_PRESET_ULTRA 1\n")
+             != 0
+      || aa_smaa_custom_init(&state->smaa_custom, &state->shader_cache) != 0
+      || aa_smaa_temporal_init(
+             &state->smaa_t2x, &state->shader_cache,
+             "#define SMAA_PRESET_MEDIUM 1\n")
+             != 0
+      || aa_smaa_temporal_init(
+             &state->smaa_4x, &state->shader_cache,
+             "#define SMAA_PRESET_HIGH 1\n")
+             != 0
+      || aa_smaa_separate_init(&state->smaa_separate, &state->shader_cache, false)
+             != 0
+      || aa_smaa_separate_init(
+             &state->smaa_separate_4x, &state->shader_cache, true)
+             != 0)
   {
-    free(VERTEX_DEFAULT);
-    free(FRAGMENT_DEFAULT);
-    free(VERTEX_FULLSCREEN_QUAD);
-    free(FRAGMENT_FXAA);
-    free(FRAGMENT_FXAA_ITER);
-    free(SMAA_LIB);
-    free(VERTEX_EDGE_SMAA_BODY);
-    free(VERTEX_BLEND_SMAA_BODY);
-    free(VERTEX_NEIGHBORHOOD_SMAA_BODY);
-    free(FRAGMENT_EDGE_SMAA_BODY);
-    free(FRAGMENT_BLEND_SMAA_BODY);
-    free(FRAGMENT_NEIGHBORHOOD_SMAA_BODY);
-    printf("Error: One or more shader files failed to load.\n");
     return -1;
   }
-  // Create time query
-  aa_time_query_create(&state->query);
+  aa_startup_end();
+
+  if (aa_cmaa2_init(&state->cmaa2, &state->shader_cache) != 0)
+    return -1;
 
   // create programs
   aa_program_create(&state->program);
   aa_program_create(&state->fxaa_program);
-  aa_program_create(&state->fxaa_iterative_program);
-
-  // create shaders
-  aa_vertex_shader_create(&state->default_vertex_shader, VERTEX_DEFAULT);
-  aa_fragment_shader_create(&state->default_fragment_shader, FRAGMENT_DEFAULT);
-  aa_vertex_shader_create(
-      &state->fullscreen_quad_vertex_shader, VERTEX_FULLSCREEN_QUAD);
-  aa_fragment_shader_create(&state->fxaa_fragment_shader, FRAGMENT_FXAA);
-  aa_fragment_shader_create(
-      &state->fxaa_iterative_fragment_shader, FRAGMENT_FXAA_ITER);
-
-  // compile shaders
-  aa_vertex_shader_compile(&state->default_vertex_shader);
-  aa_fragment_shader_compile(&state->default_fragment_shader);
-  aa_vertex_shader_compile(&state->fullscreen_quad_vertex_shader);
-  aa_fragment_shader_compile(&state->fxaa_fragment_shader);
-  aa_fragment_shader_compile(&state->fxaa_iterative_fragment_shader);
+  aa_program_create(&state->taa_program);
+  aa_program_create(&state->mlaa_edge_program);
+  aa_program_create(&state->mlaa_weight_program);
+  aa_program_create(&state->mlaa_blend_program);
+  aa_program_create(&state->ssaa_program);
+  aa_program_create(&state->resolve_program);
+
+  // create and compile shaders
+  aa_shader_assembly assembly;
+  int result = 0;
+  aa_shader_assembly_begin(&assembly, "#version 430 core\n");
+  aa_shader_assembly_file(&assembly, "vertex_default.glsl");
+  result |= aa_shader_cache_vertex(
+      &state->shader_cache, &assembly, &state->default_vertex_shader);
+  aa_shader_assembly_begin(&assembly, "#version 430 core\n");
+  aa_shader_assembly_file(&assembly, "fragment_default.glsl");
+  result |= aa_shader_cache_fragment(
+      &state->shader_cache, &assembly, &state->default_fragment_shader);
+  aa_shader_assembly_begin(&assembly, "#version 430 core\n");
+  aa_shader_assembly_file(&assembly, "vertex_fullscreen_quad.glsl");
+  result |= aa_shader_cache_vertex(
+      &state->shader_cache, &assembly, &state->fullscreen_quad_vertex_shader);
+  aa_shader_assembly_begin(&assembly, "#version 430 core\n");
+  aa_shader_assembly_file(&assembly, "fragment_fxaa.glsl");
+  result |= aa_shader_cache_fragment(
+      &state->shader_cache, &assembly, &state->fxaa_fragment_shader);
+  aa_shader_assembly_begin(&assembly, "#version 430 core\n");
+  aa_shader_assembly_file(&assembly, "fragment_taa.glsl");
+  result |= aa_shader_cache_fragment(
+      &state->shader_cache, &assembly, &state->taa_fragment_shader);
+  aa_shader_assembly_begin(&assembly, "#version 430 core\n");
+  aa_shader_assembly_file(&assembly, "fragment_mlaa_edges.glsl");
+  result |= aa_shader_cache_fragment(
+      &state->shader_cache, &assembly, &state->mlaa_edge_fragment_shader);
+  aa_shader_assembly_begin(&assembly, "#version 430 core\n");
+  aa_shader_assembly_file(&assembly, "fragment_mlaa_weights.glsl");
+  result |= aa_shader_cache_fragment(
+      &state->shader_cache, &assembly, &state->mlaa_weight_fragment_shader);
+  aa_shader_assembly_begin(&assembly, "#version 430 core\n");
+  aa_shader_assembly_file(&assembly, "fragment_mlaa_blend.glsl");
+  result |= aa_shader_cache_fragment(
+      &state->shader_cache, &assembly, &state->mlaa_blend_fragment_shader);
+  aa_shader_assembly_begin(&assembly, "#version 430 core\n");
+  aa_shader_assembly_file(&assembly, "fragment_ssaa_downsample.glsl");
+  result |= aa_shader_cache_fragment(
+      &state->shader_cache, &assembly, &state->ssaa_fragment_shader);
+  aa_shader_assembly_begin(&assembly, "#version 430 core\n");
+  aa_shader_assembly_file(&assembly, "fragment_msaa_resolve.glsl");
+  result |= aa_shader_cache_fragment(
+      &state->shader_cache, &assembly, &state->resolve_fragment_shader);
+  // Iterative FXAA variants (submits the default one, linked with the others)
+  result |= aa_fxaa_iterative_init(
+      &state->fxaa_iterative, &state->shader_cache,
+      &state->fullscreen_quad_vertex_shader);
+  if (result != 0)
+  {
+    printf("Error: One or more shader files failed to load.\n");
+    return -1;
+  }
 
   // attach shaders and link programs
   aa_program_attach_shaders(
       &state->fxaa_program, &state->fullscreen_quad_vertex_shader,
       &state->fxaa_fragment_shader);
-  aa_program_link(&state->fxaa_program);
+  aa_program_link_submit(&state->fxaa_program);
 
   aa_program_attach_shaders(
-      &state->fxaa_iterative_program, &state->fullscreen_quad_vertex_shader,
-      &state->fxaa_iterative_fragment_shader);
-  aa_program_link(&state->fxaa_iterative_program);
+      &state->taa_program, &state->fullscreen_quad_vertex_shader,
+      &state->taa_fragment_shader);
+  aa_program_link_submit(&state->taa_program);
+
+  aa_program_attach_shaders(
+      &state->mlaa_edge_program, &state->fullscreen_quad_vertex_shader,
+      &state->mlaa_edge_fragment_shader);
+  aa_program_link_submit(&state->mlaa_edge_program);
+  aa_program_attach_shaders(
+      &state->mlaa_weight_program, &state->fullscreen_quad_vertex_shader,
+      &state->mlaa_weight_fragment_shader);
+  aa_program_link_submit(&state->mlaa_weight_program);
+  aa_program_attach_shaders(
+      &state->mlaa_blend_program, &state->fullscreen_quad_vertex_shader,
+      &state->mlaa_blend_fragment_shader);
+  aa_program_link_submit(&state->mlaa_blend_program);
+
+  aa_program_attach_shaders(
+      &state->ssaa_program, &state->fullscreen_quad_vertex_shader,
+      &state->ssaa_fragment_shader);
+  aa_program_link_submit(&state->ssaa_program);
+
+  aa_program_attach_shaders(
+      &state->resolve_program, &state->fullscreen_quad_vertex_shader,
+      &state->resolve_fragment_shader);
+  aa_program_link_submit(&state->resolve_program);
 
   aa_program_attach_shaders(
       &state->program, &state->default_vertex_shader,
       &state->default_fragment_shader);
-  aa_program_link(&state->program);
+  aa_program_link_submit(&state->program);
+
+  // Sources read from `--shader-dir` are not needed once submitted
+  aa_shaders_release();
+  uint64_t submitted_ns = aa_clock_ns();
+  aa_startup_end();
 
-  // triangle vao and vbo setup
-  aa_vertex_buffer_create(&state->vbo);
-  aa_vertex_buffer_update(&state->vbo, vertices, sizeof(vertices));
+  // Render targets and buffers, set up while the driver compiles
+  aa_startup_begin("resource setup");
 
-  aa_vertex_array_create(&state->vao);
-  aa_vertex_array_position_attribute(&state->vao);
+  // Sampling logic
+  state->samples_total   = AA_SAMPLE_COUNT;
+  state->samples_current = 0;
+  size_t samples_bytes   = sizeof(uint32_t) * state->samples_total;
+  state->samples         = malloc(samples_bytes);
+  state->cpu_samples     = malloc(samples_bytes);
+  state->is_recording    = false;
+  if (state->samples == NULL || state->cpu_samples == NULL)
+    return -1;
+  memset(state->samples, 0, samples_bytes);
+  memset(state->cpu_samples, 0, samples_bytes);
+  state->current_algorithm_file_name = "aa_NONE.txt";
+
+  // Create time query
+  aa_time_query_create(&state->query);
+  aa_readback_create(&state->readback);
+  if (aa_trace_init(&state->trace) != 0)
+  {
+    printf("Error initializing trace\n");
+    return -1;
+  }
 
   // fullscreen quad vao and vbo setup
   aa_vertex_buffer_create(&state->fullscreen_vbo);
@@ -158,26 +341,16 @@ int on_init(AppState* state)
   aa_vertex_array_create(&state->fullscreen_vao);
   aa_vertex_array_position_uv_attribute(&state->fullscreen_vao);
 
-  // MSAA multisampling fbo and texture initialization
+  // MSAA multisampling fbo and texture initialization (sample counts the
+  // device does not support are left without storage, and their algorithms
+  // are refused by `aa_algorithm_supported`)
   aa_frame_buffer_create(&state->msaa_fbo_x4);
   aa_frame_buffer_create(&state->msaa_fbo_x8);
   aa_frame_buffer_create(&state->msaa_fbo_x16);
-
   aa_texture_msaa_create(&state->msaa_color_texture_x4);
-  aa_texture_msaa_dimensions(
-      &state->msaa_color_texture_x4, state->window_width, state->window_height, 4);
-
   aa_texture_msaa_create(&state->msaa_color_texture_x8);
-  aa_texture_msaa_dimensions(
-      &state->msaa_color_texture_x8, state->window_width, state->window_height, 8);
-
   aa_texture_msaa_create(&state->msaa_color_texture_x16);
-  aa_texture_msaa_dimensions(
-      &state->msaa_color_texture_x16, state->window_width, state->window_height, 16);
-  aa_frame_buffer_color_texture(&state->msaa_fbo_x4, &state->msaa_color_texture_x4);
-  aa_frame_buffer_color_texture(&state->msaa_fbo_x8, &state->msaa_color_texture_x8);
-  aa_frame_buffer_color_texture(
-      &state->msaa_fbo_x16, &state->msaa_color_texture_x16);
+  aa_msaa_dimensions(state);
   aa_frame_buffer_bind(&state->default_fbo);
 
   // FXAA fbo and screen texture initialization
@@ -190,30 +363,187 @@ int on_init(AppState* state)
   aa_frame_buffer_create(&state->smaa_fbo);
   aa_frame_buffer_create(&state->smaa_edge_fbo);
   aa_frame_buffer_create(&state->smaa_blend_fbo);
-  aa_smaa_area_texture(&state->smaa_area_texture, areaTexBytes, 160, 560);
-  aa_smaa_search_texture(&state->smaa_search_texture, searchTexBytes, 60, 33);
+  aa_smaa_area_texture(
+      &state->smaa_area_texture, AREA_TEX->data, AREATEX_WIDTH, AREATEX_HEIGHT);
+  aa_smaa_search_texture(
+      &state->smaa_search_texture, SEARCH_TEX->data, SEARCHTEX_WIDTH,
+      SEARCHTEX_HEIGHT);
   aa_texture_create(
       &state->smaa_color_texture, state->window_width, state->window_height);
   aa_texture_create(
       &state->smaa_edge_texture, state->window_width, state->window_height);
   aa_texture_create(
       &state->smaa_blend_texture, state->window_width, state->window_height);
+  aa_texture_create_format(
+      &state->smaa_depth_texture, state->window_width, state->window_height,
+      GL_DEPTH_COMPONENT32F);
   aa_frame_buffer_color_texture(&state->smaa_fbo, &state->smaa_color_texture);
+  aa_frame_buffer_depth_texture(&state->smaa_fbo, &state->smaa_depth_texture);
   aa_frame_buffer_color_texture(&state->smaa_edge_fbo, &state->smaa_edge_texture);
   aa_frame_buffer_color_texture(&state->smaa_blend_fbo, &state->smaa_blend_texture);
 
-  // Free uncompiled shaders memory
-  free(VERTEX_DEFAULT);
-  free(FRAGMENT_DEFAULT);
-  free(VERTEX_FULLSCREEN_QUAD);
-  free(FRAGMENT_FXAA);
-  free(FRAGMENT_FXAA_ITER);
+  // SMAA T2x fbos: the scene writes its velocity next to its colour, and the
+  // anti-aliased subsamples are kept for the next frame
+  aa_frame_buffer_create(&state->smaa_t2x_fbo);
+  aa_texture_create_format(
+      &state->smaa_velocity_texture, state->window_width, state->window_height,
+      GL_RG16F);
+  aa_texture* t2x_targets[] = {
+      &state->smaa_color_texture, &state->smaa_velocity_texture};
+  aa_frame_buffer_color_textures(&state->smaa_t2x_fbo, t2x_targets, 2);
+  for (uint32_t i = 0; i < 2; i++)
+  {
+    aa_frame_buffer_create(&state->smaa_history_fbos[i]);
+    aa_texture_create(
+        &state->smaa_history_textures[i], state->window_width,
+        state->window_height);
+    aa_frame_buffer_color_texture(
+        &state->smaa_history_fbos[i], &state->smaa_history_textures[i]);
+  }
+
+  // SMAA S2x and 4x fbos: the scene is drawn with MSAA x2 (with its velocity
+  // for 4x), then its samples are separated into single-sampled textures
+  aa_frame_buffer_create(&state->msaa_fbo_x2);
+  aa_frame_buffer_create(&state->smaa_4x_fbo);
+  aa_frame_buffer_create(&state->smaa_separate_fbo);
+  aa_frame_buffer_create(&state->smaa_separate_4x_fbo);
+  aa_texture_msaa_create(&state->msaa_color_texture_x2);
+  aa_texture_msaa_create_format(&state->msaa_velocity_texture_x2, GL_RG16F);
+  const bool MSAA_X2 = aa_gl_supports_samples(2);
+  if (MSAA_X2)
+  {
+    aa_texture_msaa_dimensions(
+        &state->msaa_color_texture_x2, state->window_width,
+        state->window_height, 2);
+    aa_texture_msaa_dimensions(
+        &state->msaa_velocity_texture_x2, state->window_width,
+        state->window_height, 2);
+  }
+  for (uint32_t i = 0; i < 2; i++)
+  {
+    aa_texture_create(
+        &state->smaa_sample_textures[i], state->window_width,
+        state->window_height);
+  }
+  aa_texture* msaa_4x_targets[] = {
+      &state->msaa_color_texture_x2, &state->msaa_velocity_texture_x2};
+  aa_texture* separate_targets[] = {
+      &state->smaa_sample_textures[0], &state->smaa_sample_textures[1],
+      &state->smaa_velocity_texture};
+  if (MSAA_X2)
+  {
+    aa_frame_buffer_color_texture(
+        &state->msaa_fbo_x2, &state->msaa_color_texture_x2);
+    aa_frame_buffer_color_textures(&state->smaa_4x_fbo, msaa_4x_targets, 2);
+  }
+  aa_frame_buffer_color_textures(&state->smaa_separate_fbo, separate_targets, 2);
+  aa_frame_buffer_color_textures(
+      &state->smaa_separate_4x_fbo, separate_targets, 3);
+
+  // SSAA targets, supersampled and downsampled along the rows (sized when
+  // they fit)
+  for (uint32_t i = 0; i < 2; i++)
+  {
+    aa_frame_buffer_create(&state->ssaa_fbos[i]);
+    aa_texture_create(&state->ssaa_color_textures[i], 1, 1);
+    aa_frame_buffer_create(&state->ssaa_row_fbos[i]);
+    aa_texture_create(&state->ssaa_row_textures[i], 1, 1);
+  }
+  aa_ssaa_dimensions(state);
+
+  // CMAA2 images and lists (the colour is `fxaa_color_texture`)
+  if (aa_cmaa2_dimensions(
+          &state->cmaa2, state->window_width, state->window_height) != 0)
+    return -1;
+
+  // TAA history
+  for (uint32_t i = 0; i < 2; i++)
+  {
+    aa_frame_buffer_create(&state->taa_fbos[i]);
+    aa_texture_create_format(
+        &state->taa_history_textures[i], state->window_width,
+        state->window_height, GL_RGBA16F);
+    aa_frame_buffer_color_texture(
+        &state->taa_fbos[i], &state->taa_history_textures[i]);
+  }
+  aa_taa_history_reset(state);
 
-  if (dartboard_init(&state->dartboard) != 0)
+  // The sample positions of the MSAA x2 target select the area textures
+  float positions[2][2] = {{0.25f, 0.25f}, {0.75f, 0.75f}};
+  aa_frame_buffer_bind(&state->msaa_fbo_x2);
+  if (MSAA_X2)
+  {
+    glCall(glGetMultisamplefv(GL_SAMPLE_POSITION, 0, positions[0]));
+    glCall(glGetMultisamplefv(GL_SAMPLE_POSITION, 1, positions[1]));
+  }
+  if (aa_smaa_separate_indices(
+          (const float(*)[2])positions, state->smaa_s2x_centre,
+          state->smaa_s2x_indices, state->smaa_4x_indices)
+      != 0)
   {
-    printf("Error initializing dartboard\n");
+    printf(
+        "Warning: MSAA x2 samples at (%.3f, %.3f) and (%.3f, %.3f) are not "
+        "diagonal, SMAA S2x processes them like SMAA 1x\n",
+        positions[0][0], positions[0][1], positions[1][0], positions[1][1]);
+  }
+  aa_frame_buffer_bind(&state->default_fbo);
+
+  uint64_t setup_ns = aa_clock_ns();
+  aa_startup_end();
+
+  // Wait for the shaders and programs (reporting every failure at once)
+  aa_startup_begin("shader wait");
+  aa_program* programs[] = {
+      &state->program, &state->fxaa_program,
+      aa_fxaa_iterative_default(&state->fxaa_iterative),
+      &state->smaa_separate.program, &state->smaa_separate_4x.program,
+      &state->taa_program, &state->mlaa_edge_program,
+      &state->mlaa_weight_program, &state->mlaa_blend_program,
+      &state->ssaa_program, &state->resolve_program};
+  aa_smaa_pipeline* pipelines[] = {
+      &state->smaa_low, &state->smaa_medium, &state->smaa_high,
+      &state->smaa_ultra, aa_smaa_custom_default(&state->smaa_custom)};
+  aa_smaa_temporal* temporals[] = {&state->smaa_t2x, &state->smaa_4x};
+  const uint32_t PROGRAM_COUNT  = sizeof(programs) / sizeof(programs[0]);
+  const uint32_t PIPELINE_COUNT = sizeof(pipelines) / sizeof(pipelines[0]);
+  const uint32_t TEMPORAL_COUNT = sizeof(temporals) / sizeof(temporals[0]);
+  uint32_t ready                = 0;
+  for (uint32_t i = 0; i < PROGRAM_COUNT; i++)
+    ready += (uint32_t)aa_program_link_ready(programs[i]);
+  for (uint32_t i = 0; i < PIPELINE_COUNT; i++)
+    ready += aa_smaa_pipeline_ready(pipelines[i]);
+  for (uint32_t i = 0; i < TEMPORAL_COUNT; i++)
+    ready += aa_smaa_temporal_ready(temporals[i]);
+  ready += aa_cmaa2_ready(&state->cmaa2);
+
+  result = aa_shader_cache_check(&state->shader_cache);
+  for (uint32_t i = 0; i < PROGRAM_COUNT; i++)
+    result |= aa_program_link_check(programs[i]);
+  for (uint32_t i = 0; i < PIPELINE_COUNT; i++)
+    result |= aa_smaa_pipeline_check(pipelines[i]);
+  for (uint32_t i = 0; i < TEMPORAL_COUNT; i++)
+    result |= aa_smaa_temporal_check(temporals[i]);
+  result |= aa_cmaa2_check(&state->cmaa2);
+  if (result != 0)
+  {
+    printf("Error: One or more shaders failed to compile.\n");
     return -1;
   }
+  uint64_t linked_ns = aa_clock_ns();
+  aa_startup_end();
+
+  printf(
+      "Startup: %zu shaders (%zu shared), %" PRIu32 " programs, parallel "
+      "compile %s\n"
+      "  submit %.2f ms, overlapped setup %.2f ms (%" PRIu32
+      " programs ready), wait %.2f ms, total %.2f ms\n",
+      state->shader_cache.count, state->shader_cache.hits,
+      PROGRAM_COUNT + 3 * PIPELINE_COUNT + 4 * TEMPORAL_COUNT + 4,
+      aa_gl_ext.parallel_shader_compile ? "on" : "off",
+      (double)(submitted_ns - startup_begin_ns) / 1e6,
+      (double)(setup_ns - submitted_ns) / 1e6, ready,
+      (double)(linked_ns - setup_ns) / 1e6,
+      (double)(linked_ns - startup_begin_ns) / 1e6);
 
   return 0;
 }
@@ -223,18 +553,20 @@ void on_end(AppState* state)
   // Delete Programs
   aa_program_delete(&state->program);
   aa_program_delete(&state->fxaa_program);
-  aa_program_delete(&state->fxaa_iterative_program);
-
-  // Delete Shaders
-  aa_vertex_shader_delete(&state->default_vertex_shader);
-  aa_fragment_shader_delete(&state->default_fragment_shader);
-  aa_vertex_shader_delete(&state->fullscreen_quad_vertex_shader);
-  aa_fragment_shader_delete(&state->fxaa_fragment_shader);
-  aa_fragment_shader_delete(&state->fxaa_iterative_fragment_shader);
+  aa_fxaa_iterative_delete(&state->fxaa_iterative);
+  aa_program_delete(&state->smaa_separate.program);
+  aa_program_delete(&state->smaa_separate_4x.program);
+  aa_program_delete(&state->taa_program);
+  aa_program_delete(&state->mlaa_edge_program);
+  aa_program_delete(&state->mlaa_weight_program);
+  aa_program_delete(&state->mlaa_blend_program);
+  aa_program_delete(&state->ssaa_program);
+  aa_program_delete(&state->resolve_program);
+
+  // Delete Shaders (including the ones of the SMAA pipelines)
+  aa_shader_cache_delete(&state->shader_cache);
 
   // Delete Buffers and vaos
-  aa_vertex_buffer_delete(&state->vbo);
-  aa_vertex_array_delete(&state->vao);
   aa_vertex_buffer_delete(&state->fullscreen_vbo);
   aa_vertex_array_delete(&state->fullscreen_vao);
 
@@ -246,6 +578,20 @@ void on_end(AppState* state)
   aa_frame_buffer_delete(&state->smaa_fbo);
   aa_frame_buffer_delete(&state->smaa_edge_fbo);
   aa_frame_buffer_delete(&state->smaa_blend_fbo);
+  aa_frame_buffer_delete(&state->smaa_t2x_fbo);
+  aa_frame_buffer_delete(&state->smaa_history_fbos[0]);
+  aa_frame_buffer_delete(&state->smaa_history_fbos[1]);
+  aa_frame_buffer_delete(&state->msaa_fbo_x2);
+  aa_frame_buffer_delete(&state->smaa_4x_fbo);
+  aa_frame_buffer_delete(&state->smaa_separate_fbo);
+  aa_frame_buffer_delete(&state->smaa_separate_4x_fbo);
+  aa_frame_buffer_delete(&state->taa_fbos[0]);
+  aa_frame_buffer_delete(&state->taa_fbos[1]);
+  for (uint32_t i = 0; i < 2; i++)
+  {
+    aa_frame_buffer_delete(&state->ssaa_fbos[i]);
+    aa_frame_buffer_delete(&state->ssaa_row_fbos[i]);
+  }
 
   // Delete Textures
   aa_texture_delete(&state->msaa_color_texture_x4);
@@ -253,38 +599,60 @@ void on_end(AppState* state)
   aa_texture_delete(&state->msaa_color_texture_x16);
   aa_texture_delete(&state->fxaa_color_texture);
   aa_texture_delete(&state->smaa_color_texture);
+  aa_texture_delete(&state->smaa_depth_texture);
   aa_texture_delete(&state->smaa_area_texture);
   aa_texture_delete(&state->smaa_search_texture);
   aa_texture_delete(&state->smaa_edge_texture);
   aa_texture_delete(&state->smaa_blend_texture);
+  aa_texture_delete(&state->smaa_velocity_texture);
+  aa_texture_delete(&state->smaa_history_textures[0]);
+  aa_texture_delete(&state->smaa_history_textures[1]);
+  aa_texture_delete(&state->msaa_color_texture_x2);
+  aa_texture_delete(&state->msaa_velocity_texture_x2);
+  aa_texture_delete(&state->smaa_sample_textures[0]);
+  aa_texture_delete(&state->smaa_sample_textures[1]);
+  aa_texture_delete(&state->taa_history_textures[0]);
+  aa_texture_delete(&state->taa_history_textures[1]);
+  for (uint32_t i = 0; i < 2; i++)
+  {
+    aa_texture_delete(&state->ssaa_color_textures[i]);
+    aa_texture_delete(&state->ssaa_row_textures[i]);
+  }
 
   // Delete SMAA Pipelines
   aa_smaa_pipeline_delete(&state->smaa_low);
   aa_smaa_pipeline_delete(&state->smaa_medium);
   aa_smaa_pipeline_delete(&state->smaa_high);
   aa_smaa_pipeline_delete(&state->smaa_ultra);
+  aa_smaa_custom_delete(&state->smaa_custom);
+  aa_smaa_temporal_delete(&state->smaa_t2x);
+  aa_smaa_temporal_delete(&state->smaa_4x);
+
+  // Delete CMAA2 kernels, images and buffers
+  aa_cmaa2_delete(&state->cmaa2);
+  aa_cpu_mlaa_delete(&state->cpu_mlaa);
+  free(state->cpu_mlaa_pixels);
 
   // Delete Query
   aa_time_query_delete(&state->query);
+  aa_trace_delete(&state->trace);
   free(state->samples);
-
-  // Delete Dartboard Scene Specific Data
-  dartboard_cleanup(&state->dartboard);
+  free(state->cpu_samples);
+  free(state->matrix);
+  aa_reference_delete(&state->reference);
+  aa_readback_delete(&state->readback);
+  aa_metrics_delete(&state->metrics);
+  free(state->tuning_points);
+  aa_shaders_release();
+
+  // Delete the scene batch
+  aa_batch_delete(&state->scene_batch);
 }
 
 void on_resize(AppState* state)
 {
   // Resize textures and rebind to corresponding fbos
-  aa_texture_msaa_dimensions(
-      &state->msaa_color_texture_x4, state->window_width, state->window_height, 4);
-  aa_texture_msaa_dimensions(
-      &state->msaa_color_texture_x8, state->window_width, state->window_height, 8);
-  aa_texture_msaa_dimensions(
-      &state->msaa_color_texture_x16, state->window_width, state->window_height, 16);
-  aa_frame_buffer_color_texture(&state->msaa_fbo_x4, &state->msaa_color_texture_x4);
-  aa_frame_buffer_color_texture(&state->msaa_fbo_x8, &state->msaa_color_texture_x8);
-  aa_frame_buffer_color_texture(
-      &state->msaa_fbo_x16, &state->msaa_color_texture_x16);
+  aa_msaa_dimensions(state);
   aa_texture_dimensions(
       &state->fxaa_color_texture, state->window_width, state->window_height);
   aa_texture_dimensions(
@@ -293,9 +661,70 @@ void on_resize(AppState* state)
       &state->smaa_edge_texture, state->window_width, state->window_height);
   aa_texture_dimensions(
       &state->smaa_blend_texture, state->window_width, state->window_height);
+  aa_texture_dimensions(
+      &state->smaa_depth_texture, state->window_width, state->window_height);
   aa_frame_buffer_color_texture(&state->fxaa_fbo, &state->fxaa_color_texture);
   aa_frame_buffer_color_texture(&state->smaa_fbo, &state->smaa_color_texture);
+  aa_frame_buffer_depth_texture(&state->smaa_fbo, &state->smaa_depth_texture);
   aa_frame_buffer_color_texture(&state->smaa_edge_fbo, &state->smaa_edge_texture);
   aa_frame_buffer_color_texture(&state->smaa_blend_fbo, &state->smaa_blend_texture);
+  aa_texture_dimensions(
+      &state->smaa_velocity_texture, state->window_width, state->window_height);
+  aa_texture* t2x_targets[] = {
+      &state->smaa_color_texture, &state->smaa_velocity_texture};
+  aa_frame_buffer_color_textures(&state->smaa_t2x_fbo, t2x_targets, 2);
+  for (uint32_t i = 0; i < 2; i++)
+  {
+    aa_texture_dimensions(
+        &state->smaa_history_textures[i], state->window_width,
+        state->window_height);
+    aa_frame_buffer_color_texture(
+        &state->smaa_history_fbos[i], &state->smaa_history_textures[i]);
+  }
+  const bool MSAA_X2 = aa_gl_supports_samples(2);
+  if (MSAA_X2)
+  {
+    aa_texture_msaa_dimensions(
+        &state->msaa_color_texture_x2, state->window_width,
+        state->window_height, 2);
+    aa_texture_msaa_dimensions(
+        &state->msaa_velocity_texture_x2, state->window_width,
+        state->window_height, 2);
+  }
+  for (uint32_t i = 0; i < 2; i++)
+  {
+    aa_texture_dimensions(
+        &state->smaa_sample_textures[i], state->window_width,
+        state->window_height);
+  }
+  aa_texture* msaa_4x_targets[] = {
+      &state->msaa_color_texture_x2, &state->msaa_velocity_texture_x2};
+  aa_texture* separate_targets[] = {
+      &state->smaa_sample_textures[0], &state->smaa_sample_textures[1],
+      &state->smaa_velocity_texture};
+  if (MSAA_X2)
+  {
+    aa_frame_buffer_color_texture(
+        &state->msaa_fbo_x2, &state->msaa_color_texture_x2);
+    aa_frame_buffer_color_textures(&state->smaa_4x_fbo, msaa_4x_targets, 2);
+  }
+  aa_frame_buffer_color_textures(&state->smaa_separate_fbo, separate_targets, 2);
+  aa_frame_buffer_color_textures(
+      &state->smaa_separate_4x_fbo, separate_targets, 3);
+  for (uint32_t i = 0; i < 2; i++)
+  {
+    aa_texture_dimensions(
+        &state->taa_history_textures[i], state->window_width,
+        state->window_height);
+    aa_frame_buffer_color_texture(
+        &state->taa_fbos[i], &state->taa_history_textures[i]);
+  }
+  aa_taa_history_reset(state);
+  aa_ssaa_dimensions(state);
+  // On failure the CMAA2 frames are skipped until the next resize
+  aa_cmaa2_dimensions(&state->cmaa2, state->window_width, state->window_height);
+  // Reallocated by the next CPU MLAA frame
+  free(state->cpu_mlaa_pixels);
+  state->cpu_mlaa_pixels = NULL;
   aa_frame_buffer_bind(&state->default_fbo);
 }
\ No newline at end of file
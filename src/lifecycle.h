@@ -2,11 +2,24 @@
 #define __AA_HG_LIFECYCLE
 
 #include <glad/glad.h>
-#include "smaa/AreaTex.h"
-#include "smaa/SearchTex.h"
+#include <inttypes.h>
 #include "appstate.h"
+#include "embedded.h"
 #include "dartboard.h"
 #include "smaa_helper.h"
+#include "clock.h"
+#include "startup.h"
+#include "gl/extensions.h"
+#include "gl/capabilities.h"
+
+/// @brief Dimensions of `resources/smaa/AreaTex.bin` (RG8)
+#define AREATEX_WIDTH  160
+#define AREATEX_HEIGHT 560
+#define AREATEX_SIZE   (AREATEX_WIDTH * AREATEX_HEIGHT * 2)
+/// @brief Dimensions of `resources/smaa/SearchTex.bin` (R8)
+#define SEARCHTEX_WIDTH  64
+#define SEARCHTEX_HEIGHT 16
+#define SEARCHTEX_SIZE   (SEARCHTEX_WIDTH * SEARCHTEX_HEIGHT)
 
 /// @brief Initializes the application state, OpenGL resources, and scene data
 /// @details This function is responsible for:
@@ -19,6 +32,16 @@
 /// @return 0 on success, -1 if any shader compilation or resource allocation fails
 int on_init(AppState* state);
 
+/// @brief Checks if the device can run an algorithm at the window size
+/// @details Multisampled targets beyond `GL_MAX_SAMPLES` or
+///          `GL_MAX_COLOR_TEXTURE_SAMPLES`, compute shaders and SSAA targets
+///          larger than `GL_MAX_TEXTURE_SIZE` are not created by `on_init`
+///          and `on_resize`
+/// @param reason Receives what is missing (may be NULL)
+/// @return True if supported
+bool aa_algorithm_supported(
+    const AppState* state, aa_algorithm algorithm, char* reason, size_t size);
+
 /// @brief Function called when window gets resized
 void on_resize(AppState* state);
 
@@ -18,10 +18,20 @@
 #include "gl/vertex_buffer.h"
 #include "gl/frame_buffer.h"
 #include "gl/query.h"
-#include "smaa/AreaTex.h"
-#include "smaa/SearchTex.h"
+#include "gl/extensions.h"
+#include "gl/capabilities.h"
 #include "smaa_helper.h"
 #include "dartboard.h"
+#include "trace.h"
+#include "clock.h"
+#include "samples.h"
+#include "startup.h"
+#include "matrix.h"
+#include "scene.h"
+#include "quality.h"
+#include "tuner.h"
+#include "taa.h"
+#include "resolve.h"
 
 #ifdef _WIN32
 // on windows define the following symbols so that the high performance
@@ -32,31 +42,52 @@ __declspec(dllexport) int AmdPowerXpressRequestHighPerformance = 1;
 
 uint32_t AA_SAMPLE_COUNT = 100;
 
-/// @brief Function handling draw calls, based on current scene to render
-static void render_current_scene(AppState* state)
+/// @brief Moves the automation mode to the next cell of the matrix, or closes
+///        the application after the last one
+static void next_configuration(AppState* state)
 {
-  // Both scenes use the default program
-  aa_program_use(&state->program);
-
-  if (state->current_scene == SCENE_TRIANGLE)
+  // Check if we went past the last configuration
+  state->matrix_index++;
+  if (state->matrix_index == state->matrix_count)
   {
-    aa_vertex_array_bind(&state->vao);
-    aa_vertex_buffer_bind(&state->vbo);
-    glDrawArrays(GL_TRIANGLES, 0, 3);
+    printf("All algorithms and scenes finished. Closing.\n");
+    if (state->tuning_points)
+      aa_tuner_report(state);
+    glfwSetWindowShouldClose(state->window, true);
+    return;
   }
-  else if (state->current_scene == SCENE_DARTBOARD)
+
+  // Move to Next Configuration
+  SceneType previous_scene = state->current_scene;
+  aa_matrix_apply(state);
+  if (state->current_scene != previous_scene)
   {
-    dartboard_render(&state->dartboard);
+    printf(
+        "Scene `%s` finished. Switching to `%s`.\n",
+        aa_scene_name(previous_scene), aa_scene_name(state->current_scene));
   }
+
+  // Reset for the new algorithm
+  state->warmup_frames = 100;
 }
 
-/// @brief In case running in automation mode, takes care of all the sampling logic for every algorithm and scene, then closes application
+/// @brief In case running in automation mode, takes care of all the sampling logic for every cell of the matrix, then closes application
 static void run_automation_logic(AppState* state)
 {
   // Only run if automation is enabled
   if (!state->automation_mode)
     return;
 
+  // A configuration whose frames can not be rendered is dropped unsaved
+  if (state->configuration_failed)
+  {
+    printf("Skipped: %s (rendering failed)\n", state->current_algorithm_file_name);
+    state->configuration_failed = false;
+    state->is_recording         = false;
+    next_configuration(state);
+    return;
+  }
+
   // Wait 20 frames to let GPU stabilize
   if (state->warmup_frames > 0)
   {
@@ -73,45 +104,366 @@ static void run_automation_logic(AppState* state)
   // Check if Recording is Done
   if (state->is_recording && state->samples_current >= state->samples_total)
   {
+    // The capture of the last frame is scored once the GPU wrote it, a couple
+    // of (unrecorded) frames later
+    if (state->measure_quality && !aa_quality_collect(state, false))
+      return;
+
     // Stop Recording
     state->is_recording = false;
 
-    // Save Samples
-    if (state->current_algorithm_file_name)
-    {
-      FILE* file = fopen(state->current_algorithm_file_name, "w");
-      if (file)
-      {
-        for (size_t i = 0; i < state->samples_current; i++)
-          fprintf(file, "%" PRIu32 ",", state->samples[i]);
-        fclose(file);
-        printf("Saved: %s\n", state->current_algorithm_file_name);
-      }
-    }
+    // Save Samples (the tuner only keeps a summary of them)
+    if (state->tuning_points)
+      aa_tuner_record(state);
+    else
+      aa_samples_save(state);
 
-    // Move to Next Algorithm
-    state->anti_aliasing++;
+    next_configuration(state);
+  }
+}
 
-    // Reset for the new algorithm
-    state->warmup_frames = 100;
+/// @brief `subsampleIndices` of SMAA 1x
+static const float AA_SMAA_1X_SUBSAMPLE[4] = {0.0f, 0.0f, 0.0f, 0.0f};
 
-    // Check if we went past the last algorithm
-    if (state->anti_aliasing > AA_SMAA_ULTRA)
-    {
-      if (state->current_scene == SCENE_TRIANGLE)
-      {
-        printf("Triangle finished. Switching to Dartboard.\n");
-        state->current_scene = SCENE_DARTBOARD;
-        state->anti_aliasing = AA_NONE;
-        state->warmup_frames = 100;
-      }
-      else
-      {
-        printf("All algorithms and scenes finished. Closing.\n");
-        glfwSetWindowShouldClose(state->window, true);
-      }
-    }
+/// @brief Runs the three SMAA passes on a scene
+/// @param state The application state
+/// @param smaa_pipeline The passes to run
+/// @param color The scene (`smaa_color_texture`, or a sample of S2x)
+/// @param target The framebuffer receiving the anti-aliased image
+/// @param subsample_indices Selects the area texture of the subsample (T2x,
+///        S2x and 4x)
+/// @param velocity The velocity of the scene, packed into the alpha channel of
+///        `target` for a temporal resolve (NULL for SMAA 1x and S2x)
+/// @param average Blends the image with the content of `target` with a factor
+///        of 0.5 (second sample of S2x and 4x)
+static void render_smaa_passes(
+    AppState* state, aa_smaa_pipeline* smaa_pipeline, aa_texture* color,
+    aa_frame_buffer* target, const float subsample_indices[4],
+    aa_texture* velocity, bool average)
+{
+  glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+
+  // Metrics required by SMAA.hlsl
+  float w          = (float)state->window_width;
+  float h          = (float)state->window_height;
+  float metrics[4] = {1.0f / w, 1.0f / h, w, h};
+
+  // Edge Detection Pass
+  aa_trace_gpu_begin(&state->trace, "smaa edge detection");
+  aa_frame_buffer_bind(&state->smaa_edge_fbo);
+  glClear(GL_COLOR_BUFFER_BIT);
+  aa_program_use(&smaa_pipeline->edge_program);
+  aa_vertex_array_bind(&state->fullscreen_vao);
+  glActiveTexture(GL_TEXTURE0);
+  aa_texture_bind(color);
+  glUniform4fv(
+      glGetUniformLocation(smaa_pipeline->edge_program.id, "SMAA_RT_METRICS"), 1,
+      metrics);
+  glUniform1i(glGetUniformLocation(smaa_pipeline->edge_program.id, "sceneTex"), 0);
+  // Depth and predicated edge detection (custom SMAA)
+  GLint depth_location =
+      glGetUniformLocation(smaa_pipeline->edge_program.id, "depthTex");
+  if (depth_location >= 0)
+  {
+    glActiveTexture(GL_TEXTURE1);
+    aa_texture_bind(&state->smaa_depth_texture);
+    glUniform1i(depth_location, 1);
+  }
+  glDrawArrays(GL_TRIANGLES, 0, 6);
+  aa_trace_gpu_end(&state->trace);
+
+  // Blend Weight Pass
+  aa_trace_gpu_begin(&state->trace, "smaa blend weights");
+  aa_frame_buffer_bind(&state->smaa_blend_fbo);
+  glClear(GL_COLOR_BUFFER_BIT);
+  aa_program_use(&smaa_pipeline->blend_program);
+  glActiveTexture(GL_TEXTURE0);
+  aa_texture_bind(&state->smaa_edge_texture);
+  glActiveTexture(GL_TEXTURE1);
+  aa_texture_bind(&state->smaa_area_texture);
+  glActiveTexture(GL_TEXTURE2);
+  aa_texture_bind(&state->smaa_search_texture);
+  glUniform4fv(
+      glGetUniformLocation(smaa_pipeline->blend_program.id, "SMAA_RT_METRICS"), 1,
+      metrics);
+  glUniform1i(glGetUniformLocation(smaa_pipeline->blend_program.id, "edgeTex"), 0);
+  glUniform1i(glGetUniformLocation(smaa_pipeline->blend_program.id, "areaTex"), 1);
+  glUniform1i(
+      glGetUniformLocation(smaa_pipeline->blend_program.id, "searchTex"), 2);
+  glUniform4fv(
+      glGetUniformLocation(smaa_pipeline->blend_program.id, "subsampleIndices"), 1,
+      subsample_indices);
+  glDrawArrays(GL_TRIANGLES, 0, 6);
+  aa_trace_gpu_end(&state->trace);
+
+  // Neighborhood Blending Pass (To Screen, or to the history of T2x and 4x)
+  aa_trace_gpu_begin(&state->trace, "smaa neighborhood blending");
+  aa_frame_buffer_bind(target);
+  aa_program_use(&smaa_pipeline->neighborhood_program);
+  aa_vertex_array_bind(&state->fullscreen_vao);
+  glActiveTexture(GL_TEXTURE0);
+  aa_texture_bind(color);
+  glActiveTexture(GL_TEXTURE1);
+  aa_texture_bind(&state->smaa_blend_texture);
+  glUniform4fv(
+      glGetUniformLocation(
+          smaa_pipeline->neighborhood_program.id, "SMAA_RT_METRICS"),
+      1, metrics);
+  glUniform1i(
+      glGetUniformLocation(smaa_pipeline->neighborhood_program.id, "sceneTex"), 0);
+  glUniform1i(
+      glGetUniformLocation(smaa_pipeline->neighborhood_program.id, "blendTex"), 1);
+  if (velocity)
+  {
+    glActiveTexture(GL_TEXTURE2);
+    aa_texture_bind(velocity);
+    glUniform1i(
+        glGetUniformLocation(
+            smaa_pipeline->neighborhood_program.id, "velocityTex"),
+        2);
+  }
+  if (average)
+  {
+    glEnable(GL_BLEND);
+    glBlendColor(0.0f, 0.0f, 0.0f, 0.5f);
+    glBlendFunc(GL_CONSTANT_ALPHA, GL_ONE_MINUS_CONSTANT_ALPHA);
+  }
+  glDrawArrays(GL_TRIANGLES, 0, 6);
+  if (average)
+    glDisable(GL_BLEND);
+  aa_trace_gpu_end(&state->trace);
+}
+
+/// @brief Splits the samples of the MSAA x2 scene into `smaa_sample_textures`
+/// @param separate The separate pass (S2x, or 4x which also copies the velocity)
+/// @param target `smaa_separate_fbo`, or `smaa_separate_4x_fbo`
+static void render_smaa_separate(
+    AppState* state, aa_smaa_separate* separate, aa_frame_buffer* target)
+{
+  aa_trace_gpu_begin(&state->trace, "smaa separate");
+  aa_frame_buffer_bind(target);
+  aa_program_use(&separate->program);
+  aa_vertex_array_bind(&state->fullscreen_vao);
+  glActiveTexture(GL_TEXTURE0);
+  aa_texture_bind(&state->msaa_color_texture_x2);
+  glActiveTexture(GL_TEXTURE1);
+  aa_texture_bind(&state->msaa_velocity_texture_x2);
+  glUniform1i(glGetUniformLocation(separate->program.id, "colorTexMS"), 0);
+  glUniform1i(glGetUniformLocation(separate->program.id, "velocityTexMS"), 1);
+  glDrawArrays(GL_TRIANGLES, 0, 6);
+  aa_trace_gpu_end(&state->trace);
+}
+
+/// @brief Runs SMAA 1x on both separated samples, averaging them into `target`
+/// @param subsample_indices Indices of each sample
+static void render_smaa_samples(
+    AppState* state, aa_smaa_pipeline* smaa_pipeline, aa_frame_buffer* target,
+    const float subsample_indices[2][4], aa_texture* velocity)
+{
+  render_smaa_passes(
+      state, smaa_pipeline, &state->smaa_sample_textures[0], target,
+      subsample_indices[0], velocity, false);
+  render_smaa_passes(
+      state, smaa_pipeline, &state->smaa_sample_textures[1], target,
+      subsample_indices[1], velocity, true);
+}
+
+/// @brief Draws the scene jittered by `jitter` pixels (y up)
+static void render_scene_jittered(AppState* state, const float jitter[2])
+{
+  GLint location = glGetUniformLocation(state->program.id, "u_jitter");
+  aa_trace_gpu_begin(&state->trace, "scene");
+  glProgramUniform2f(
+      state->program.id, location, jitter[0] * 2.0f / state->window_width,
+      jitter[1] * 2.0f / state->window_height);
+  aa_scene_render(state);
+  glProgramUniform2f(state->program.id, location, 0.0f, 0.0f);
+  aa_trace_gpu_end(&state->trace);
+}
+
+/// @brief Blends the current subsample of the history with the previous one
+///        (T2x and 4x), to the screen
+static void render_smaa_resolve(
+    AppState* state, aa_smaa_temporal* temporal, uint32_t subsample)
+{
+  float w          = (float)state->window_width;
+  float h          = (float)state->window_height;
+  float metrics[4] = {1.0f / w, 1.0f / h, w, h};
+  aa_program* resolve = &temporal->resolve_program;
+
+  aa_trace_gpu_begin(&state->trace, "smaa temporal resolve");
+  aa_frame_buffer_bind(&state->default_fbo);
+  aa_program_use(resolve);
+  aa_vertex_array_bind(&state->fullscreen_vao);
+  glActiveTexture(GL_TEXTURE0);
+  aa_texture_bind(&state->smaa_history_textures[subsample]);
+  glActiveTexture(GL_TEXTURE1);
+  aa_texture_bind(&state->smaa_history_textures[1 - subsample]);
+  glActiveTexture(GL_TEXTURE2);
+  aa_texture_bind(&state->smaa_velocity_texture);
+  glUniform4fv(glGetUniformLocation(resolve->id, "SMAA_RT_METRICS"), 1, metrics);
+  glUniform1i(glGetUniformLocation(resolve->id, "currentColorTex"), 0);
+  glUniform1i(glGetUniformLocation(resolve->id, "previousColorTex"), 1);
+  glUniform1i(glGetUniformLocation(resolve->id, "velocityTex"), 2);
+  glDrawArrays(GL_TRIANGLES, 0, 6);
+  aa_trace_gpu_end(&state->trace);
+}
+
+/// @brief Anti-aliases `fxaa_color_texture` in place with the CMAA2 kernels
+static void render_cmaa2(AppState* state)
+{
+  aa_cmaa2* cmaa2 = &state->cmaa2;
+  glBindImageTexture(
+      AA_CMAA2_COLOR_UNIT, state->fxaa_color_texture.id, 0, GL_FALSE, 0,
+      GL_READ_WRITE, GL_RGBA8);
+  glBindImageTexture(
+      AA_CMAA2_EDGES_UNIT, cmaa2->edges_texture.id, 0, GL_FALSE, 0,
+      GL_READ_WRITE, GL_R8UI);
+  glBindImageTexture(
+      AA_CMAA2_HEADS_UNIT, cmaa2->heads_texture.id, 0, GL_FALSE, 0,
+      GL_READ_WRITE, GL_R32UI);
+  glBindBufferBase(
+      GL_SHADER_STORAGE_BUFFER, AA_CMAA2_CONTROL_BINDING, cmaa2->control);
+  glBindBufferBase(
+      GL_SHADER_STORAGE_BUFFER, AA_CMAA2_CANDIDATES_BINDING, cmaa2->candidates);
+  glBindBufferBase(
+      GL_SHADER_STORAGE_BUFFER, AA_CMAA2_LOCATIONS_BINDING, cmaa2->locations);
+  glBindBufferBase(
+      GL_SHADER_STORAGE_BUFFER, AA_CMAA2_ITEMS_BINDING, cmaa2->items);
+  glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, cmaa2->control);
+
+  // Edge detection, one thread per pixel
+  aa_trace_gpu_begin(&state->trace, "cmaa2 edges");
+  aa_program_use(&cmaa2->edges_program);
+  glUniform1f(
+      glGetUniformLocation(cmaa2->edges_program.id, "threshold"),
+      AA_CMAA2_THRESHOLD);
+  glDispatchCompute(
+      (GLuint)(state->window_width + 15) / 16,
+      (GLuint)(state->window_height + 15) / 16, 1);
+  glMemoryBarrier(
+      GL_SHADER_STORAGE_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+  aa_trace_gpu_end(&state->trace);
+
+  // Shapes, one thread per candidate
+  aa_trace_gpu_begin(&state->trace, "cmaa2 process");
+  aa_program_use(&cmaa2->args_program);
+  glUniform1i(
+      glGetUniformLocation(cmaa2->args_program.id, "locationStage"), GL_FALSE);
+  glDispatchCompute(1, 1, 1);
+  glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+  aa_program_use(&cmaa2->process_program);
+  glUniform1ui(
+      glGetUniformLocation(cmaa2->process_program.id, "itemCapacity"),
+      cmaa2->item_capacity);
+  glDispatchComputeIndirect(AA_CMAA2_CANDIDATE_ARGS);
+  glMemoryBarrier(
+      GL_SHADER_STORAGE_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+  aa_trace_gpu_end(&state->trace);
+
+  // Blends, one thread per pixel touched
+  aa_trace_gpu_begin(&state->trace, "cmaa2 apply");
+  aa_program_use(&cmaa2->args_program);
+  glUniform1i(
+      glGetUniformLocation(cmaa2->args_program.id, "locationStage"), GL_TRUE);
+  glDispatchCompute(1, 1, 1);
+  glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+  aa_program_use(&cmaa2->apply_program);
+  glDispatchComputeIndirect(AA_CMAA2_LOCATION_ARGS);
+  glMemoryBarrier(
+      GL_FRAMEBUFFER_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT
+      | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+  aa_trace_gpu_end(&state->trace);
+  glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+}
+
+/// @brief Draws a full-screen MLAA pass reading `input` (and `weights`) into
+///        `target`
+static void render_mlaa_pass(
+    AppState* state, const char* name, aa_program* program,
+    aa_frame_buffer* target, aa_texture* input, aa_texture* weights)
+{
+  aa_trace_gpu_begin(&state->trace, name);
+  aa_frame_buffer_bind(target);
+  aa_program_use(program);
+  aa_vertex_array_bind(&state->fullscreen_vao);
+  glActiveTexture(GL_TEXTURE0);
+  aa_texture_bind(input);
+  if (weights != NULL)
+  {
+    glActiveTexture(GL_TEXTURE1);
+    aa_texture_bind(weights);
+    glUniform1i(glGetUniformLocation(program->id, "weightsTex"), 1);
   }
+  glUniform1i(glGetUniformLocation(program->id, "colorTex"), 0);
+  glUniform1i(glGetUniformLocation(program->id, "edgesTex"), 0);
+  glUniform1f(glGetUniformLocation(program->id, "threshold"), AA_MLAA_THRESHOLD);
+  glDrawArrays(GL_TRIANGLES, 0, 6);
+  aa_trace_gpu_end(&state->trace);
+}
+
+/// @brief Draws the scene into an SSAA target and downsamples it to the
+///        screen, along the rows then the columns
+/// @param index 0 for SSAA 2x, 1 for SSAA 4x
+static void render_ssaa(AppState* state, uint32_t index)
+{
+  const int SCALE  = AA_SSAA_SCALE(index);
+  const int WIDTH  = state->window_width;
+  const int HEIGHT = state->window_height;
+  aa_frame_buffer_bind(&state->ssaa_fbos[index]);
+  glViewport(0, 0, WIDTH * SCALE, HEIGHT * SCALE);
+  glClear(GL_COLOR_BUFFER_BIT);
+  aa_trace_gpu_begin(&state->trace, "scene");
+  aa_scene_render(state);
+  aa_trace_gpu_end(&state->trace);
+
+  aa_trace_gpu_begin(&state->trace, "ssaa downsample");
+  aa_program_use(&state->ssaa_program);
+  aa_vertex_array_bind(&state->fullscreen_vao);
+  glActiveTexture(GL_TEXTURE0);
+  glUniform1i(glGetUniformLocation(state->ssaa_program.id, "sourceTex"), 0);
+  glUniform1i(glGetUniformLocation(state->ssaa_program.id, "factor"), SCALE);
+  aa_frame_buffer_bind(&state->ssaa_row_fbos[index]);
+  glViewport(0, 0, WIDTH, HEIGHT * SCALE);
+  aa_texture_bind(&state->ssaa_color_textures[index]);
+  glUniform2i(glGetUniformLocation(state->ssaa_program.id, "axis"), 1, 0);
+  glDrawArrays(GL_TRIANGLES, 0, 6);
+  aa_frame_buffer_bind(&state->default_fbo);
+  glViewport(0, 0, WIDTH, HEIGHT);
+  aa_texture_bind(&state->ssaa_row_textures[index]);
+  glUniform2i(glGetUniformLocation(state->ssaa_program.id, "axis"), 0, 1);
+  glDrawArrays(GL_TRIANGLES, 0, 6);
+  aa_trace_gpu_end(&state->trace);
+}
+
+/// @brief Resolves the bound multisampled frame buffer into the screen with
+///        `fragment_msaa_resolve.glsl` and the filter of the state
+/// @param texture The colour of the frame buffer
+/// @param table The sample positions of the frame buffer, and their weights
+static void render_msaa_resolve(
+    AppState* state, aa_texture* texture, aa_resolve_table* table)
+{
+  const aa_resolve_parameters* resolve = &state->resolve_parameters;
+  aa_program* program                  = &state->resolve_program;
+  // Only computed when the filter changes
+  aa_resolve_table_filter(table, resolve->filter);
+  int side = 2 * table->reach + 1;
+
+  aa_trace_gpu_begin(&state->trace, "msaa shader resolve");
+  aa_frame_buffer_bind(&state->default_fbo);
+  aa_program_use(program);
+  aa_vertex_array_bind(&state->fullscreen_vao);
+  glActiveTexture(GL_TEXTURE0);
+  aa_texture_bind(texture);
+  glUniform1i(glGetUniformLocation(program->id, "colorTex"), 0);
+  glUniform1i(glGetUniformLocation(program->id, "samples"), table->samples);
+  glUniform1i(glGetUniformLocation(program->id, "reach"), table->reach);
+  glUniform1fv(
+      glGetUniformLocation(program->id, "weights"),
+      side * side * table->samples, table->weights);
+  glUniform1i(glGetUniformLocation(program->id, "tonemap"), resolve->tonemap);
+  glDrawArrays(GL_TRIANGLES, 0, 6);
+  aa_trace_gpu_end(&state->trace);
 }
 
 /// @brief Executes the rendering logic for a single frame
@@ -120,12 +472,20 @@ static void run_automation_logic(AppState* state)
 ///          - Renders the ImGui control interface (in manual mode)
 ///          - Executes the selected Anti-Aliasing pipeline
 ///          - Measures GPU execution time using time queries
+///          - Measures the CPU time spent submitting the pipeline's commands
 ///          - Records samples
 static void on_frame(AppState* state)
 {
+  aa_trace_cpu_begin(&state->trace, "run_automation_logic");
   run_automation_logic(state);
+  aa_trace_cpu_end(&state->trace);
   if (glfwWindowShouldClose(state->window))
     return;
+  // Spinning scenes are posed by the frame number
+  state->scene_frame = state->frame_count;
+  // Manual recordings are scored as soon as their capture is available
+  if (state->measure_quality && !state->automation_mode)
+    aa_quality_collect(state, false);
   // Ensure ImGui render state doesn't interfere with full-screen rendering
   glDisable(GL_SCISSOR_TEST);
   glDisable(GL_STENCIL_TEST);
@@ -133,27 +493,59 @@ static void on_frame(AppState* state)
   glDisable(GL_CULL_FACE);
   glDisable(GL_BLEND);
   glViewport(0, 0, state->window_width, state->window_height);
-  glClearColor(
-      fabsf(sinf((float)state->elapsed_time * 1.4f)),
-      fabsf(sinf((float)state->elapsed_time * 1.1f)),
-      fabsf(sinf((float)state->elapsed_time * 0.8f)), 1.0);
+  if (state->measure_quality)
+  {
+    // The reference is drawn on the same constant background
+    glClearColor(
+        AA_SCENE_BACKGROUND_R, AA_SCENE_BACKGROUND_G, AA_SCENE_BACKGROUND_B, 1.0);
+  }
+  else
+  {
+    glClearColor(
+        fabsf(sinf((float)state->elapsed_time * 1.4f)),
+        fabsf(sinf((float)state->elapsed_time * 1.1f)),
+        fabsf(sinf((float)state->elapsed_time * 0.8f)), 1.0);
+  }
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-  if (!state->automation_mode)
+  // In isolated mode the control panel is hidden while recording, so that
+  // building it does not perturb the measured pipeline
+  bool ui_hidden = state->isolate_measurements && state->is_recording;
+  if (!state->automation_mode && !state->headless && !ui_hidden)
   {
     // Setting up the UI control window (only in manual mode)
+    aa_trace_cpu_begin(&state->trace, "aa_ui_render");
     aa_ui_render(state);
+    aa_trace_cpu_end(&state->trace);
   }
 
+  // Result files are named after the algorithm and the scene, with the
+  // parameters of tunable algorithms and scalable scenes
+  aa_matrix_cell cell;
+  cell.algorithm        = state->anti_aliasing;
+  cell.scene            = state->current_scene;
+  cell.scene_parameters = state->scene_parameters;
+  cell.smaa             = state->smaa_parameters;
+  cell.fxaa             = state->fxaa_parameters;
+  cell.resolve          = state->resolve_parameters;
+  aa_matrix_cell_file_name(
+      &cell, state->custom_file_name, sizeof(state->custom_file_name));
+  state->current_algorithm_file_name = state->custom_file_name;
+
+  // CPU submit cost: everything from here to the end of the GPU query (the UI
+  // work above is excluded, the blocking query readback below as well)
+  uint64_t submit_begin_ns = aa_clock_ns();
+  // Set by a pass that failed: the frame is neither presented nor recorded
+  bool frame_skipped = false;
+
   // Rendering Pipelines (Varying depending on chosen AA algorithm)
   if (state->anti_aliasing == AA_NONE)
   {
     aa_time_query_begin(&state->query);
-    render_current_scene(state);
+    aa_trace_gpu_begin(&state->trace, "scene");
+    aa_scene_render(state);
+    aa_trace_gpu_end(&state->trace);
     aa_time_query_end(&state->query);
-    state->current_algorithm_file_name = (state->current_scene == SCENE_TRIANGLE)
-                                             ? "aa_NONE.txt"
-                                             : "aa_NONE_dartboard.txt";
   }
 
   if (state->anti_aliasing == AA_MSAAx4)
@@ -161,17 +553,17 @@ static void on_frame(AppState* state)
     aa_time_query_begin(&state->query);
     aa_frame_buffer_bind(&state->msaa_fbo_x4);
     glClear(GL_COLOR_BUFFER_BIT);
-    render_current_scene(state);
+    aa_trace_gpu_begin(&state->trace, "scene");
+    aa_scene_render(state);
+    aa_trace_gpu_end(&state->trace);
     // Blitting MSAA fbo to default fbo to render on screen
+    aa_trace_gpu_begin(&state->trace, "msaa resolve");
     aa_frame_buffer_blit(
         &state->default_fbo, &state->msaa_fbo_x4, state->window_width,
         state->window_height);
+    aa_trace_gpu_end(&state->trace);
     aa_frame_buffer_bind(&state->default_fbo);
     aa_time_query_end(&state->query);
-
-    state->current_algorithm_file_name = (state->current_scene == SCENE_TRIANGLE)
-                                             ? "aa_MSAAx4.txt"
-                                             : "aa_MSAAx4_dartboard.txt";
   }
 
   if (state->anti_aliasing == AA_MSAAx8)
@@ -180,17 +572,17 @@ static void on_frame(AppState* state)
     // Bind MSAA framebuffer
     aa_frame_buffer_bind(&state->msaa_fbo_x8);
     glClear(GL_COLOR_BUFFER_BIT);
-    render_current_scene(state);
+    aa_trace_gpu_begin(&state->trace, "scene");
+    aa_scene_render(state);
+    aa_trace_gpu_end(&state->trace);
     // Blit MSAA FBO to default framebuffer
+    aa_trace_gpu_begin(&state->trace, "msaa resolve");
     aa_frame_buffer_blit(
         &state->default_fbo, &state->msaa_fbo_x8, state->window_width,
         state->window_height);
+    aa_trace_gpu_end(&state->trace);
     aa_frame_buffer_bind(&state->default_fbo);
     aa_time_query_end(&state->query);
-
-    state->current_algorithm_file_name = (state->current_scene == SCENE_TRIANGLE)
-                                             ? "aa_MSAAx8.txt"
-                                             : "aa_MSAAx8_dartboard.txt";
   }
 
   if (state->anti_aliasing == AA_MSAAx16)
@@ -198,17 +590,17 @@ static void on_frame(AppState* state)
     aa_time_query_begin(&state->query);
     aa_frame_buffer_bind(&state->msaa_fbo_x16);
     glClear(GL_COLOR_BUFFER_BIT);
-    render_current_scene(state);
+    aa_trace_gpu_begin(&state->trace, "scene");
+    aa_scene_render(state);
+    aa_trace_gpu_end(&state->trace);
     // Blit MSAA FBO to default framebuffer
+    aa_trace_gpu_begin(&state->trace, "msaa resolve");
     aa_frame_buffer_blit(
         &state->default_fbo, &state->msaa_fbo_x16, state->window_width,
         state->window_height);
+    aa_trace_gpu_end(&state->trace);
     aa_frame_buffer_bind(&state->default_fbo);
     aa_time_query_end(&state->query);
-
-    state->current_algorithm_file_name = (state->current_scene == SCENE_TRIANGLE)
-                                             ? "aa_MSAAx16.txt"
-                                             : "aa_MSAAx16_dartboard.txt";
   }
 
   if (state->anti_aliasing == AA_FXAA)
@@ -217,8 +609,11 @@ static void on_frame(AppState* state)
     // Bind FXAA framebuffer
     aa_frame_buffer_bind(&state->fxaa_fbo);
     glClear(GL_COLOR_BUFFER_BIT);
-    render_current_scene(state);
+    aa_trace_gpu_begin(&state->trace, "scene");
+    aa_scene_render(state);
+    aa_trace_gpu_end(&state->trace);
     // Post processing effects
+    aa_trace_gpu_begin(&state->trace, "fxaa");
     aa_frame_buffer_bind(&state->default_fbo);
     aa_program_use(&state->fxaa_program);
     aa_vertex_array_bind(&state->fullscreen_vao);
@@ -231,71 +626,98 @@ static void on_frame(AppState* state)
         glGetUniformLocation(state->fxaa_program.id, "resolution"),
         (float)state->window_width, (float)state->window_height);
     glDrawArrays(GL_TRIANGLES, 0, 6);
+    aa_trace_gpu_end(&state->trace);
     aa_time_query_end(&state->query);
-
-    state->current_algorithm_file_name = (state->current_scene == SCENE_TRIANGLE)
-                                             ? "aa_FXAA.txt"
-                                             : "aa_FXAA_dartboard.txt";
   }
 
   if (state->anti_aliasing == AA_FXAA_ITERATIVE)
   {
-    aa_time_query_begin(&state->query);
-    aa_frame_buffer_bind(&state->fxaa_fbo);
-    glClear(GL_COLOR_BUFFER_BIT);
-    render_current_scene(state);
-    // Post processing effects
-    aa_frame_buffer_bind(&state->default_fbo);
-    aa_program_use(&state->fxaa_iterative_program);
-    aa_vertex_array_bind(&state->fullscreen_vao);
-    glActiveTexture(GL_TEXTURE0);
-    aa_texture_bind(&state->fxaa_color_texture);
-
-    glUniform1i(
-        glGetUniformLocation(state->fxaa_iterative_program.id, "screenTexture"), 0);
-    glUniform2f(
-        glGetUniformLocation(state->fxaa_iterative_program.id, "resolution"),
-        (float)state->window_width, (float)state->window_height);
+    // Compiles the variant of the preset on first use
+    const aa_fxaa_parameters* fxaa = &state->fxaa_parameters;
+    aa_program* program = aa_fxaa_iterative_get(&state->fxaa_iterative, fxaa);
+    if (program)
+    {
+      aa_time_query_begin(&state->query);
+      aa_frame_buffer_bind(&state->fxaa_fbo);
+      if (fxaa->luma_alpha)
+      {
+        // The background gets its luma too
+        float clear[4];
+        glGetFloatv(GL_COLOR_CLEAR_VALUE, clear);
+        clear[3] = 0.299f * clear[0] + 0.587f * clear[1] + 0.114f * clear[2];
+        glClearBufferfv(GL_COLOR, 0, clear);
+        glProgramUniform1i(
+            state->program.id,
+            glGetUniformLocation(state->program.id, "u_luma_alpha"), 1);
+      }
+      else
+      {
+        glClear(GL_COLOR_BUFFER_BIT);
+      }
+      aa_trace_gpu_begin(&state->trace, "scene");
+      aa_scene_render(state);
+      aa_trace_gpu_end(&state->trace);
+      if (fxaa->luma_alpha)
+      {
+        glProgramUniform1i(
+            state->program.id,
+            glGetUniformLocation(state->program.id, "u_luma_alpha"), 0);
+      }
+      // Post processing effects
+      aa_trace_gpu_begin(&state->trace, "fxaa iterative");
+      aa_frame_buffer_bind(&state->default_fbo);
+      aa_program_use(program);
+      aa_vertex_array_bind(&state->fullscreen_vao);
+      glActiveTexture(GL_TEXTURE0);
+      aa_texture_bind(&state->fxaa_color_texture);
 
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    aa_time_query_end(&state->query);
+      glUniform1i(glGetUniformLocation(program->id, "screenTexture"), 0);
+      glUniform2f(
+          glGetUniformLocation(program->id, "resolution"),
+          (float)state->window_width, (float)state->window_height);
+      glUniform1f(
+          glGetUniformLocation(program->id, "fxaaQualitySubpix"), fxaa->subpix);
+      glUniform1f(
+          glGetUniformLocation(program->id, "fxaaQualityEdgeThreshold"),
+          fxaa->edge_threshold);
+      glUniform1f(
+          glGetUniformLocation(program->id, "fxaaQualityEdgeThresholdMin"),
+          fxaa->edge_threshold_min);
 
-    state->current_algorithm_file_name = (state->current_scene == SCENE_TRIANGLE)
-                                             ? "aa_FXAA_Iterative.txt"
-                                             : "aa_FXAA_Iterative_dartboard.txt";
+      glDrawArrays(GL_TRIANGLES, 0, 6);
+      aa_trace_gpu_end(&state->trace);
+      aa_time_query_end(&state->query);
+    }
+    else
+    {
+      frame_skipped = true;
+    }
   }
 
   // Check if current mode is any of the SMAA modes
-  if (state->anti_aliasing >= AA_SMAA_LOW && state->anti_aliasing <= AA_SMAA_ULTRA)
+  if (state->anti_aliasing >= AA_SMAA_LOW && state->anti_aliasing <= AA_SMAA_CUSTOM)
   {
     aa_smaa_pipeline* smaa_pipeline = NULL;
 
-    // Select the correct SMAA pipeline struct and log filename
+    // Select the correct SMAA pipeline struct
     switch (state->anti_aliasing)
     {
     case AA_SMAA_LOW:
-      smaa_pipeline                      = &state->smaa_low;
-      state->current_algorithm_file_name = (state->current_scene == SCENE_TRIANGLE)
-                                               ? "aa_SMAA_Low.txt"
-                                               : "aa_SMAA_Low_dartboard.txt";
+      smaa_pipeline = &state->smaa_low;
       break;
     case AA_SMAA_MEDIUM:
-      smaa_pipeline                      = &state->smaa_medium;
-      state->current_algorithm_file_name = (state->current_scene == SCENE_TRIANGLE)
-                                               ? "aa_SMAA_Medium.txt"
-                                               : "aa_SMAA_Medium_dartboard.txt";
+      smaa_pipeline = &state->smaa_medium;
       break;
     case AA_SMAA_HIGH:
-      smaa_pipeline                      = &state->smaa_high;
-      state->current_algorithm_file_name = (state->current_scene == SCENE_TRIANGLE)
-                                               ? "aa_SMAA_High.txt"
-                                               : "aa_SMAA_High_dartboard.txt";
+      smaa_pipeline = &state->smaa_high;
       break;
     case AA_SMAA_ULTRA:
-      smaa_pipeline                      = &state->smaa_ultra;
-      state->current_algorithm_file_name = (state->current_scene == SCENE_TRIANGLE)
-                                               ? "aa_SMAA_Ultra.txt"
-                                               : "aa_SMAA_Ultra_dartboard.txt";
+      smaa_pipeline = &state->smaa_ultra;
+      break;
+    case AA_SMAA_CUSTOM:
+      // Uploads the parameters (and compiles the variant on first use)
+      smaa_pipeline =
+          aa_smaa_custom_get(&state->smaa_custom, &state->smaa_parameters);
       break;
     default:
       break;
@@ -303,95 +725,369 @@ static void on_frame(AppState* state)
 
     if (smaa_pipeline)
     {
+      // Only the edge detection modes reading the depth pay for writing it
+      const bool DEPTH =
+          state->anti_aliasing == AA_SMAA_CUSTOM
+          && aa_smaa_edge_mode_depth(state->smaa_parameters.edge_mode);
       aa_time_query_begin(&state->query);
       aa_frame_buffer_bind(&state->smaa_fbo);
-      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-      render_current_scene(state);
-      glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-
-      // Metrics required by SMAA.hlsl
-      float w          = (float)state->window_width;
-      float h          = (float)state->window_height;
-      float metrics[4] = {1.0f / w, 1.0f / h, w, h};
-
-      // Edge Detection Pass
-      aa_frame_buffer_bind(&state->smaa_edge_fbo);
-      glClear(GL_COLOR_BUFFER_BIT);
-      aa_program_use(&smaa_pipeline->edge_program);
-      aa_vertex_array_bind(&state->fullscreen_vao);
-      glActiveTexture(GL_TEXTURE0);
-      aa_texture_bind(&state->smaa_color_texture);
-      glUniform4fv(
-          glGetUniformLocation(smaa_pipeline->edge_program.id, "SMAA_RT_METRICS"), 1,
-          metrics);
-      glUniform1i(
-          glGetUniformLocation(smaa_pipeline->edge_program.id, "sceneTex"), 0);
-      glDrawArrays(GL_TRIANGLES, 0, 6);
+      if (DEPTH)
+      {
+        // Every fragment is written, as without the depth test
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_ALWAYS);
+      }
+      else
+      {
+        glClear(GL_COLOR_BUFFER_BIT);
+      }
+      aa_trace_gpu_begin(&state->trace, "scene");
+      aa_scene_render(state);
+      aa_trace_gpu_end(&state->trace);
+      if (DEPTH)
+      {
+        glDepthFunc(GL_LESS);
+        glDisable(GL_DEPTH_TEST);
+      }
+      render_smaa_passes(
+          state, smaa_pipeline, &state->smaa_color_texture, &state->default_fbo,
+          AA_SMAA_1X_SUBSAMPLE, NULL, false);
+      aa_time_query_end(&state->query);
+    }
+    else
+    {
+      // A custom variant that failed to compile
+      frame_skipped = true;
+    }
+  }
 
-      // Blend Weight Pass
-      aa_frame_buffer_bind(&state->smaa_blend_fbo);
-      glClear(GL_COLOR_BUFFER_BIT);
-      aa_program_use(&smaa_pipeline->blend_program);
-      glActiveTexture(GL_TEXTURE0);
-      aa_texture_bind(&state->smaa_edge_texture);
-      glActiveTexture(GL_TEXTURE1);
-      aa_texture_bind(&state->smaa_area_texture);
-      glActiveTexture(GL_TEXTURE2);
-      aa_texture_bind(&state->smaa_search_texture);
-      glUniform4fv(
-          glGetUniformLocation(smaa_pipeline->blend_program.id, "SMAA_RT_METRICS"),
-          1, metrics);
-      glUniform1i(
-          glGetUniformLocation(smaa_pipeline->blend_program.id, "edgeTex"), 0);
-      glUniform1i(
-          glGetUniformLocation(smaa_pipeline->blend_program.id, "areaTex"), 1);
-      glUniform1i(
-          glGetUniformLocation(smaa_pipeline->blend_program.id, "searchTex"), 2);
-      glDrawArrays(GL_TRIANGLES, 0, 6);
+  // SMAA T2x: the scene is jittered by a quarter of a pixel in alternate
+  // directions, anti-aliased with SMAA 1x into the history, and blended with
+  // the previous subsample where the velocities agree
+  if (state->anti_aliasing == AA_SMAA_T2X)
+  {
+    static const float ZERO_VELOCITY[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    aa_smaa_temporal* t2x               = &state->smaa_t2x;
+    const uint32_t SUBSAMPLE            = (uint32_t)(state->frame_count & 1);
 
-      // Neighborhood Blending Pass (To Screen)
-      aa_frame_buffer_bind(&state->default_fbo);
-      aa_program_use(&smaa_pipeline->neighborhood_program);
-      aa_vertex_array_bind(&state->fullscreen_vao);
-      glActiveTexture(GL_TEXTURE0);
-      aa_texture_bind(&state->smaa_color_texture);
-      glActiveTexture(GL_TEXTURE1);
-      aa_texture_bind(&state->smaa_blend_texture);
-      glUniform4fv(
-          glGetUniformLocation(
-              smaa_pipeline->neighborhood_program.id, "SMAA_RT_METRICS"),
-          1, metrics);
-      glUniform1i(
-          glGetUniformLocation(smaa_pipeline->neighborhood_program.id, "sceneTex"),
-          0);
-      glUniform1i(
-          glGetUniformLocation(smaa_pipeline->neighborhood_program.id, "blendTex"),
-          1);
-      glDrawArrays(GL_TRIANGLES, 0, 6);
+    aa_time_query_begin(&state->query);
+    aa_frame_buffer_bind(&state->smaa_t2x_fbo);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glClearBufferfv(GL_COLOR, 1, ZERO_VELOCITY);
+    render_scene_jittered(state, AA_SMAA_T2X_JITTER[SUBSAMPLE]);
+    render_smaa_passes(
+        state, &t2x->pipeline, &state->smaa_color_texture,
+        &state->smaa_history_fbos[SUBSAMPLE],
+        AA_SMAA_T2X_SUBSAMPLE_INDICES[SUBSAMPLE], &state->smaa_velocity_texture,
+        false);
+    render_smaa_resolve(state, t2x, SUBSAMPLE);
+    aa_time_query_end(&state->query);
+  }
+
+  // SMAA S2x: the scene is drawn with MSAA x2, and SMAA 1x runs on each of its
+  // samples with the area texture of its position
+  if (state->anti_aliasing == AA_SMAA_S2X)
+  {
+    aa_time_query_begin(&state->query);
+    aa_frame_buffer_bind(&state->msaa_fbo_x2);
+    glClear(GL_COLOR_BUFFER_BIT);
+    render_scene_jittered(state, state->smaa_s2x_centre);
+    render_smaa_separate(state, &state->smaa_separate, &state->smaa_separate_fbo);
+    render_smaa_samples(
+        state, &state->smaa_high, &state->default_fbo, state->smaa_s2x_indices,
+        NULL);
+    aa_time_query_end(&state->query);
+  }
+
+  // SMAA 4x: S2x on frames jittered by an eighth of a pixel in alternate
+  // directions, into the history, followed by the resolve of T2x
+  if (state->anti_aliasing == AA_SMAA_4X)
+  {
+    static const float ZERO_VELOCITY[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    aa_smaa_temporal* smaa_4x           = &state->smaa_4x;
+    const uint32_t FRAME                = (uint32_t)(state->frame_count & 1);
+    const float JITTER[2]               = {
+        AA_SMAA_4X_JITTER[FRAME][0] + state->smaa_s2x_centre[0],
+        AA_SMAA_4X_JITTER[FRAME][1] + state->smaa_s2x_centre[1]};
+
+    aa_time_query_begin(&state->query);
+    aa_frame_buffer_bind(&state->smaa_4x_fbo);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glClearBufferfv(GL_COLOR, 1, ZERO_VELOCITY);
+    render_scene_jittered(state, JITTER);
+    render_smaa_separate(
+        state, &state->smaa_separate_4x, &state->smaa_separate_4x_fbo);
+    render_smaa_samples(
+        state, &smaa_4x->pipeline, &state->smaa_history_fbos[FRAME],
+        state->smaa_4x_indices[FRAME], &state->smaa_velocity_texture);
+    render_smaa_resolve(state, smaa_4x, FRAME);
+    aa_time_query_end(&state->query);
+  }
+
+  // TAA: the scene is jittered along the Halton sequence, and blended into the
+  // history reprojected from the previous frame
+  if (state->anti_aliasing == AA_TAA)
+  {
+    static const float ZERO_VELOCITY[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    const uint32_t CURRENT              = (uint32_t)(state->frame_count & 1);
+    aa_program* taa                     = &state->taa_program;
+    // A stale history (first TAA frame, after a resize or after another
+    // algorithm) is replaced by the current frame instead of blended in
+    const bool SEED = !state->taa_history_valid
+                      || state->taa_history_frame + 1 != state->frame_count;
+    float jitter[2];
+    aa_taa_jitter(state->frame_count, jitter);
+
+    aa_time_query_begin(&state->query);
+    aa_frame_buffer_bind(&state->smaa_t2x_fbo);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glClearBufferfv(GL_COLOR, 1, ZERO_VELOCITY);
+    render_scene_jittered(state, jitter);
+
+    // Resolve Pass (into the history)
+    aa_trace_gpu_begin(&state->trace, "taa resolve");
+    aa_frame_buffer_bind(&state->taa_fbos[CURRENT]);
+    aa_program_use(taa);
+    aa_vertex_array_bind(&state->fullscreen_vao);
+    glActiveTexture(GL_TEXTURE0);
+    aa_texture_bind(&state->smaa_color_texture);
+    glActiveTexture(GL_TEXTURE1);
+    aa_texture_bind(&state->taa_history_textures[1 - CURRENT]);
+    glActiveTexture(GL_TEXTURE2);
+    aa_texture_bind(&state->smaa_velocity_texture);
+    glUniform1i(glGetUniformLocation(taa->id, "currentTex"), 0);
+    glUniform1i(glGetUniformLocation(taa->id, "historyTex"), 1);
+    glUniform1i(glGetUniformLocation(taa->id, "velocityTex"), 2);
+    glUniform1f(
+        glGetUniformLocation(taa->id, "feedback"),
+        SEED ? 1.0f : AA_TAA_FEEDBACK);
+    glUniform1f(
+        glGetUniformLocation(taa->id, "varianceGamma"), AA_TAA_VARIANCE_GAMMA);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    aa_trace_gpu_end(&state->trace);
+    state->taa_history_valid = true;
+    state->taa_history_frame = state->frame_count;
+
+    // The history is kept in high precision, the screen gets a copy
+    aa_trace_gpu_begin(&state->trace, "taa present");
+    aa_frame_buffer_blit(
+        &state->default_fbo, &state->taa_fbos[CURRENT], state->window_width,
+        state->window_height);
+    aa_trace_gpu_end(&state->trace);
+    aa_frame_buffer_bind(&state->default_fbo);
+    aa_time_query_end(&state->query);
+  }
+
+  // CMAA2: the scene is anti-aliased in place by compute kernels, and copied
+  // to the screen (skipped while its lists could not be allocated)
+  if (state->anti_aliasing == AA_CMAA2 && !state->cmaa2.sized)
+  {
+    frame_skipped = true;
+  }
+  else if (state->anti_aliasing == AA_CMAA2)
+  {
+    aa_time_query_begin(&state->query);
+    aa_frame_buffer_bind(&state->fxaa_fbo);
+    glClear(GL_COLOR_BUFFER_BIT);
+    aa_trace_gpu_begin(&state->trace, "scene");
+    aa_scene_render(state);
+    aa_trace_gpu_end(&state->trace);
+    render_cmaa2(state);
+    aa_trace_gpu_begin(&state->trace, "cmaa2 present");
+    aa_frame_buffer_blit(
+        &state->default_fbo, &state->fxaa_fbo, state->window_width,
+        state->window_height);
+    aa_trace_gpu_end(&state->trace);
+    aa_frame_buffer_bind(&state->default_fbo);
+    aa_time_query_end(&state->query);
+  }
+
+  // MLAA: edges, blending weights searched and measured per pixel, blending
+  if (state->anti_aliasing == AA_MLAA)
+  {
+    aa_time_query_begin(&state->query);
+    aa_frame_buffer_bind(&state->smaa_fbo);
+    glClear(GL_COLOR_BUFFER_BIT);
+    aa_trace_gpu_begin(&state->trace, "scene");
+    aa_scene_render(state);
+    aa_trace_gpu_end(&state->trace);
+    render_mlaa_pass(
+        state, "mlaa edges", &state->mlaa_edge_program, &state->smaa_edge_fbo,
+        &state->smaa_color_texture, NULL);
+    render_mlaa_pass(
+        state, "mlaa weights", &state->mlaa_weight_program,
+        &state->smaa_blend_fbo, &state->smaa_edge_texture, NULL);
+    render_mlaa_pass(
+        state, "mlaa blend", &state->mlaa_blend_program, &state->default_fbo,
+        &state->smaa_color_texture, &state->smaa_blend_texture);
+    aa_time_query_end(&state->query);
+  }
+
+  // CPU MLAA: the frame is read back, anti-aliased on the CPU and uploaded
+  // again, all inside the measured window (the GPU waits meanwhile)
+  if (state->anti_aliasing == AA_MLAA_CPU)
+  {
+    size_t frame_bytes = (size_t)state->window_width * state->window_height * 4;
+    if (!state->cpu_mlaa.initialized
+        && aa_cpu_mlaa_init(&state->cpu_mlaa, 0) != 0)
+    {
+      printf("Error: Could not start the CPU MLAA thread pool\n");
+      frame_skipped = true;
+    }
+    if (state->cpu_mlaa_pixels == NULL)
+      state->cpu_mlaa_pixels = malloc(frame_bytes * 2);
+    if (state->cpu_mlaa_pixels == NULL)
+    {
+      printf("Error: Could not allocate the CPU MLAA frames\n");
+      frame_skipped = true;
+    }
+  }
+  if (state->anti_aliasing == AA_MLAA_CPU && !frame_skipped)
+  {
+    size_t frame_bytes = (size_t)state->window_width * state->window_height * 4;
+    uint8_t* frame     = state->cpu_mlaa_pixels;
+    uint8_t* result    = frame + frame_bytes;
+
+    aa_time_query_begin(&state->query);
+    aa_frame_buffer_bind(&state->fxaa_fbo);
+    glClear(GL_COLOR_BUFFER_BIT);
+    aa_trace_gpu_begin(&state->trace, "scene");
+    aa_scene_render(state);
+    aa_trace_gpu_end(&state->trace);
+    aa_trace_cpu_begin(&state->trace, "mlaa readback");
+    glReadPixels(
+        0, 0, state->window_width, state->window_height, GL_RGBA,
+        GL_UNSIGNED_BYTE, frame);
+    aa_trace_cpu_end(&state->trace);
+    aa_trace_cpu_begin(&state->trace, "mlaa cpu");
+    int applied = aa_cpu_mlaa_apply(
+        &state->cpu_mlaa, frame, result, state->window_width,
+        state->window_height);
+    aa_trace_cpu_end(&state->trace);
+    if (applied != 0)
+    {
+      printf("Error: Could not allocate the CPU MLAA buffers\n");
+      frame_skipped = true;
+    }
+    else
+    {
+      aa_texture_bind(&state->fxaa_color_texture);
+      glTexSubImage2D(
+          GL_TEXTURE_2D, 0, 0, 0, state->window_width, state->window_height,
+          GL_RGBA, GL_UNSIGNED_BYTE, result);
+      aa_trace_gpu_begin(&state->trace, "mlaa present");
+      aa_frame_buffer_blit(
+          &state->default_fbo, &state->fxaa_fbo, state->window_width,
+          state->window_height);
+      aa_trace_gpu_end(&state->trace);
+    }
+    aa_frame_buffer_bind(&state->default_fbo);
+    aa_time_query_end(&state->query);
+  }
 
+  // The SSAA targets are only sized when they fit (see `on_resize`), the
+  // frames are skipped while the window is too large
+  if (state->anti_aliasing == AA_SSAA_2X || state->anti_aliasing == AA_SSAA_4X)
+  {
+    if (aa_algorithm_supported(state, state->anti_aliasing, NULL, 0))
+    {
+      aa_time_query_begin(&state->query);
+      render_ssaa(state, state->anti_aliasing == AA_SSAA_2X ? 0 : 1);
       aa_time_query_end(&state->query);
     }
+    else
+    {
+      frame_skipped = true;
+    }
+  }
+
+  // MSAA x4 with the fragment shader run for every sample, resolved as MSAA x4
+  if (state->anti_aliasing == AA_MSAAx4_SAMPLE_SHADING)
+  {
+    aa_time_query_begin(&state->query);
+    aa_frame_buffer_bind(&state->msaa_fbo_x4);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glEnable(GL_SAMPLE_SHADING);
+    glMinSampleShading(1.0f);
+    aa_trace_gpu_begin(&state->trace, "scene");
+    aa_scene_render(state);
+    aa_trace_gpu_end(&state->trace);
+    glDisable(GL_SAMPLE_SHADING);
+    aa_trace_gpu_begin(&state->trace, "msaa resolve");
+    aa_frame_buffer_blit(
+        &state->default_fbo, &state->msaa_fbo_x4, state->window_width,
+        state->window_height);
+    aa_trace_gpu_end(&state->trace);
+    aa_frame_buffer_bind(&state->default_fbo);
+    aa_time_query_end(&state->query);
   }
+
+  // MSAA resolved by a shader instead of the blit, to compare their costs
+  if (state->anti_aliasing >= AA_MSAAx4_RESOLVE
+      && state->anti_aliasing <= AA_MSAAx16_RESOLVE)
+  {
+    aa_frame_buffer* fbos[] = {
+        &state->msaa_fbo_x4, &state->msaa_fbo_x8, &state->msaa_fbo_x16};
+    aa_texture* textures[] = {
+        &state->msaa_color_texture_x4, &state->msaa_color_texture_x8,
+        &state->msaa_color_texture_x16};
+    const int INDEX = state->anti_aliasing - AA_MSAAx4_RESOLVE;
+    aa_time_query_begin(&state->query);
+    aa_frame_buffer_bind(fbos[INDEX]);
+    glClear(GL_COLOR_BUFFER_BIT);
+    aa_trace_gpu_begin(&state->trace, "scene");
+    aa_scene_render(state);
+    aa_trace_gpu_end(&state->trace);
+    render_msaa_resolve(
+        state, textures[INDEX], &state->resolve_tables[INDEX]);
+    aa_time_query_end(&state->query);
+  }
+  state->last_cpu_submit_ns = (uint32_t)(aa_clock_ns() - submit_begin_ns);
+  if (frame_skipped)
+  {
+    state->configuration_failed = state->automation_mode;
+    if (!state->automation_mode && !state->headless)
+      aa_ui_overlay(state);
+    return;
+  }
+
   // Getting time elapsed between start and end of every frame's rendering pipeline
+  // (this waits for the GPU to finish the frame)
+  aa_trace_cpu_begin(&state->trace, "query readback");
   aa_time_query_result(&state->query);
+  aa_trace_cpu_end(&state->trace);
+  state->last_gpu_ns = state->query.result;
+  aa_frame_ring_push(&state->frame_times, state->last_gpu_ns / 1000000.0f);
   // Write in buffer
   if (state->samples_current < state->samples_total && state->is_recording)
   {
-    state->samples[state->samples_current++] = state->query.result;
+    state->cpu_samples[state->samples_current] = state->last_cpu_submit_ns;
+    state->samples[state->samples_current++]   = state->query.result;
     if (state->samples_current == state->samples_total)
+    {
       if (!state->automation_mode)
         state->is_recording = false;
+      // The last frame of a recording is captured for scoring, outside of the
+      // timed window
+      if (state->measure_quality)
+        aa_quality_capture(state);
+    }
   }
+
+  // The timing window is closed: the overlay can not perturb this frame anymore
+  if (!state->automation_mode && !state->headless)
+    aa_ui_overlay(state);
 }
 
 /// @brief Main loop of the application
 /// @param window Pointer to the active GLFW window (not null)
 /// @param context Pointer to the ImGui context
 /// @param io Pointer to the ImGui IO interface
-/// @param argc Command line argument count
-/// @param argv Command line argument values
+/// @param options The options parsed from the command line
 static void main_loop(
-    GLFWwindow* window, ImGuiContext* context, ImGuiIO* io, int argc, char** argv)
+    GLFWwindow* window, ImGuiContext* context, ImGuiIO* io,
+    const AppOptions* options)
 {
   assert(window != NULL && "expected non-null window");
 
@@ -403,13 +1099,19 @@ static void main_loop(
   state.default_fbo.id                    = 0;
 
   // Default settings
-  state.anti_aliasing   = AA_NONE;
-  state.automation_mode = false;
-  state.warmup_frames   = 0;
-  state.current_scene   = SCENE_TRIANGLE;
+  state.anti_aliasing        = AA_NONE;
+  state.automation_mode      = false;
+  state.warmup_frames        = 0;
+  state.current_scene        = SCENE_TRIANGLE;
+  state.smaa_parameters      = AA_SMAA_PRESETS[2];
+  state.fxaa_parameters      = AA_FXAA_DEFAULTS;
+  state.scene_parameters     = AA_SCENE_DEFAULTS;
+  state.last_quality.psnr    = -1.0;
+  state.isolate_measurements = options->isolate_measurements;
+  state.headless             = options->headless;
 
   // Handling automation runs from matlab
-  if (argc > 1 && strcmp(argv[1], "--auto") == 0)
+  if (options->automation_mode)
   {
     state.automation_mode = true;
     state.warmup_frames   = 100;
@@ -417,19 +1119,100 @@ static void main_loop(
     AA_SAMPLE_COUNT = 500;
     printf("Running in Automation Mode (%d samples)\n", AA_SAMPLE_COUNT);
   }
+  // Pairing every measured configuration with its image quality
+  if (options->measure_quality)
+  {
+    state.measure_quality = true;
+    // The summary is appended to by every configuration
+    remove(AA_SAMPLES_QUALITY_FILE_NAME);
+  }
+  // Reference sampling (16 samples per pixel by default)
+  if (options->reference_samples)
+  {
+    uint32_t scale = 1;
+    while ((scale + 1) * (scale + 1) <= options->reference_samples)
+      scale++;
+    if (scale * scale != options->reference_samples)
+      printf("Warning: Using %u reference samples per pixel\n", scale * scale);
+    state.reference.scale = scale;
+  }
+  state.reference.force_accumulation = options->reference_jitter;
+  state.reference.exact              = options->reference_exact;
+  // Searching the parameters for a frame-time budget
+  if (options->tune_budget_ms > 0.0)
+  {
+    state.measure_quality = true;
+    // Only the median is kept, the search space is large
+    AA_SAMPLE_COUNT = 100;
+    printf(
+        "Tuning for %.3f ms (quality floor %.2f dB)\n", options->tune_budget_ms,
+        options->quality_floor);
+  }
+  // Recording a CPU/GPU timeline for Perfetto
+  if (options->trace_file_name)
+  {
+    state.trace.enabled   = true;
+    state.trace.file_name = options->trace_file_name;
+    printf("Tracing to `%s`\n", state.trace.file_name);
+  }
 
-  ImFontAtlas* atlas = io->Fonts;
-  io->FontDefault    = ImFontAtlas_AddFontFromFileTTF(
-      atlas, "resources/Inter-4.1/InterVariable.ttf", 18.0f, NULL, NULL);
+  // Development override of the embedded shaders
+  if (options->shader_directory)
+  {
+    aa_shaders_set_directory(options->shader_directory);
+    printf("Reading shaders from `%s`\n", options->shader_directory);
+  }
+
+  // Headless runs never draw the UI: the font (and its atlas) is not needed
+  if (!state.headless)
+  {
+    aa_startup_begin("font loading");
+    ImFontAtlas* atlas = io->Fonts;
+    io->FontDefault    = ImFontAtlas_AddFontFromFileTTF(
+        atlas, "resources/Inter-4.1/InterVariable.ttf", 18.0f, NULL, NULL);
+    aa_startup_end();
+  }
   glfwGetFramebufferSize(state.window, &state.window_width, &state.window_height);
   if (state.window_height < 32)
     state.window_height = 32;
   if (state.window_width < 32)
     state.window_width = 32;
   // Make sure all required data will be initialized successfully
-  if (on_init(&state) != 0)
+  aa_startup_begin("on_init");
+  int init_result = on_init(&state);
+  aa_startup_end();
+  if (init_result != 0)
     return;
 
+  // Configurations measured by the automation mode
+  if (state.automation_mode)
+  {
+    int matrix_result = 0;
+    if (options->matrix_file_name)
+      matrix_result = aa_matrix_load(&state, options->matrix_file_name);
+    else if (options->tune_budget_ms > 0.0)
+      matrix_result = aa_matrix_tuning(&state);
+    else
+      matrix_result = aa_matrix_default(&state);
+    if (matrix_result == 0)
+      matrix_result = aa_matrix_skip_unsupported(&state);
+    if (matrix_result == 0 && options->tune_budget_ms > 0.0)
+    {
+      matrix_result = aa_tuner_init(
+          &state, options->tune_budget_ms, options->quality_floor);
+    }
+    if (matrix_result != 0)
+    {
+      on_end(&state);
+      return;
+    }
+    aa_matrix_apply(&state);
+    printf("Benchmark matrix: %zu configurations\n", state.matrix_count);
+  }
+
+  // The first frame also builds the font atlas and the ImGui device objects
+  aa_startup_begin("first frame");
+
   double last_time = glfwGetTime();
   while (!glfwWindowShouldClose(window))
   {
@@ -454,29 +1237,142 @@ static void main_loop(
       glViewport(0, 0, width, height);
       on_resize(&state);
     }
+    aa_trace_frame_begin(&state.trace);
     aa_frame_buffer_bind(&state.default_fbo);
-    ImGui_ImplOpenGL3_NewFrame();
-    ImGui_ImplGlfw_NewFrame();
-    igNewFrame();
+    if (!state.headless)
+    {
+      ImGui_ImplOpenGL3_NewFrame();
+      ImGui_ImplGlfw_NewFrame();
+      igNewFrame();
+    }
     // BEGIN FRAME:
+    aa_trace_cpu_begin(&state.trace, "on_frame");
     on_frame(&state);
+    aa_trace_cpu_end(&state.trace);
     // END FRAME:
-    igRender();
-    ImGui_ImplOpenGL3_RenderDrawData(igGetDrawData());
-
-    if (io->ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
+    if (!state.headless)
     {
-      GLFWwindow* backup_current_context = glfwGetCurrentContext();
-      igUpdatePlatformWindows();
-      igRenderPlatformWindowsDefault(NULL, NULL);
-      glfwMakeContextCurrent(backup_current_context);
+      aa_trace_cpu_begin(&state.trace, "imgui render");
+      aa_trace_gpu_begin(&state.trace, "imgui");
+      igRender();
+      ImGui_ImplOpenGL3_RenderDrawData(igGetDrawData());
+
+      if (io->ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
+      {
+        GLFWwindow* backup_current_context = glfwGetCurrentContext();
+        igUpdatePlatformWindows();
+        // Presenting extra windows costs a context switch and a swap per window
+        if (!(state.isolate_measurements && state.is_recording))
+          igRenderPlatformWindowsDefault(NULL, NULL);
+        glfwMakeContextCurrent(backup_current_context);
+      }
+      aa_trace_gpu_end(&state.trace);
+      aa_trace_cpu_end(&state.trace);
     }
+    aa_trace_cpu_begin(&state.trace, "glfwSwapBuffers");
     glfwSwapBuffers(window);
+    aa_trace_cpu_end(&state.trace);
+    if (state.frame_count == 0)
+      aa_startup_end();
     ++state.frame_count;
   }
+  aa_trace_write(&state.trace);
   on_end(&state);
 }
 
+/// @brief Parses the command line
+/// @param argc Number of command-line arguments
+/// @param argv Array of command-line argument strings
+/// @param out The parsed options
+static void parse_options(int argc, char** argv, AppOptions* out)
+{
+  memset(out, 0, sizeof(AppOptions));
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--auto") == 0)
+    {
+      out->automation_mode = true;
+    }
+    else if (strcmp(argv[i], "--trace") == 0)
+    {
+      out->trace_file_name = "trace.json";
+      if (i + 1 < argc && argv[i + 1][0] != '-')
+        out->trace_file_name = argv[++i];
+    }
+    else if (strcmp(argv[i], "--isolate") == 0)
+    {
+      out->isolate_measurements = true;
+    }
+    else if (strcmp(argv[i], "--shader-dir") == 0 && i + 1 < argc)
+    {
+      out->shader_directory = argv[++i];
+    }
+    else if (strcmp(argv[i], "--matrix") == 0 && i + 1 < argc)
+    {
+      out->matrix_file_name = argv[++i];
+      out->automation_mode  = true;
+    }
+    else if (strcmp(argv[i], "--tune") == 0 && i + 1 < argc)
+    {
+      out->tune_budget_ms  = atof(argv[++i]);
+      out->automation_mode = true;
+      if (out->tune_budget_ms <= 0.0)
+        printf("Warning: `--tune` expects a budget in ms\n");
+    }
+    else if (strcmp(argv[i], "--quality") == 0)
+    {
+      out->measure_quality = true;
+    }
+    else if (
+        strcmp(argv[i], "--reference") == 0 && i + 1 < argc
+        && strcmp(argv[i + 1], "exact") == 0)
+    {
+      out->reference_exact = true;
+      i++;
+    }
+    else if (strcmp(argv[i], "--reference") == 0 && i + 1 < argc)
+    {
+      int samples = atoi(argv[++i]);
+      if (samples < 1 || samples > 256)
+        printf(
+            "Warning: `--reference` expects 1 to 256 samples per pixel, or "
+            "`exact`\n");
+      else
+        out->reference_samples = (uint32_t)samples;
+    }
+    else if (strcmp(argv[i], "--reference-jitter") == 0)
+    {
+      out->reference_jitter = true;
+    }
+    else if (strcmp(argv[i], "--quality-floor") == 0 && i + 1 < argc)
+    {
+      out->quality_floor = atof(argv[++i]);
+    }
+    else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+    {
+      if (sscanf(argv[++i], "%dx%d", &out->window_width, &out->window_height) != 2
+          || out->window_width <= 0 || out->window_height <= 0)
+      {
+        printf("Warning: `--size` expects <width>x<height>\n");
+        out->window_width  = 0;
+        out->window_height = 0;
+      }
+    }
+    else if (strcmp(argv[i], "--time-startup") == 0)
+    {
+      out->time_startup = true;
+    }
+    else if (strcmp(argv[i], "--headless") == 0)
+    {
+      out->headless = true;
+    }
+    else
+    {
+      printf("Warning: unknown argument `%s`\n", argv[i]);
+    }
+  }
+}
+
 /// @brief Application starting point
 /// @param argc Number of command-line arguments
 /// @param argv Array of command-line argument strings
@@ -487,17 +1383,29 @@ int main(int argc, char** argv)
       "Hello AA! (GLFW %i.%i.%i)\n", GLFW_VERSION_MAJOR, GLFW_VERSION_MINOR,
       GLFW_VERSION_REVISION);
 
+  AppOptions options;
+  parse_options(argc, argv, &options);
+
   // Initialize GLFW
+  aa_startup_begin("glfwInit");
   if (glfwInit() != GLFW_TRUE)
   {
     fputs("ERROR: Could not initialize GLFW!", stderr);
     exit(-1);
   }
+  aa_startup_end();
   glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
   glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+  // Nothing is presented to the user in headless runs
+  if (options.headless)
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
 
   // Create window, and OpenGL context
-  GLFWwindow* window = glfwCreateWindow(640, 480, "aa - benchmarker", NULL, NULL);
+  aa_startup_begin("window and context");
+  int window_width   = options.window_width ? options.window_width : 640;
+  int window_height  = options.window_height ? options.window_height : 480;
+  GLFWwindow* window = glfwCreateWindow(
+      window_width, window_height, "aa - benchmarker", NULL, NULL);
   if (window == NULL)
   {
     fputs("ERROR: Could not create window!", stderr);
@@ -505,35 +1413,54 @@ int main(int argc, char** argv)
     exit(-1);
   }
   glfwMakeContextCurrent(window);
+  aa_startup_end();
 
   // Initialize glad
+  aa_startup_begin("glad loading");
   if (gladLoadGLLoader((GLADloadproc)&glfwGetProcAddress) == 0)
   {
     fputs("ERROR: Could not initialize GLAD!", stderr);
     exit(-1);
   }
+  aa_gl_extensions_load((GLADloadproc)&glfwGetProcAddress);
+  aa_gl_capabilities_probe();
+  aa_startup_end();
 
   // Disable VSYNC
   glfwSwapInterval(0);
 
-  // Start ImGUI
+  // Start ImGUI (the backends are not needed when headless)
+  aa_startup_begin("imgui init");
   ImGuiContext* context = igCreateContext(NULL);
   ImGuiIO* io           = igGetIO_ContextPtr(context);
   io->ConfigFlags |= ImGuiConfigFlags_DockingEnable;
-  io->ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;
+  // Extra OS windows are drawn and presented every frame, keep them out of
+  // isolated measurements
+  if (!options.isolate_measurements && !options.headless)
+    io->ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;
 
-  ImGui_ImplGlfw_InitForOpenGL(window, true);
-  ImGui_ImplOpenGL3_Init("#version 430 core");
+  if (!options.headless)
+  {
+    ImGui_ImplGlfw_InitForOpenGL(window, true);
+    ImGui_ImplOpenGL3_Init("#version 430 core");
+  }
+  aa_startup_end();
 
-  main_loop(window, context, io, argc, argv);
+  main_loop(window, context, io, &options);
 
   // Shutdown ImGUI
-  ImGui_ImplOpenGL3_Shutdown();
-  ImGui_ImplGlfw_Shutdown();
+  if (!options.headless)
+  {
+    ImGui_ImplOpenGL3_Shutdown();
+    ImGui_ImplGlfw_Shutdown();
+  }
   igDestroyContext(NULL);
 
   // Destroy window
   glfwDestroyWindow(window);
   // Shutdown GLFW
   glfwTerminate();
+
+  if (options.time_startup)
+    aa_startup_report();
 }
\ No newline at end of file
@@ -0,0 +1,563 @@
+#include "matrix.h"
+#include "lifecycle.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Indexed by `aa_algorithm`
+static const char* const AA_ALGORITHM_NAMES[] = {
+    "NONE",     "MSAAx4",      "MSAAx8",    "MSAAx16",    "FXAA", "FXAA_Iterative",
+    "SMAA_Low", "SMAA_Medium", "SMAA_High", "SMAA_Ultra", "SMAA_Custom",
+    "SMAA_T2x", "SMAA_S2x",    "SMAA_4x",   "TAA",        "CMAA2",
+    "MLAA",     "MLAA_CPU",    "SSAA_2x",   "SSAA_4x",    "MSAAx4_SampleShading",
+    "MSAAx4_Resolve", "MSAAx8_Resolve", "MSAAx16_Resolve"};
+#define AA_ALGORITHM_COUNT \
+  (sizeof(AA_ALGORITHM_NAMES) / sizeof(AA_ALGORITHM_NAMES[0]))
+
+// Indexed by `SceneType`
+static const char* const AA_SCENE_NAMES[] = {
+    "triangle", "dartboard", "star", "grid", "slivers"};
+#define AA_SCENE_COUNT (sizeof(AA_SCENE_NAMES) / sizeof(AA_SCENE_NAMES[0]))
+// `all` and the default matrix only cover the triangle and the dartboard, the
+// stress scenes are measured when named
+#define AA_MATRIX_CLASSIC_SCENES 2
+/// @brief Maximum number of triangles of a stress scene (`triangles`)
+#define AA_MATRIX_MAX_TRIANGLES (1u << 24)
+
+static const char* const AA_PRESET_NAMES[] = {"low", "medium", "high", "ultra"};
+
+const char* aa_algorithm_name(aa_algorithm algorithm)
+{
+  if ((size_t)algorithm >= AA_ALGORITHM_COUNT)
+    return "?";
+  return AA_ALGORITHM_NAMES[algorithm];
+}
+
+const char* aa_scene_name(SceneType scene)
+{
+  if ((size_t)scene >= AA_SCENE_COUNT)
+    return "?";
+  return AA_SCENE_NAMES[scene];
+}
+
+void aa_matrix_cell_name(const aa_matrix_cell* cell, char* out, size_t size)
+{
+  const char* name = aa_algorithm_name(cell->algorithm);
+  if (cell->algorithm == AA_SMAA_CUSTOM)
+  {
+    const aa_smaa_parameters* smaa = &cell->smaa;
+    char diagonal[16]              = "off";
+    char corner[16]                = "off";
+    if (smaa->diagonal_detection)
+      snprintf(diagonal, sizeof(diagonal), "%d", smaa->max_search_steps_diag);
+    if (smaa->corner_detection)
+      snprintf(corner, sizeof(corner), "%.0f", smaa->corner_rounding);
+    snprintf(
+        out, size, "%s_t%.3f_s%d_d%s_c%s", name, smaa->threshold,
+        smaa->max_search_steps, diagonal, corner);
+    // Luma edges keep the historical name
+    if (smaa->edge_mode != AA_SMAA_EDGE_LUMA)
+    {
+      size_t length = strlen(out);
+      snprintf(
+          out + length, size - length, "_e%s",
+          aa_smaa_edge_mode_name(smaa->edge_mode));
+    }
+  }
+  else if (cell->algorithm == AA_FXAA_ITERATIVE)
+  {
+    // The defaults keep the historical name
+    const aa_fxaa_parameters* fxaa = &cell->fxaa;
+    snprintf(out, size, "%s", name);
+    if (fxaa->subpix != AA_FXAA_DEFAULTS.subpix
+        || fxaa->edge_threshold != AA_FXAA_DEFAULTS.edge_threshold
+        || fxaa->edge_threshold_min != AA_FXAA_DEFAULTS.edge_threshold_min)
+    {
+      snprintf(
+          out, size, "%s_p%.2f_e%.3f", name, fxaa->subpix,
+          fxaa->edge_threshold);
+    }
+    if (fxaa->edge_threshold_min != AA_FXAA_DEFAULTS.edge_threshold_min)
+    {
+      size_t length = strlen(out);
+      snprintf(out + length, size - length, "_m%.4f", fxaa->edge_threshold_min);
+    }
+    if (fxaa->quality_preset != AA_FXAA_DEFAULTS.quality_preset)
+    {
+      size_t length = strlen(out);
+      snprintf(out + length, size - length, "_q%d", fxaa->quality_preset);
+    }
+    if (fxaa->luma_alpha)
+    {
+      size_t length = strlen(out);
+      snprintf(out + length, size - length, "_la");
+    }
+  }
+  else if (
+      cell->algorithm >= AA_MSAAx4_RESOLVE
+      && cell->algorithm <= AA_MSAAx16_RESOLVE)
+  {
+    snprintf(
+        out, size, "%s_%s%s", name, aa_resolve_filter_name(cell->resolve.filter),
+        cell->resolve.tonemap ? "_tm" : "");
+  }
+  else
+  {
+    snprintf(out, size, "%s", name);
+  }
+}
+
+void aa_matrix_scene_label(const aa_matrix_cell* cell, char* out, size_t size)
+{
+  const char* name                      = aa_scene_name(cell->scene);
+  const aa_scene_parameters* parameters = &cell->scene_parameters;
+  switch (cell->scene)
+  {
+  case SCENE_DARTBOARD:
+    // The default dartboard keeps the historical name
+    if (parameters->slices == AA_SCENE_DEFAULTS.slices)
+      snprintf(out, size, "%s", name);
+    else
+      snprintf(out, size, "%s_n%" PRIu32, name, parameters->slices);
+    break;
+  case SCENE_SIEMENS_STAR:
+    snprintf(out, size, "%s_n%" PRIu32, name, parameters->slices);
+    break;
+  case SCENE_GRID:
+    snprintf(
+        out, size, "%s_m%" PRIu32 "_w%.2f", name, parameters->triangles,
+        parameters->thickness);
+    break;
+  case SCENE_SLIVERS:
+    snprintf(
+        out, size, "%s_m%" PRIu32 "_w%.2f_s%" PRIu32, name,
+        parameters->triangles, parameters->thickness, parameters->seed);
+    break;
+  default:
+    snprintf(out, size, "%s", name);
+    break;
+  }
+  if (parameters->spin != 0.0f)
+  {
+    size_t length = strlen(out);
+    snprintf(out + length, size - length, "_r%.2f", parameters->spin);
+  }
+}
+
+void aa_matrix_cell_file_name(const aa_matrix_cell* cell, char* out, size_t size)
+{
+  char name[96];
+  char scene[64] = "";
+  aa_matrix_cell_name(cell, name, sizeof(name));
+  // The still triangle is the unnamed scene
+  if (cell->scene != SCENE_TRIANGLE || cell->scene_parameters.spin != 0.0f)
+  {
+    scene[0] = '_';
+    aa_matrix_scene_label(cell, scene + 1, sizeof(scene) - 1);
+  }
+  snprintf(out, size, "aa_%s%s.txt", name, scene);
+}
+
+/// @brief Finds `name` in `names`
+/// @return The index, or -1 if not found
+static int aa_matrix_find(
+    const char* const* names, size_t count, const char* name)
+{
+  for (size_t i = 0; i < count; i++)
+  {
+    if (strcmp(names[i], name) == 0)
+      return (int)i;
+  }
+  return -1;
+}
+
+/// @brief Appends a cell to the matrix of the state
+/// @return 0 on success, -1 on allocation failure
+static int aa_matrix_push(
+    AppState* state, size_t* capacity, const aa_matrix_cell* cell)
+{
+  if (state->matrix_count == *capacity)
+  {
+    size_t new_capacity = *capacity ? *capacity * 2 : 32;
+    aa_matrix_cell* cells =
+        realloc(state->matrix, new_capacity * sizeof(aa_matrix_cell));
+    if (cells == NULL)
+      return -1;
+    state->matrix = cells;
+    *capacity     = new_capacity;
+  }
+  state->matrix[state->matrix_count++] = *cell;
+  return 0;
+}
+
+int aa_matrix_default(AppState* state)
+{
+  // FXAA 3.11 quality presets measured besides the default one
+  static const int FXAA_PRESETS[] = {10, 15, 20, 29};
+  // Rotations of the dartboard (degrees per frame) and the algorithms compared
+  // on it, to measure the temporal techniques on a moving scene
+  static const float SPINS[]           = {0.5f, 2.0f};
+  static const aa_algorithm SPINNING[] = {
+      AA_MSAAx4,     AA_MSAAx8,   AA_SMAA_LOW, AA_SMAA_MEDIUM, AA_SMAA_HIGH,
+      AA_SMAA_ULTRA, AA_SMAA_T2X, AA_SMAA_S2X, AA_SMAA_4X,     AA_TAA};
+  aa_matrix_delete(state);
+  size_t capacity = 0;
+  for (size_t scene = 0; scene < AA_MATRIX_CLASSIC_SCENES; scene++)
+  {
+    aa_matrix_cell cell;
+    memset(&cell, 0, sizeof(aa_matrix_cell));
+    cell.scene            = (SceneType)scene;
+    cell.scene_parameters = AA_SCENE_DEFAULTS;
+    cell.smaa             = AA_SMAA_PRESETS[2];
+    cell.fxaa             = AA_FXAA_DEFAULTS;
+    for (int algorithm = AA_NONE; algorithm < AA_SMAA_CUSTOM; algorithm++)
+    {
+      cell.algorithm = (aa_algorithm)algorithm;
+      if (aa_matrix_push(state, &capacity, &cell) != 0)
+        return -1;
+    }
+    // The temporal and morphological techniques, next to the SMAA presets
+    for (int algorithm = AA_SMAA_T2X; algorithm <= AA_MLAA_CPU; algorithm++)
+    {
+      cell.algorithm = (aa_algorithm)algorithm;
+      if (aa_matrix_push(state, &capacity, &cell) != 0)
+        return -1;
+    }
+    cell.algorithm = AA_SMAA_CUSTOM;
+    for (size_t preset = 0; preset < 4; preset++)
+    {
+      cell.smaa = AA_SMAA_PRESETS[preset];
+      if (aa_matrix_push(state, &capacity, &cell) != 0)
+        return -1;
+    }
+    // The other edge detection modes, on the high preset
+    for (int mode = AA_SMAA_EDGE_COLOR; mode < AA_SMAA_EDGE_MODES; mode++)
+    {
+      cell.smaa           = AA_SMAA_PRESETS[2];
+      cell.smaa.edge_mode = (aa_smaa_edge_mode)mode;
+      if (aa_matrix_push(state, &capacity, &cell) != 0)
+        return -1;
+    }
+    cell.smaa = AA_SMAA_PRESETS[2];
+    // Luma in alpha, and the fastest and slowest preset of each family,
+    // against the historical shader
+    cell.algorithm       = AA_FXAA_ITERATIVE;
+    cell.fxaa.luma_alpha = true;
+    if (aa_matrix_push(state, &capacity, &cell) != 0)
+      return -1;
+    cell.fxaa.luma_alpha = false;
+    for (size_t i = 0; i < sizeof(FXAA_PRESETS) / sizeof(FXAA_PRESETS[0]); i++)
+    {
+      cell.fxaa.quality_preset = FXAA_PRESETS[i];
+      if (aa_matrix_push(state, &capacity, &cell) != 0)
+        return -1;
+    }
+    cell.fxaa = AA_FXAA_DEFAULTS;
+    // Every resolve filter against the blit of each sample count
+    for (int algorithm = AA_MSAAx4_RESOLVE; algorithm <= AA_MSAAx16_RESOLVE;
+         algorithm++)
+    {
+      cell.algorithm = (aa_algorithm)algorithm;
+      for (int filter = 0; filter < AA_RESOLVE_FILTER_COUNT; filter++)
+      {
+        cell.resolve.filter = (aa_resolve_filter)filter;
+        if (aa_matrix_push(state, &capacity, &cell) != 0)
+          return -1;
+      }
+    }
+    cell.resolve.filter = AA_RESOLVE_BOX;
+    // Upper bounds of cost and quality in every chart
+    for (int algorithm = AA_SSAA_2X; algorithm <= AA_MSAAx4_SAMPLE_SHADING;
+         algorithm++)
+    {
+      cell.algorithm = (aa_algorithm)algorithm;
+      if (aa_matrix_push(state, &capacity, &cell) != 0)
+        return -1;
+    }
+  }
+
+  aa_matrix_cell cell;
+  memset(&cell, 0, sizeof(aa_matrix_cell));
+  cell.scene            = SCENE_DARTBOARD;
+  cell.scene_parameters = AA_SCENE_DEFAULTS;
+  cell.smaa             = AA_SMAA_PRESETS[2];
+  cell.fxaa             = AA_FXAA_DEFAULTS;
+  for (size_t i = 0; i < sizeof(SPINS) / sizeof(SPINS[0]); i++)
+  {
+    cell.scene_parameters.spin = SPINS[i];
+    for (size_t j = 0; j < sizeof(SPINNING) / sizeof(SPINNING[0]); j++)
+    {
+      cell.algorithm = SPINNING[j];
+      if (aa_matrix_push(state, &capacity, &cell) != 0)
+        return -1;
+    }
+  }
+  return 0;
+}
+
+int aa_matrix_tuning(AppState* state)
+{
+  static const float subpixes[]        = {0.25f, 0.5f, 0.75f, 1.0f};
+  static const float edge_thresholds[] = {0.063f, 0.125f, 0.166f, 0.25f, 0.333f};
+  static const float thresholds[]      = {0.05f, 0.1f, 0.15f, 0.2f};
+  static const int search_steps[]      = {4, 8, 16, 32};
+
+  aa_matrix_delete(state);
+  size_t capacity = 0;
+  aa_matrix_cell cell;
+  memset(&cell, 0, sizeof(aa_matrix_cell));
+  cell.scene            = SCENE_DARTBOARD;
+  cell.scene_parameters = AA_SCENE_DEFAULTS;
+  cell.smaa             = AA_SMAA_PRESETS[2];
+  cell.fxaa             = AA_FXAA_DEFAULTS;
+
+  const aa_algorithm fixed[] = {AA_NONE, AA_FXAA, AA_MSAAx4, AA_MSAAx8, AA_MSAAx16};
+  for (size_t i = 0; i < sizeof(fixed) / sizeof(fixed[0]); i++)
+  {
+    cell.algorithm = fixed[i];
+    if (aa_matrix_push(state, &capacity, &cell) != 0)
+      return -1;
+  }
+
+  cell.algorithm = AA_FXAA_ITERATIVE;
+  for (size_t i = 0; i < sizeof(subpixes) / sizeof(subpixes[0]); i++)
+  {
+    for (size_t j = 0; j < sizeof(edge_thresholds) / sizeof(edge_thresholds[0]); j++)
+    {
+      cell.fxaa.subpix         = subpixes[i];
+      cell.fxaa.edge_threshold = edge_thresholds[j];
+      if (aa_matrix_push(state, &capacity, &cell) != 0)
+        return -1;
+    }
+  }
+
+  cell.algorithm = AA_SMAA_CUSTOM;
+  for (size_t i = 0; i < sizeof(thresholds) / sizeof(thresholds[0]); i++)
+  {
+    for (size_t j = 0; j < sizeof(search_steps) / sizeof(search_steps[0]); j++)
+    {
+      for (int features = 0; features < 2; features++)
+      {
+        cell.smaa.threshold             = thresholds[i];
+        cell.smaa.max_search_steps      = search_steps[j];
+        cell.smaa.max_search_steps_diag = search_steps[j] / 2;
+        cell.smaa.diagonal_detection    = features != 0;
+        cell.smaa.corner_detection      = features != 0;
+        if (aa_matrix_push(state, &capacity, &cell) != 0)
+          return -1;
+      }
+    }
+  }
+  return 0;
+}
+
+/// @brief Applies a `key=value` parameter to a cell
+/// @return 0 on success, -1 if the parameter is unknown or malformed
+static int aa_matrix_parameter(
+    aa_matrix_cell* cell, const char* key, const char* value)
+{
+  char* end      = NULL;
+  double number  = strtod(value, &end);
+  bool is_number = end != value && *end == '\0';
+
+  if (strcmp(key, "preset") == 0)
+  {
+    int preset = aa_matrix_find(AA_PRESET_NAMES, 4, value);
+    if (preset < 0)
+      return -1;
+    cell->smaa = AA_SMAA_PRESETS[preset];
+    return 0;
+  }
+  if (strcmp(key, "edge") == 0)
+  {
+    for (int mode = 0; mode < AA_SMAA_EDGE_MODES; mode++)
+    {
+      if (strcmp(aa_smaa_edge_mode_name((aa_smaa_edge_mode)mode), value) == 0)
+      {
+        cell->smaa.edge_mode = (aa_smaa_edge_mode)mode;
+        return 0;
+      }
+    }
+    return -1;
+  }
+  if (strcmp(key, "filter") == 0)
+  {
+    int filter = aa_resolve_filter_find(value);
+    if (filter < 0)
+      return -1;
+    cell->resolve.filter = (aa_resolve_filter)filter;
+    return 0;
+  }
+  if (!is_number)
+    return -1;
+  if (strcmp(key, "threshold") == 0)
+    cell->smaa.threshold = (float)number;
+  else if (strcmp(key, "search_steps") == 0)
+    cell->smaa.max_search_steps = (int)number;
+  else if (strcmp(key, "diag_steps") == 0)
+    cell->smaa.max_search_steps_diag = (int)number;
+  else if (strcmp(key, "corner_rounding") == 0)
+    cell->smaa.corner_rounding = (float)number;
+  else if (strcmp(key, "diag") == 0)
+    cell->smaa.diagonal_detection = number != 0.0;
+  else if (strcmp(key, "corner") == 0)
+    cell->smaa.corner_detection = number != 0.0;
+  else if (strcmp(key, "subpix") == 0)
+    cell->fxaa.subpix = (float)number;
+  else if (strcmp(key, "edge_threshold") == 0)
+    cell->fxaa.edge_threshold = (float)number;
+  else if (strcmp(key, "edge_threshold_min") == 0)
+    cell->fxaa.edge_threshold_min = (float)number;
+  else if (
+      strcmp(key, "fxaa_preset") == 0 && aa_fxaa_preset_index((int)number) >= 0)
+    cell->fxaa.quality_preset = (int)number;
+  else if (strcmp(key, "luma_alpha") == 0)
+    cell->fxaa.luma_alpha = number != 0.0;
+  else if (strcmp(key, "tonemap") == 0)
+    cell->resolve.tonemap = number != 0.0;
+  else if (strcmp(key, "slices") == 0 && number >= 2.0 && number <= 1e6)
+    cell->scene_parameters.slices = (uint32_t)number;
+  else if (
+      strcmp(key, "triangles") == 0 && number >= 1.0
+      && number <= AA_MATRIX_MAX_TRIANGLES)
+    cell->scene_parameters.triangles = (uint32_t)number;
+  else if (strcmp(key, "thickness") == 0 && number > 0.0)
+    cell->scene_parameters.thickness = (float)number;
+  else if (strcmp(key, "seed") == 0 && number >= 0.0 && number <= UINT32_MAX)
+    cell->scene_parameters.seed = (uint32_t)number;
+  else if (strcmp(key, "spin") == 0)
+    cell->scene_parameters.spin = (float)number;
+  else
+    return -1;
+  return 0;
+}
+
+int aa_matrix_load(AppState* state, const char* file_name)
+{
+  aa_matrix_delete(state);
+  FILE* file = fopen(file_name, "r");
+  if (file == NULL)
+  {
+    printf("Error: Could not open matrix file `%s`!\n", file_name);
+    return -1;
+  }
+
+  size_t capacity = 0;
+  char line[512];
+  uint32_t line_number = 0;
+  int result           = 0;
+  while (result == 0 && fgets(line, sizeof(line), file) != NULL)
+  {
+    line_number++;
+    char* token = strtok(line, " \t\r\n");
+    if (token == NULL || token[0] == '#')
+      continue;
+
+    aa_matrix_cell cell;
+    memset(&cell, 0, sizeof(aa_matrix_cell));
+    cell.scene_parameters = AA_SCENE_DEFAULTS;
+    cell.smaa             = AA_SMAA_PRESETS[2];
+    cell.fxaa             = AA_FXAA_DEFAULTS;
+    int algorithm = aa_matrix_find(AA_ALGORITHM_NAMES, AA_ALGORITHM_COUNT, token);
+    token         = strtok(NULL, " \t\r\n");
+    bool all      = token != NULL && strcmp(token, "all") == 0;
+    int scene =
+        token ? aa_matrix_find(AA_SCENE_NAMES, AA_SCENE_COUNT, token) : -1;
+    if (algorithm < 0 || (scene < 0 && !all))
+    {
+      printf(
+          "Error: `%s` line %" PRIu32 ": expected an algorithm and a scene\n",
+          file_name, line_number);
+      result = -1;
+      break;
+    }
+    cell.algorithm = (aa_algorithm)algorithm;
+
+    while ((token = strtok(NULL, " \t\r\n")) != NULL)
+    {
+      char* value = strchr(token, '=');
+      if (value != NULL)
+        *value++ = '\0';
+      if (value == NULL || aa_matrix_parameter(&cell, token, value) != 0)
+      {
+        printf(
+            "Error: `%s` line %" PRIu32 ": invalid parameter `%s`\n", file_name,
+            line_number, token);
+        result = -1;
+        break;
+      }
+    }
+
+    for (size_t i = 0; result == 0 && i < AA_SCENE_COUNT; i++)
+    {
+      if (all ? i >= AA_MATRIX_CLASSIC_SCENES : (int)i != scene)
+        continue;
+      cell.scene = (SceneType)i;
+      result     = aa_matrix_push(state, &capacity, &cell);
+    }
+  }
+  fclose(file);
+
+  if (result == 0 && state->matrix_count == 0)
+  {
+    printf("Error: Matrix file `%s` is empty\n", file_name);
+    result = -1;
+  }
+  return result;
+}
+
+int aa_matrix_skip_unsupported(AppState* state)
+{
+  FILE* file = fopen(AA_MATRIX_SKIPPED_FILE_NAME, "w");
+  if (file == NULL)
+    printf("Error: Could not create file `%s`!\n", AA_MATRIX_SKIPPED_FILE_NAME);
+  else
+    fputs("file,reason\n", file);
+
+  size_t kept = 0;
+  for (size_t i = 0; i < state->matrix_count; i++)
+  {
+    const aa_matrix_cell* cell = &state->matrix[i];
+    char reason[96];
+    if (aa_algorithm_supported(state, cell->algorithm, reason, sizeof(reason)))
+    {
+      state->matrix[kept++] = *cell;
+      continue;
+    }
+    char file_name[256];
+    aa_matrix_cell_file_name(cell, file_name, sizeof(file_name));
+    printf("Skipped: %s (unsupported: %s)\n", file_name, reason);
+    if (file != NULL)
+      fprintf(file, "%s,unsupported: %s\n", file_name, reason);
+  }
+  if (file != NULL)
+    fclose(file);
+  state->matrix_count = kept;
+
+  if (kept == 0)
+  {
+    printf("Error: The device supports no configuration of the matrix\n");
+    return -1;
+  }
+  return 0;
+}
+
+void aa_matrix_apply(AppState* state)
+{
+  const aa_matrix_cell* cell = &state->matrix[state->matrix_index];
+  state->anti_aliasing       = cell->algorithm;
+  state->current_scene       = cell->scene;
+  state->scene_parameters    = cell->scene_parameters;
+  state->smaa_parameters     = cell->smaa;
+  state->fxaa_parameters     = cell->fxaa;
+  state->resolve_parameters  = cell->resolve;
+}
+
+void aa_matrix_delete(AppState* state)
+{
+  free(state->matrix);
+  state->matrix       = NULL;
+  state->matrix_count = 0;
+  state->matrix_index = 0;
+}
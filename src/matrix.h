@@ -0,0 +1,94 @@
+#ifndef __AA_HG_MATRIX
+#define __AA_HG_MATRIX
+
+#include <stdbool.h>
+#include "appstate.h"
+
+// Benchmark matrix: the list of configurations (`aa_matrix_cell`) measured one
+// after the other by the automation mode.
+// A matrix file holds one cell per line: an algorithm, a scene and optional
+// `key=value` parameters, e.g.
+//     SMAA_Custom dartboard preset=ultra threshold=0.08 search_steps=24
+//     MSAAx4 all
+// Algorithms are named like their result files (NONE, MSAAx4, FXAA_Iterative,
+// SMAA_Low, SMAA_Custom, SMAA_T2x...), scenes are `triangle`, `dartboard`,
+// `star`, `grid`, `slivers` or `all` (the triangle and the dartboard).
+// The custom SMAA parameters are `preset` (low, medium, high or ultra, the
+// starting values, high by default), `threshold`, `search_steps`, `diag_steps`,
+// `corner_rounding`, `diag`/`corner` (0 or 1, compiled in or out) and `edge`
+// (luma, color, depth or predicated: the edge detection pass, luma by default).
+// The iterative FXAA parameters are `subpix`, `edge_threshold`,
+// `edge_threshold_min`, `fxaa_preset` (the FXAA 3.11 quality preset, 10 to 15,
+// 20 to 29 or 39, 39 by default) and `luma_alpha` (0 or 1, luma written into
+// the alpha by the scene pass).
+// The custom MSAA resolves (MSAAx4_Resolve...) take `filter` (box, tent or
+// blackman_harris, box by default) and `tonemap` (0 or 1).
+// The scalable scenes take `slices` (dartboard and star, 180 by default),
+// `triangles` (grid and slivers, 10000 by default), `thickness` (width of the
+// grid triangles and slivers in pixels, 0.5 by default) and `seed` (slivers),
+// e.g.
+//     MSAAx4 grid triangles=1000000 thickness=0.25
+// Every scene takes `spin`, its rotation in degrees per frame (0 by default),
+// to measure temporal techniques on a moving scene, e.g.
+//     SMAA_T2x dartboard spin=0.5
+// Empty lines and lines starting with `#` are ignored.
+
+/// @brief Configurations left out of the matrix because the device does not
+///        support them (result file name and reason, one per line)
+#define AA_MATRIX_SKIPPED_FILE_NAME "aa_skipped.csv"
+
+/// @brief Returns the name of an algorithm, as used in result files
+const char* aa_algorithm_name(aa_algorithm algorithm);
+
+/// @brief Returns the name of a scene, as used in matrix files
+const char* aa_scene_name(SceneType scene);
+
+/// @brief Writes the name of a configuration, without its scene
+/// @details The algorithm name, followed by the parameters when they matter
+///          (e.g. "SMAA_Custom_t0.100_s16_d8_c25", "FXAA_Iterative_p0.50_e0.125"
+///          or "MSAAx8_Resolve_tent_tm")
+void aa_matrix_cell_name(const aa_matrix_cell* cell, char* out, size_t size);
+
+/// @brief Writes the name of the scene of a configuration, followed by its
+///        parameters when they matter (e.g. "dartboard", "grid_m10000_w0.50",
+///        "triangle_r0.50" for a spinning triangle)
+void aa_matrix_scene_label(const aa_matrix_cell* cell, char* out, size_t size);
+
+/// @brief Writes the result file name of a configuration
+///        (e.g. "aa_SMAA_Custom_t0.100_s16_d8_c25_dartboard.txt")
+void aa_matrix_cell_file_name(const aa_matrix_cell* cell, char* out, size_t size);
+
+/// @brief Fills the matrix of the state with every algorithm on every scene
+/// @details The custom SMAA pipeline is measured with the values of each
+///          preset, to compare dynamic loop bounds against specialised ones,
+///          every MSAA sample count is resolved by each filter of the custom
+///          resolve, and SSAA and per-sample MSAA close every scene as upper bounds.
+///          The temporal techniques are then compared with MSAA x4 and x8 and
+///          the SMAA presets on a dartboard spinning at two speeds
+/// @return 0 on success, -1 on allocation failure
+int aa_matrix_default(AppState* state);
+
+/// @brief Fills the matrix of the state with the search space of the tuner
+/// @details On the dartboard: no AA, FXAA, every MSAA sample count, a grid of
+///          iterative FXAA subpixel/edge thresholds, and a grid of custom SMAA
+///          thresholds/search steps with diagonal and corner processing off or on
+/// @return 0 on success, -1 on allocation failure
+int aa_matrix_tuning(AppState* state);
+
+/// @brief Fills the matrix of the state from a matrix file
+/// @return 0 on success, -1 if the file could not be read or is malformed
+int aa_matrix_load(AppState* state, const char* file_name);
+
+/// @brief Removes the cells the device does not support
+/// @details Every removed cell is printed and listed with the reason in
+///          `AA_MATRIX_SKIPPED_FILE_NAME` (rewritten, header only when none is)
+/// @return 0 on success, -1 if no cell is left
+int aa_matrix_skip_unsupported(AppState* state);
+
+/// @brief Selects the algorithm, scene and parameters of the current cell
+void aa_matrix_apply(AppState* state);
+
+/// @brief Releases the matrix of the state
+void aa_matrix_delete(AppState* state);
+
+#endif // !__AA_HG_MATRIX
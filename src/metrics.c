@@ -0,0 +1,622 @@
+#include "metrics.h"
+#include "clock.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+  #define AA_METRICS_X86
+  #include <immintrin.h>
+  #if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+    // MSVC compiles intrinsics of any instruction set
+    #define AA_TARGET_AVX2
+  #else
+    #define AA_TARGET_AVX2 __attribute__((target("avx2,fma")))
+  #endif
+#endif
+
+// Radius and weights of the SSIM window (Gaussian, sigma 1.5, normalised)
+#define AA_SSIM_RADIUS 5
+#define AA_SSIM_TAPS   (2 * AA_SSIM_RADIUS + 1)
+static const float AA_SSIM_WEIGHTS[AA_SSIM_TAPS] = {
+    0.00102838f, 0.00759876f, 0.03600077f, 0.10936069f, 0.21300554f, 0.26601172f,
+    0.21300554f, 0.10936069f, 0.03600077f, 0.00759876f, 0.00102838f};
+// Stabilising constants for a dynamic range of 1: (0.01 L)^2 and (0.03 L)^2
+#define AA_SSIM_C1 0.0001f
+#define AA_SSIM_C2 0.0009f
+// Number of filtered moments: mean x, mean y, E[x^2], E[y^2], E[xy]
+#define AA_SSIM_MOMENTS 5
+
+static const double AA_MS_SSIM_WEIGHTS[AA_METRICS_MAX_SCALES] = {
+    0.0448, 0.2856, 0.3001, 0.2363, 0.1333};
+
+// Rec. 709 luma
+#define AA_LUMA_R 0.2126f
+#define AA_LUMA_G 0.7152f
+#define AA_LUMA_B 0.0722f
+
+/// @brief Converts `count` pixels to luma and squared RGB error
+/// @return The sum of the squared errors
+typedef double (*aa_metrics_convert_kernel)(
+    const uint8_t* frame, const float* reference, size_t count, float* frame_luma,
+    float* reference_luma, float* error);
+
+/// @brief Filters `count` outputs of a row horizontally into the moments
+/// @details Reads `count + 2 * AA_SSIM_RADIUS` inputs, writes the moments
+///          `plane` floats apart
+typedef void (*aa_metrics_blur_kernel)(
+    const float* x, const float* y, size_t count, float* out, size_t plane);
+
+/// @brief Filters the moments of `AA_SSIM_TAPS` rows vertically and sums the
+///        SSIM and contrast-structure terms of `count` pixels
+typedef void (*aa_metrics_ssim_kernel)(
+    const float* const* rows, size_t count, size_t plane, double* ssim,
+    double* cs);
+
+static double aa_metrics_convert_scalar(
+    const uint8_t* frame, const float* reference, size_t count, float* frame_luma,
+    float* reference_luma, float* error)
+{
+  const float NORMALIZE = 1.0f / 255.0f;
+  double sum            = 0.0;
+  for (size_t i = 0; i < count; i++)
+  {
+    float r           = frame[i * 4 + 0] * NORMALIZE;
+    float g           = frame[i * 4 + 1] * NORMALIZE;
+    float b           = frame[i * 4 + 2] * NORMALIZE;
+    const float* ref  = reference + i * 3;
+    frame_luma[i]     = AA_LUMA_R * r + AA_LUMA_G * g + AA_LUMA_B * b;
+    reference_luma[i] = AA_LUMA_R * ref[0] + AA_LUMA_G * ref[1] + AA_LUMA_B * ref[2];
+    float dr          = r - ref[0];
+    float dg          = g - ref[1];
+    float db          = b - ref[2];
+    error[i]          = dr * dr + dg * dg + db * db;
+    sum += error[i];
+  }
+  return sum;
+}
+
+static void aa_metrics_blur_scalar(
+    const float* x, const float* y, size_t count, float* out, size_t plane)
+{
+  for (size_t i = 0; i < count; i++)
+  {
+    float mx = 0.0f, my = 0.0f, xx = 0.0f, yy = 0.0f, xy = 0.0f;
+    for (int k = 0; k < AA_SSIM_TAPS; k++)
+    {
+      float w = AA_SSIM_WEIGHTS[k];
+      float a = x[i + k];
+      float b = y[i + k];
+      mx += w * a;
+      my += w * b;
+      xx += w * a * a;
+      yy += w * b * b;
+      xy += w * a * b;
+    }
+    out[i]             = mx;
+    out[plane + i]     = my;
+    out[plane * 2 + i] = xx;
+    out[plane * 3 + i] = yy;
+    out[plane * 4 + i] = xy;
+  }
+}
+
+static void aa_metrics_ssim_scalar(
+    const float* const* rows, size_t count, size_t plane, double* ssim, double* cs)
+{
+  double ssim_sum = 0.0;
+  double cs_sum   = 0.0;
+  for (size_t i = 0; i < count; i++)
+  {
+    float m[AA_SSIM_MOMENTS] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    for (int k = 0; k < AA_SSIM_TAPS; k++)
+    {
+      for (int p = 0; p < AA_SSIM_MOMENTS; p++)
+        m[p] += AA_SSIM_WEIGHTS[k] * rows[k][plane * p + i];
+    }
+    float sxx       = m[2] - m[0] * m[0];
+    float syy       = m[3] - m[1] * m[1];
+    float sxy       = m[4] - m[0] * m[1];
+    float luminance = (2.0f * m[0] * m[1] + AA_SSIM_C1)
+                      / (m[0] * m[0] + m[1] * m[1] + AA_SSIM_C1);
+    float structure = (2.0f * sxy + AA_SSIM_C2) / (sxx + syy + AA_SSIM_C2);
+    ssim_sum += luminance * structure;
+    cs_sum += structure;
+  }
+  *ssim += ssim_sum;
+  *cs += cs_sum;
+}
+
+#ifdef AA_METRICS_X86
+/// @brief Sums the lanes of a vector
+AA_TARGET_AVX2 static double aa_metrics_sum_avx2(__m256 v)
+{
+  __m128 sum = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  sum        = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum        = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+  return (double)_mm_cvtss_f32(sum);
+}
+
+AA_TARGET_AVX2 static double aa_metrics_convert_avx2(
+    const uint8_t* frame, const float* reference, size_t count, float* frame_luma,
+    float* reference_luma, float* error)
+{
+  const __m256 NORMALIZE = _mm256_set1_ps(1.0f / 255.0f);
+  const __m256i BYTE     = _mm256_set1_epi32(0xFF);
+  const __m256i RGB      = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+  const __m256 LR        = _mm256_set1_ps(AA_LUMA_R);
+  const __m256 LG        = _mm256_set1_ps(AA_LUMA_G);
+  const __m256 LB        = _mm256_set1_ps(AA_LUMA_B);
+  __m256 sum             = _mm256_setzero_ps();
+  size_t i               = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256i texels = _mm256_loadu_si256((const __m256i*)(frame + i * 4));
+    __m256 r = _mm256_mul_ps(
+        _mm256_cvtepi32_ps(_mm256_and_si256(texels, BYTE)), NORMALIZE);
+    __m256 g = _mm256_mul_ps(
+        _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(texels, 8), BYTE)),
+        NORMALIZE);
+    __m256 b = _mm256_mul_ps(
+        _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(texels, 16), BYTE)),
+        NORMALIZE);
+    const float* ref = reference + i * 3;
+    __m256 rr        = _mm256_i32gather_ps(ref, RGB, 4);
+    __m256 rg        = _mm256_i32gather_ps(ref + 1, RGB, 4);
+    __m256 rb        = _mm256_i32gather_ps(ref + 2, RGB, 4);
+
+    __m256 luma =
+        _mm256_fmadd_ps(LB, b, _mm256_fmadd_ps(LG, g, _mm256_mul_ps(LR, r)));
+    _mm256_storeu_ps(frame_luma + i, luma);
+    luma = _mm256_fmadd_ps(LB, rb, _mm256_fmadd_ps(LG, rg, _mm256_mul_ps(LR, rr)));
+    _mm256_storeu_ps(reference_luma + i, luma);
+
+    __m256 dr = _mm256_sub_ps(r, rr);
+    __m256 dg = _mm256_sub_ps(g, rg);
+    __m256 db = _mm256_sub_ps(b, rb);
+    __m256 e =
+        _mm256_fmadd_ps(db, db, _mm256_fmadd_ps(dg, dg, _mm256_mul_ps(dr, dr)));
+    _mm256_storeu_ps(error + i, e);
+    sum = _mm256_add_ps(sum, e);
+  }
+  return aa_metrics_sum_avx2(sum)
+         + aa_metrics_convert_scalar(
+             frame + i * 4, reference + i * 3, count - i, frame_luma + i,
+             reference_luma + i, error + i);
+}
+
+AA_TARGET_AVX2 static void aa_metrics_blur_avx2(
+    const float* x, const float* y, size_t count, float* out, size_t plane)
+{
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256 mx = _mm256_setzero_ps();
+    __m256 my = _mm256_setzero_ps();
+    __m256 xx = _mm256_setzero_ps();
+    __m256 yy = _mm256_setzero_ps();
+    __m256 xy = _mm256_setzero_ps();
+    for (int k = 0; k < AA_SSIM_TAPS; k++)
+    {
+      __m256 w  = _mm256_set1_ps(AA_SSIM_WEIGHTS[k]);
+      __m256 a  = _mm256_loadu_ps(x + i + k);
+      __m256 b  = _mm256_loadu_ps(y + i + k);
+      __m256 wa = _mm256_mul_ps(w, a);
+      __m256 wb = _mm256_mul_ps(w, b);
+      mx        = _mm256_add_ps(mx, wa);
+      my        = _mm256_add_ps(my, wb);
+      xx        = _mm256_fmadd_ps(wa, a, xx);
+      yy        = _mm256_fmadd_ps(wb, b, yy);
+      xy        = _mm256_fmadd_ps(wa, b, xy);
+    }
+    _mm256_storeu_ps(out + i, mx);
+    _mm256_storeu_ps(out + plane + i, my);
+    _mm256_storeu_ps(out + plane * 2 + i, xx);
+    _mm256_storeu_ps(out + plane * 3 + i, yy);
+    _mm256_storeu_ps(out + plane * 4 + i, xy);
+  }
+  aa_metrics_blur_scalar(x + i, y + i, count - i, out + i, plane);
+}
+
+AA_TARGET_AVX2 static void aa_metrics_ssim_avx2(
+    const float* const* rows, size_t count, size_t plane, double* ssim, double* cs)
+{
+  const __m256 C1  = _mm256_set1_ps(AA_SSIM_C1);
+  const __m256 C2  = _mm256_set1_ps(AA_SSIM_C2);
+  const __m256 TWO = _mm256_set1_ps(2.0f);
+  __m256 ssim_sum  = _mm256_setzero_ps();
+  __m256 cs_sum    = _mm256_setzero_ps();
+  size_t i         = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256 m[AA_SSIM_MOMENTS];
+    for (int p = 0; p < AA_SSIM_MOMENTS; p++)
+      m[p] = _mm256_setzero_ps();
+    for (int k = 0; k < AA_SSIM_TAPS; k++)
+    {
+      __m256 w = _mm256_set1_ps(AA_SSIM_WEIGHTS[k]);
+      for (int p = 0; p < AA_SSIM_MOMENTS; p++)
+        m[p] = _mm256_fmadd_ps(w, _mm256_loadu_ps(rows[k] + plane * p + i), m[p]);
+    }
+    __m256 mxy = _mm256_mul_ps(m[0], m[1]);
+    __m256 mxx = _mm256_mul_ps(m[0], m[0]);
+    __m256 myy = _mm256_mul_ps(m[1], m[1]);
+    __m256 sxx = _mm256_sub_ps(m[2], mxx);
+    __m256 syy = _mm256_sub_ps(m[3], myy);
+    __m256 sxy = _mm256_sub_ps(m[4], mxy);
+    __m256 luminance = _mm256_div_ps(
+        _mm256_fmadd_ps(TWO, mxy, C1), _mm256_add_ps(_mm256_add_ps(mxx, myy), C1));
+    __m256 structure = _mm256_div_ps(
+        _mm256_fmadd_ps(TWO, sxy, C2), _mm256_add_ps(_mm256_add_ps(sxx, syy), C2));
+    ssim_sum = _mm256_fmadd_ps(luminance, structure, ssim_sum);
+    cs_sum   = _mm256_add_ps(cs_sum, structure);
+  }
+  *ssim += aa_metrics_sum_avx2(ssim_sum);
+  *cs += aa_metrics_sum_avx2(cs_sum);
+  const float* tail[AA_SSIM_TAPS];
+  for (int k = 0; k < AA_SSIM_TAPS; k++)
+    tail[k] = rows[k] + i;
+  aa_metrics_ssim_scalar(tail, count - i, plane, ssim, cs);
+}
+
+/// @brief Checks that the CPU and the OS support AVX2 and FMA
+static bool aa_metrics_has_avx2(void)
+{
+  #if defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7)
+    return false;
+  __cpuid(info, 1);
+  bool fma     = (info[2] & (1 << 12)) != 0;
+  bool osxsave = (info[2] & (1 << 27)) != 0;
+  __cpuidex(info, 7, 0);
+  bool avx2 = (info[1] & (1 << 5)) != 0;
+  // The OS must save the YMM registers
+  return fma && avx2 && osxsave && (_xgetbv(0) & 6) == 6;
+  #else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  #endif
+}
+#endif
+
+/// @brief The kernels, picked once by `aa_metrics_init`
+static aa_metrics_convert_kernel aa_metrics_convert = aa_metrics_convert_scalar;
+static aa_metrics_blur_kernel aa_metrics_blur       = aa_metrics_blur_scalar;
+static aa_metrics_ssim_kernel aa_metrics_ssim       = aa_metrics_ssim_scalar;
+
+/// @brief A pass over the bands of an image
+typedef struct
+{
+  aa_metrics_context* context;
+  const uint8_t* frame;
+  const float* reference;
+  // Resolution of the current scale
+  int width;
+  int height;
+  uint32_t scale;
+} aa_metrics_pass;
+
+/// @brief Number of tasks covering `rows` rows
+static uint32_t aa_metrics_band_count(int rows)
+{
+  if (rows <= 0)
+    return 0;
+  return (uint32_t)((rows + AA_METRICS_BAND_ROWS - 1) / AA_METRICS_BAND_ROWS);
+}
+
+static void aa_metrics_convert_task(void* argument, uint32_t task, uint32_t worker)
+{
+  (void)worker;
+  aa_metrics_pass* pass       = argument;
+  aa_metrics_context* context = pass->context;
+  size_t width                = (size_t)pass->width;
+  int y0                      = (int)task * AA_METRICS_BAND_ROWS;
+  int y1                      = y0 + AA_METRICS_BAND_ROWS;
+  if (y1 > pass->height)
+    y1 = pass->height;
+  size_t first = (size_t)y0 * width;
+  size_t count = (size_t)(y1 - y0) * width;
+  context->partials[task * 2] = aa_metrics_convert(
+      pass->frame + first * 4, pass->reference + first * 3, count,
+      context->frame_luma[0] + first, context->reference_luma[0] + first,
+      context->error + first);
+  context->partials[task * 2 + 1] = 0.0;
+}
+
+static void aa_metrics_edge_task(void* argument, uint32_t task, uint32_t worker)
+{
+  (void)worker;
+  aa_metrics_pass* pass       = argument;
+  aa_metrics_context* context = pass->context;
+  const int WIDTH             = pass->width;
+  const float THRESHOLD = AA_METRICS_EDGE_THRESHOLD * AA_METRICS_EDGE_THRESHOLD;
+  // The gradient is only defined inside the one pixel border
+  int y0 = 1 + (int)task * AA_METRICS_BAND_ROWS;
+  int y1 = y0 + AA_METRICS_BAND_ROWS;
+  if (y1 > pass->height - 1)
+    y1 = pass->height - 1;
+
+  double error = 0.0;
+  double count = 0.0;
+  for (int y = y0; y < y1; y++)
+  {
+    const float* up   = context->reference_luma[0] + (size_t)(y + 1) * WIDTH;
+    const float* row  = context->reference_luma[0] + (size_t)y * WIDTH;
+    const float* down = context->reference_luma[0] + (size_t)(y - 1) * WIDTH;
+    const float* e    = context->error + (size_t)y * WIDTH;
+    // Branch free, so that the compiler vectorises it
+    float row_error = 0.0f;
+    float row_count = 0.0f;
+    for (int x = 1; x < WIDTH - 1; x++)
+    {
+      float gx = (up[x + 1] + 2.0f * row[x + 1] + down[x + 1])
+                 - (up[x - 1] + 2.0f * row[x - 1] + down[x - 1]);
+      float gy = (up[x - 1] + 2.0f * up[x] + up[x + 1])
+                 - (down[x - 1] + 2.0f * down[x] + down[x + 1]);
+      float edge = (gx * gx + gy * gy) > THRESHOLD ? 1.0f : 0.0f;
+      row_error += edge * e[x];
+      row_count += edge;
+    }
+    error += row_error;
+    count += row_count;
+  }
+  context->partials[task * 2]     = error;
+  context->partials[task * 2 + 1] = count;
+}
+
+static void aa_metrics_ssim_task(void* argument, uint32_t task, uint32_t worker)
+{
+  aa_metrics_pass* pass       = argument;
+  aa_metrics_context* context = pass->context;
+  const int R                 = AA_SSIM_RADIUS;
+  const size_t WIDTH          = (size_t)pass->width;
+  // Only the pixels where the window fits are scored
+  const size_t PLANE = WIDTH - 2 * R;
+  const float* x     = context->frame_luma[pass->scale];
+  const float* y     = context->reference_luma[pass->scale];
+  float* ring        = context->scratch + context->scratch_stride * worker;
+
+  int y0 = R + (int)task * AA_METRICS_BAND_ROWS;
+  int y1 = y0 + AA_METRICS_BAND_ROWS;
+  if (y1 > pass->height - R)
+    y1 = pass->height - R;
+
+  // Horizontally filtered rows, `row % AA_SSIM_TAPS` is the slot of `row`
+  for (int row = y0 - R; row < y0 + R; row++)
+  {
+    aa_metrics_blur(
+        x + row * WIDTH, y + row * WIDTH, PLANE,
+        ring + (size_t)(row % AA_SSIM_TAPS) * PLANE * AA_SSIM_MOMENTS, PLANE);
+  }
+  double ssim = 0.0;
+  double cs   = 0.0;
+  for (int row = y0; row < y1; row++)
+  {
+    int last = row + R;
+    aa_metrics_blur(
+        x + last * WIDTH, y + last * WIDTH, PLANE,
+        ring + (size_t)(last % AA_SSIM_TAPS) * PLANE * AA_SSIM_MOMENTS, PLANE);
+    const float* rows[AA_SSIM_TAPS];
+    for (int k = 0; k < AA_SSIM_TAPS; k++)
+    {
+      int slot = (row - R + k) % AA_SSIM_TAPS;
+      rows[k]  = ring + (size_t)slot * PLANE * AA_SSIM_MOMENTS;
+    }
+    aa_metrics_ssim(rows, PLANE, PLANE, &ssim, &cs);
+  }
+  context->partials[task * 2]     = ssim;
+  context->partials[task * 2 + 1] = cs;
+}
+
+static void aa_metrics_downsample_task(
+    void* argument, uint32_t task, uint32_t worker)
+{
+  (void)worker;
+  aa_metrics_pass* pass       = argument;
+  aa_metrics_context* context = pass->context;
+  // `pass` describes the source scale
+  const size_t SRC_WIDTH = (size_t)pass->width;
+  const int WIDTH        = pass->width / 2;
+  int y0                 = (int)task * AA_METRICS_BAND_ROWS;
+  int y1                 = y0 + AA_METRICS_BAND_ROWS;
+  if (y1 > pass->height / 2)
+    y1 = pass->height / 2;
+
+  for (int image = 0; image < 2; image++)
+  {
+    const float* src = image ? context->reference_luma[pass->scale]
+                             : context->frame_luma[pass->scale];
+    float* dst = image ? context->reference_luma[pass->scale + 1]
+                       : context->frame_luma[pass->scale + 1];
+    for (int y = y0; y < y1; y++)
+    {
+      const float* a = src + (size_t)(2 * y) * SRC_WIDTH;
+      const float* b = a + SRC_WIDTH;
+      float* out     = dst + (size_t)y * WIDTH;
+      for (int x = 0; x < WIDTH; x++)
+        out[x] = 0.25f * (a[2 * x] + a[2 * x + 1] + b[2 * x] + b[2 * x + 1]);
+    }
+  }
+}
+
+/// @brief Sums the partial results of the tasks of a pass
+static void aa_metrics_reduce(
+    const aa_metrics_context* context, uint32_t task_count, double out[2])
+{
+  out[0] = 0.0;
+  out[1] = 0.0;
+  // In task order, so the result does not depend on the scheduling
+  for (uint32_t i = 0; i < task_count; i++)
+  {
+    out[0] += context->partials[i * 2];
+    out[1] += context->partials[i * 2 + 1];
+  }
+}
+
+static double aa_metrics_psnr(double mse)
+{
+  if (mse <= 0.0)
+    return AA_METRICS_PSNR_MAX;
+  double psnr = -10.0 * log10(mse);
+  return psnr < AA_METRICS_PSNR_MAX ? psnr : AA_METRICS_PSNR_MAX;
+}
+
+int aa_metrics_init(aa_metrics_context* context, uint32_t thread_count)
+{
+  memset(context, 0, sizeof(aa_metrics_context));
+  // Still usable with fewer threads
+  aa_thread_pool_init(&context->pool, thread_count);
+  if (context->pool.shared == NULL)
+    return -1;
+#ifdef AA_METRICS_X86
+  context->avx2 = aa_metrics_has_avx2();
+  if (context->avx2)
+  {
+    aa_metrics_convert = aa_metrics_convert_avx2;
+    aa_metrics_blur    = aa_metrics_blur_avx2;
+    aa_metrics_ssim    = aa_metrics_ssim_avx2;
+  }
+#endif
+  context->initialized = true;
+  return 0;
+}
+
+/// @brief Sizes the buffers for a resolution
+/// @return 0 on success, -1 on allocation failure
+static int aa_metrics_resize(aa_metrics_context* context, int width, int height)
+{
+  if (context->width == width && context->height == height)
+    return 0;
+  for (uint32_t i = 0; i < AA_METRICS_MAX_SCALES; i++)
+  {
+    free(context->frame_luma[i]);
+    free(context->reference_luma[i]);
+    context->frame_luma[i]     = NULL;
+    context->reference_luma[i] = NULL;
+  }
+  free(context->error);
+  free(context->scratch);
+  free(context->partials);
+  context->error    = NULL;
+  context->scratch  = NULL;
+  context->partials = NULL;
+  context->width    = 0;
+  context->height   = 0;
+  if (width <= 0 || height <= 0)
+    return 0;
+
+  int w = width;
+  int h = height;
+  for (uint32_t i = 0; i < AA_METRICS_MAX_SCALES && w > 0 && h > 0; i++)
+  {
+    context->frame_luma[i]     = malloc((size_t)w * h * sizeof(float));
+    context->reference_luma[i] = malloc((size_t)w * h * sizeof(float));
+    if (context->frame_luma[i] == NULL || context->reference_luma[i] == NULL)
+      return -1;
+    w /= 2;
+    h /= 2;
+  }
+  size_t plane = width > 2 * AA_SSIM_RADIUS ? width - 2 * AA_SSIM_RADIUS : 1;
+  context->scratch_stride = plane * AA_SSIM_MOMENTS * AA_SSIM_TAPS;
+  context->error          = malloc((size_t)width * height * sizeof(float));
+  context->scratch        = malloc(
+      context->scratch_stride * context->pool.worker_count * sizeof(float));
+  context->partials = malloc(aa_metrics_band_count(height) * 2 * sizeof(double));
+  if (context->error == NULL || context->scratch == NULL
+      || context->partials == NULL)
+    return -1;
+  context->width  = width;
+  context->height = height;
+  return 0;
+}
+
+int aa_metrics_compute(
+    aa_metrics_context* context, const uint8_t* frame, const float* reference,
+    int width, int height, aa_metrics* out)
+{
+  uint64_t begin_ns = aa_clock_ns();
+  out->psnr         = -1.0;
+  out->ssim         = -1.0;
+  out->ms_ssim      = -1.0;
+  out->edge_psnr    = -1.0;
+  if (width <= 0 || height <= 0 || aa_metrics_resize(context, width, height) != 0)
+    return -1;
+
+  aa_metrics_pass pass;
+  pass.context   = context;
+  pass.frame     = frame;
+  pass.reference = reference;
+  pass.width     = width;
+  pass.height    = height;
+  pass.scale     = 0;
+  double sums[2];
+  size_t pixel_count = (size_t)width * height;
+
+  uint32_t tasks = aa_metrics_band_count(height);
+  aa_thread_pool_run(&context->pool, aa_metrics_convert_task, &pass, tasks);
+  aa_metrics_reduce(context, tasks, sums);
+  out->psnr = aa_metrics_psnr(sums[0] / (double)(pixel_count * 3));
+
+  tasks = aa_metrics_band_count(height - 2);
+  aa_thread_pool_run(&context->pool, aa_metrics_edge_task, &pass, tasks);
+  aa_metrics_reduce(context, tasks, sums);
+  out->edge_fraction = sums[1] / (double)pixel_count;
+  out->edge_psnr     = AA_METRICS_PSNR_MAX;
+  if (sums[1] > 0.0)
+    out->edge_psnr = aa_metrics_psnr(sums[0] / (sums[1] * 3.0));
+
+  // Scales where the window still fits
+  uint32_t scale_count = 0;
+  for (int w = width, h = height;
+       scale_count < AA_METRICS_MAX_SCALES && w >= AA_SSIM_TAPS && h >= AA_SSIM_TAPS;
+       w /= 2, h /= 2)
+    scale_count++;
+
+  double weight_sum = 0.0;
+  for (uint32_t i = 0; i < scale_count; i++)
+    weight_sum += AA_MS_SSIM_WEIGHTS[i];
+  double ms_ssim = 1.0;
+  for (uint32_t scale = 0; scale < scale_count; scale++)
+  {
+    pass.scale = scale;
+    tasks      = aa_metrics_band_count(pass.height - 2 * AA_SSIM_RADIUS);
+    aa_thread_pool_run(&context->pool, aa_metrics_ssim_task, &pass, tasks);
+    aa_metrics_reduce(context, tasks, sums);
+    double count = (double)(pass.width - 2 * AA_SSIM_RADIUS)
+                   * (double)(pass.height - 2 * AA_SSIM_RADIUS);
+    double ssim = sums[0] / count;
+    double cs   = sums[1] / count;
+    if (scale == 0)
+      out->ssim = ssim;
+    // The contrast-structure term of every scale, the full SSIM of the last
+    double term   = scale + 1 == scale_count ? ssim : cs;
+    double weight = AA_MS_SSIM_WEIGHTS[scale] / weight_sum;
+    ms_ssim *= pow(term > 0.0 ? term : 0.0, weight);
+
+    if (scale + 1 < scale_count)
+    {
+      tasks = aa_metrics_band_count(pass.height / 2);
+      aa_thread_pool_run(&context->pool, aa_metrics_downsample_task, &pass, tasks);
+      pass.width /= 2;
+      pass.height /= 2;
+    }
+  }
+  if (scale_count > 0)
+    out->ms_ssim = ms_ssim;
+
+  context->last_duration_ns = aa_clock_ns() - begin_ns;
+  return 0;
+}
+
+void aa_metrics_delete(aa_metrics_context* context)
+{
+  if (!context->initialized)
+    return;
+  aa_thread_pool_delete(&context->pool);
+  // Frees every buffer
+  aa_metrics_resize(context, 0, 0);
+  context->initialized = false;
+}
@@ -0,0 +1,91 @@
+#ifndef __AA_HG_METRICS
+#define __AA_HG_METRICS
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "thread_pool.h"
+
+// Full-reference image-quality metrics, on the CPU
+// A frame read back from the GPU (RGBA8) is compared with a reference image
+// (RGB floats in [0, 1], see `reference.h`), both bottom row first:
+// - PSNR over the RGB channels,
+// - SSIM of the luma, with the usual 11x11 Gaussian window (sigma 1.5),
+//   averaged over the pixels where the window fits,
+// - MS-SSIM over up to 5 scales (halving the resolution each time, with the
+//   weights of Wang et al.), fewer if the image gets smaller than the window,
+// - edge PSNR: the PSNR restricted to the pixels where the Sobel gradient of
+//   the reference luma exceeds `AA_METRICS_EDGE_THRESHOLD`, i.e. where
+//   anti-aliasing actually happens.
+// Every pass runs on bands of rows spread over a thread pool, and the inner
+// loops use AVX2/FMA when the CPU supports it (checked at runtime).
+
+/// @brief PSNR reported for identical images (dB)
+#define AA_METRICS_PSNR_MAX 99.0
+/// @brief Sobel gradient magnitude of the reference luma above which a pixel
+///        is an edge (a step of about 0.1)
+#define AA_METRICS_EDGE_THRESHOLD 0.4f
+/// @brief Maximum number of MS-SSIM scales
+#define AA_METRICS_MAX_SCALES 5
+/// @brief Number of rows in a task
+#define AA_METRICS_BAND_ROWS 64
+
+/// @brief Scores of a frame
+typedef struct
+{
+  // dB, negative if not measured
+  double psnr;
+  // In [-1, 1], 1 for identical images, negative if not measured
+  double ssim;
+  double ms_ssim;
+  // dB, `AA_METRICS_PSNR_MAX` if the reference has no edge
+  double edge_psnr;
+  // Fraction of the pixels that are edges
+  double edge_fraction;
+} aa_metrics;
+
+typedef struct
+{
+  aa_thread_pool pool;
+  bool initialized;
+  // True if the AVX2/FMA kernels are used
+  bool avx2;
+  // Resolution the buffers are allocated for
+  int width;
+  int height;
+  // Luma of the frame and of the reference, at every scale
+  float* frame_luma[AA_METRICS_MAX_SCALES];
+  float* reference_luma[AA_METRICS_MAX_SCALES];
+  // Squared RGB error of every pixel
+  float* error;
+  // Rows of Gaussian-filtered moments, per worker
+  float* scratch;
+  size_t scratch_stride;
+  // Partial sums, per task
+  double* partials;
+  // Duration of the last `aa_metrics_compute`
+  uint64_t last_duration_ns;
+} aa_metrics_context;
+
+/// @brief Starts the thread pool and picks the kernels
+/// @param context The context
+/// @param thread_count Number of threads, 0 for one per logical processor
+/// @return 0 on success, -1 on failure
+int aa_metrics_init(aa_metrics_context* context, uint32_t thread_count);
+
+/// @brief Scores a frame against a reference
+/// @param context The context (buffers grow with the resolution)
+/// @param frame RGBA8 pixels
+/// @param reference RGB floats
+/// @param width Width of both images
+/// @param height Height of both images
+/// @param out The scores
+/// @return 0 on success, -1 on allocation failure
+int aa_metrics_compute(
+    aa_metrics_context* context, const uint8_t* frame, const float* reference,
+    int width, int height, aa_metrics* out);
+
+/// @brief Stops the thread pool and releases the buffers
+void aa_metrics_delete(aa_metrics_context* context);
+
+#endif // !__AA_HG_METRICS
@@ -0,0 +1,121 @@
+#include "quality.h"
+#include "scene.h"
+#include "cpu/raster.h"
+#include <stdlib.h>
+
+/// @brief Computes the reference of the current scene from its exact coverage
+static const float* aa_quality_reference_exact(AppState* state)
+{
+  const int WIDTH    = state->window_width;
+  const int HEIGHT   = state->window_height;
+  size_t pixel_count = (size_t)WIDTH * HEIGHT;
+  uint32_t vertex_count;
+  float* vertices = aa_scene_vertices(state, &vertex_count);
+  float* coverage = malloc(pixel_count * sizeof(float));
+  float* image    = malloc(pixel_count * 3 * sizeof(float));
+  // The tiles run on the threads of the metrics
+  aa_thread_pool* pool = state->metrics.initialized ? &state->metrics.pool : NULL;
+  if (vertices == NULL || coverage == NULL || image == NULL
+      || aa_cpu_raster_coverage(
+             pool, vertices, vertex_count, WIDTH, HEIGHT, coverage)
+             != 0)
+  {
+    free(vertices);
+    free(coverage);
+    free(image);
+    return NULL;
+  }
+
+  // A box-filtered pixel blends the colours in proportion to their areas
+  for (size_t i = 0; i < pixel_count; i++)
+  {
+    float c          = coverage[i];
+    image[i * 3 + 0] = AA_SCENE_BACKGROUND_R
+                     + c * (AA_SCENE_FOREGROUND_R - AA_SCENE_BACKGROUND_R);
+    image[i * 3 + 1] = AA_SCENE_BACKGROUND_G
+                     + c * (AA_SCENE_FOREGROUND_G - AA_SCENE_BACKGROUND_G);
+    image[i * 3 + 2] = AA_SCENE_BACKGROUND_B
+                     + c * (AA_SCENE_FOREGROUND_B - AA_SCENE_BACKGROUND_B);
+  }
+  free(vertices);
+  free(coverage);
+  return aa_reference_store(
+      &state->reference, (uint32_t)state->current_scene, WIDTH, HEIGHT, image);
+}
+
+const float* aa_quality_reference(AppState* state)
+{
+  uint32_t scene     = (uint32_t)state->current_scene;
+  const float* image = aa_reference_image(
+      &state->reference, scene, state->window_width, state->window_height);
+  if (image != NULL)
+    return image;
+  if (state->reference.exact)
+    return aa_quality_reference_exact(state);
+
+  if (aa_reference_begin(
+          &state->reference, state->window_width, state->window_height)
+      != 0)
+    return NULL;
+  // Only the default program draws the scenes
+  GLint jitter_location = glGetUniformLocation(state->program.id, "u_jitter");
+  float jitter[2];
+  while (aa_reference_pass(&state->reference, jitter))
+  {
+    glCall(glProgramUniform2f(
+        state->program.id, jitter_location, jitter[0], jitter[1]));
+    glClearColor(
+        AA_SCENE_BACKGROUND_R, AA_SCENE_BACKGROUND_G, AA_SCENE_BACKGROUND_B, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    aa_scene_render(state);
+  }
+  glCall(glProgramUniform2f(state->program.id, jitter_location, 0.0f, 0.0f));
+  return aa_reference_end(&state->reference, scene);
+}
+
+int aa_quality_capture(AppState* state)
+{
+  return aa_readback_capture(
+      &state->readback, state->default_fbo.id, state->window_width,
+      state->window_height, state->frame_count);
+}
+
+bool aa_quality_collect(AppState* state, bool wait)
+{
+  if (aa_readback_pending(&state->readback) == 0)
+    return true;
+  const aa_readback_frame* frame = aa_readback_acquire(&state->readback, wait);
+  if (frame == NULL)
+    return false;
+
+  state->last_quality.psnr = -1.0;
+  if (!state->metrics.initialized)
+    aa_metrics_init(&state->metrics, 0);
+  // A spinning scene is scored against a reference posed like the captured
+  // frame, which is not kept
+  const uint32_t SCENE = (uint32_t)state->current_scene;
+  const bool SPINNING  = state->scene_parameters.spin != 0.0f;
+  const uint64_t POSE  = state->scene_frame;
+  if (SPINNING)
+  {
+    state->scene_frame = frame->tag;
+    aa_reference_forget(&state->reference, SCENE);
+  }
+  // Rendering the reference does not touch the pack buffers of the ring
+  const float* reference = aa_quality_reference(state);
+  if (state->metrics.initialized && reference != NULL
+      && frame->width == state->window_width
+      && frame->height == state->window_height)
+  {
+    aa_metrics_compute(
+        &state->metrics, frame->pixels, reference, frame->width, frame->height,
+        &state->last_quality);
+  }
+  if (SPINNING)
+  {
+    state->scene_frame = POSE;
+    aa_reference_forget(&state->reference, SCENE);
+  }
+  aa_readback_release(&state->readback);
+  return true;
+}
@@ -0,0 +1,33 @@
+#ifndef __AA_HG_QUALITY
+#define __AA_HG_QUALITY
+
+#include <stddef.h>
+#include <stdint.h>
+#include "appstate.h"
+
+// Image quality of the displayed frame, measured against a supersampled (or
+// exact) reference of the same scene (see `reference.h`)
+
+/// @brief Returns the reference image of the current scene, rendering it on
+///        first use (outside of any timed section)
+/// @return The image (RGB floats, bottom row first), or NULL on failure
+const float* aa_quality_reference(AppState* state);
+
+/// @brief Queues a readback of the frame drawn in the default framebuffer
+/// @details Does not wait for the GPU (see `gl/readback.h`), the frame is
+///          scored by `aa_quality_collect` a few frames later
+/// @return 0 on success, -1 if too many captures are pending
+int aa_quality_capture(AppState* state);
+
+/// @brief Scores the oldest capture into `last_quality` (see `metrics.h`)
+///        once the GPU wrote it
+/// @details The reference of the current scene is rendered on first use, so
+///          call it before switching scenes
+/// @param state The application state
+/// @param wait If true, blocks until the capture is available
+/// @return false while the capture is still in flight, true once it was
+///         scored (or if there is none, or scoring failed: `psnr` is then
+///         negative)
+bool aa_quality_collect(AppState* state, bool wait);
+
+#endif // !__AA_HG_QUALITY
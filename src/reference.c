@@ -0,0 +1,228 @@
+#include "reference.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const float* aa_reference_image(
+    const aa_reference* reference, uint32_t scene, int width, int height)
+{
+  if (scene >= AA_REFERENCE_MAX_SCENES || reference->width != width
+      || reference->height != height)
+    return NULL;
+  return reference->images[scene];
+}
+
+/// @brief Drops the cached images if the resolution changed
+static void aa_reference_resize(aa_reference* reference, int width, int height)
+{
+  if (reference->width == width && reference->height == height)
+    return;
+  for (uint32_t i = 0; i < AA_REFERENCE_MAX_SCENES; i++)
+  {
+    free(reference->images[i]);
+    reference->images[i] = NULL;
+  }
+  reference->width  = width;
+  reference->height = height;
+}
+
+int aa_reference_begin(aa_reference* reference, int width, int height)
+{
+  aa_reference_resize(reference, width, height);
+  if (reference->scale == 0)
+    reference->scale = AA_REFERENCE_DEFAULT_SCALE;
+
+  const uint32_t SCALE = reference->scale;
+  GLint max_size;
+  GLint max_viewport[2];
+  glCall(glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size));
+  glCall(glGetIntegerv(GL_MAX_VIEWPORT_DIMS, max_viewport));
+  int64_t ss_width  = (int64_t)width * SCALE;
+  int64_t ss_height = (int64_t)height * SCALE;
+  bool fits         = ss_width <= max_size && ss_height <= max_size
+              && ss_width <= max_viewport[0] && ss_height <= max_viewport[1];
+
+  int target_width  = width;
+  int target_height = height;
+  size_t rows       = (size_t)height;
+  if (fits && !reference->force_accumulation)
+  {
+    reference->method     = AA_REFERENCE_SUPERSAMPLED;
+    reference->pass_count = 1;
+    target_width          = (int)ss_width;
+    target_height         = (int)ss_height;
+    // Read back one band of `SCALE` rows at a time
+    rows = SCALE;
+  }
+  else
+  {
+    reference->method     = AA_REFERENCE_ACCUMULATED;
+    reference->pass_count = SCALE * SCALE;
+  }
+  reference->pass = 0;
+
+  reference->sums   = calloc((size_t)width * height * 3, sizeof(uint32_t));
+  reference->pixels = malloc((size_t)target_width * rows * 4);
+  if (reference->sums == NULL || reference->pixels == NULL)
+  {
+    free(reference->sums);
+    free(reference->pixels);
+    reference->sums   = NULL;
+    reference->pixels = NULL;
+    return -1;
+  }
+
+  aa_frame_buffer_create(&reference->fbo);
+  aa_texture_create(&reference->texture, target_width, target_height);
+  aa_frame_buffer_color_texture(&reference->fbo, &reference->texture);
+  return 0;
+}
+
+/// @brief Adds the supersampled target, box-filtered, to the sums
+static void aa_reference_collect_supersampled(aa_reference* reference)
+{
+  const uint32_t SCALE = reference->scale;
+  const int WIDTH      = reference->width;
+  const int SS_WIDTH   = WIDTH * (int)SCALE;
+  for (int y = 0; y < reference->height; y++)
+  {
+    glCall(glReadPixels(
+        0, y * (int)SCALE, SS_WIDTH, (GLsizei)SCALE, GL_RGBA, GL_UNSIGNED_BYTE,
+        reference->pixels));
+    uint32_t* sum = reference->sums + (size_t)y * WIDTH * 3;
+    for (int x = 0; x < WIDTH; x++, sum += 3)
+    {
+      for (uint32_t sy = 0; sy < SCALE; sy++)
+      {
+        const uint8_t* texel =
+            reference->pixels + ((size_t)sy * SS_WIDTH + (size_t)x * SCALE) * 4;
+        for (uint32_t sx = 0; sx < SCALE; sx++, texel += 4)
+        {
+          sum[0] += texel[0];
+          sum[1] += texel[1];
+          sum[2] += texel[2];
+        }
+      }
+    }
+  }
+}
+
+/// @brief Adds a jittered pass to the sums
+static void aa_reference_collect_accumulated(aa_reference* reference)
+{
+  size_t pixel_count = (size_t)reference->width * reference->height;
+  glCall(glReadPixels(
+      0, 0, reference->width, reference->height, GL_RGBA, GL_UNSIGNED_BYTE,
+      reference->pixels));
+  for (size_t i = 0; i < pixel_count; i++)
+  {
+    reference->sums[i * 3 + 0] += reference->pixels[i * 4 + 0];
+    reference->sums[i * 3 + 1] += reference->pixels[i * 4 + 1];
+    reference->sums[i * 3 + 2] += reference->pixels[i * 4 + 2];
+  }
+}
+
+/// @brief Reads back the pass that was just drawn
+static void aa_reference_collect(aa_reference* reference)
+{
+  glCall(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+  if (reference->method == AA_REFERENCE_SUPERSAMPLED)
+    aa_reference_collect_supersampled(reference);
+  else
+    aa_reference_collect_accumulated(reference);
+}
+
+bool aa_reference_pass(aa_reference* reference, float jitter[2])
+{
+  if (reference->pass > 0)
+    aa_reference_collect(reference);
+  if (reference->pass == reference->pass_count)
+    return false;
+
+  const uint32_t SCALE = reference->scale;
+  jitter[0]            = 0.0f;
+  jitter[1]            = 0.0f;
+  aa_frame_buffer_bind(&reference->fbo);
+  if (reference->method == AA_REFERENCE_SUPERSAMPLED)
+  {
+    glViewport(
+        0, 0, reference->width * (int)SCALE, reference->height * (int)SCALE);
+  }
+  else
+  {
+    // Moving the scene by `d` pixels moves the pixel centres by `-d`: the
+    // centres land on the sample positions of the supersampled grid
+    uint32_t sx = reference->pass % SCALE;
+    uint32_t sy = reference->pass / SCALE;
+    float dx    = 0.5f - ((float)sx + 0.5f) / (float)SCALE;
+    float dy    = 0.5f - ((float)sy + 0.5f) / (float)SCALE;
+    jitter[0]   = dx * 2.0f / (float)reference->width;
+    jitter[1]   = dy * 2.0f / (float)reference->height;
+    glViewport(0, 0, reference->width, reference->height);
+  }
+  reference->pass++;
+  return true;
+}
+
+const float* aa_reference_end(aa_reference* reference, uint32_t scene)
+{
+  float* image       = NULL;
+  size_t value_count = (size_t)reference->width * reference->height * 3;
+  // Every pass must have been drawn and collected
+  if (scene < AA_REFERENCE_MAX_SCENES && reference->sums != NULL
+      && reference->pass == reference->pass_count)
+    image = malloc(value_count * sizeof(float));
+
+  if (image != NULL)
+  {
+    const float NORMALIZE =
+        1.0f / (255.0f * (float)(reference->scale * reference->scale));
+    for (size_t i = 0; i < value_count; i++)
+      image[i] = (float)reference->sums[i] * NORMALIZE;
+    free(reference->images[scene]);
+    reference->images[scene] = image;
+  }
+  free(reference->sums);
+  free(reference->pixels);
+  reference->sums   = NULL;
+  reference->pixels = NULL;
+
+  // The target is only needed while rendering
+  aa_frame_buffer_delete(&reference->fbo);
+  aa_texture_delete(&reference->texture);
+  glCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+  glViewport(0, 0, reference->width, reference->height);
+  return image;
+}
+
+const float* aa_reference_store(
+    aa_reference* reference, uint32_t scene, int width, int height,
+    float* image)
+{
+  if (scene >= AA_REFERENCE_MAX_SCENES)
+  {
+    free(image);
+    return NULL;
+  }
+  aa_reference_resize(reference, width, height);
+  free(reference->images[scene]);
+  reference->images[scene] = image;
+  return image;
+}
+
+void aa_reference_forget(aa_reference* reference, uint32_t scene)
+{
+  if (scene >= AA_REFERENCE_MAX_SCENES)
+    return;
+  free(reference->images[scene]);
+  reference->images[scene] = NULL;
+}
+
+void aa_reference_delete(aa_reference* reference)
+{
+  for (uint32_t i = 0; i < AA_REFERENCE_MAX_SCENES; i++)
+  {
+    free(reference->images[i]);
+    reference->images[i] = NULL;
+  }
+}
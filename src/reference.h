@@ -0,0 +1,108 @@
+#ifndef __AA_HG_REFERENCE
+#define __AA_HG_REFERENCE
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "gl/frame_buffer.h"
+
+// Supersampled reference images, the ground truth of image-quality metrics
+// Each pixel of a reference is the box-filtered average of `scale` x `scale`
+// samples on a regular grid, obtained in one of two ways:
+// - supersampled: the scene is drawn once into an offscreen target `scale`
+//   times larger on each axis than the window, read back and downsampled,
+// - accumulated: the scene is drawn `scale` x `scale` times at the window
+//   resolution, each time shifted by a sub-pixel jitter so that the pixel
+//   centres land on the positions of the grid, and the passes are averaged.
+// Both produce the same image; accumulation is used when the supersampled
+// target would not fit in GL_MAX_TEXTURE_SIZE (64 samples at 1440p), or when
+// requested.
+// Exact references skip the GPU entirely: the coverage of every pixel is
+// computed analytically from the scene geometry (see `cpu/raster.h`) and
+// handed over with `aa_reference_store`.
+// Images are cached per scene until the resolution changes.
+//
+// Usage:
+//     aa_reference_begin(&reference, width, height);
+//     float jitter[2];
+//     while (aa_reference_pass(&reference, jitter))
+//       clear, then draw the scene offset by `jitter` (clip space)
+//     image = aa_reference_end(&reference, scene);
+
+/// @brief Maximum number of scenes with a cached reference
+#define AA_REFERENCE_MAX_SCENES 8
+/// @brief Default number of samples per axis (16 samples per pixel)
+#define AA_REFERENCE_DEFAULT_SCALE 4
+
+typedef enum
+{
+  AA_REFERENCE_SUPERSAMPLED,
+  AA_REFERENCE_ACCUMULATED
+} aa_reference_method;
+
+typedef struct
+{
+  // Samples per axis (4 gives 16 samples per pixel, 8 gives 64), 0 for the
+  // default
+  uint32_t scale;
+  // Always accumulate jittered passes, even if the supersampled target fits
+  bool force_accumulation;
+  // Compute the images from exact coverage on the CPU instead of sampling
+  bool exact;
+  // Resolution of the images
+  int width;
+  int height;
+  // Linear RGB in [0, 1], bottom row first (like `glReadPixels`), or NULL
+  float* images[AA_REFERENCE_MAX_SCENES];
+  // State of the image being rendered
+  aa_reference_method method;
+  uint32_t pass;
+  uint32_t pass_count;
+  // Sums of the accumulated passes (RGB)
+  uint32_t* sums;
+  // Read back rows
+  uint8_t* pixels;
+  // Offscreen target, allocated while an image is rendered
+  aa_frame_buffer fbo;
+  aa_texture texture;
+} aa_reference;
+
+/// @brief Returns the cached image of a scene, or NULL if it must be rendered
+const float* aa_reference_image(
+    const aa_reference* reference, uint32_t scene, int width, int height);
+
+/// @brief Prepares the rendering of a reference image
+/// @details Drops the cached images if the resolution changed, and picks the
+///          method
+/// @return 0 on success, -1 on allocation failure
+int aa_reference_begin(aa_reference* reference, int width, int height);
+
+/// @brief Binds the target of the next pass
+/// @details Collects the previous pass first. The scene must be drawn shifted
+///          by `jitter`, in clip space (zero for a supersampled pass).
+/// @param reference The reference
+/// @param jitter Receives the offset of the pass
+/// @return false once every pass was drawn
+bool aa_reference_pass(aa_reference* reference, float jitter[2]);
+
+/// @brief Collects the last pass and stores the image of a scene
+/// @details Binds the default framebuffer and restores the window viewport
+/// @return The image, or NULL on failure
+const float* aa_reference_end(aa_reference* reference, uint32_t scene);
+
+/// @brief Stores an image computed elsewhere (e.g. an exact one) as the image
+///        of a scene
+/// @details Drops the cached images if the resolution changed. The reference
+///          takes ownership of `image` (allocated with `malloc`).
+/// @return The image
+const float* aa_reference_store(
+    aa_reference* reference, uint32_t scene, int width, int height,
+    float* image);
+
+/// @brief Drops the cached image of a scene (e.g. when its geometry changed)
+void aa_reference_forget(aa_reference* reference, uint32_t scene);
+
+/// @brief Releases the images and the target
+void aa_reference_delete(aa_reference* reference);
+
+#endif // !__AA_HG_REFERENCE
@@ -0,0 +1,106 @@
+#include "resolve.h"
+#include <math.h>
+#include <string.h>
+#include <glad/glad.h>
+
+#ifndef M_PI
+  #define M_PI 3.14159265358979323846
+#endif
+
+static const char* const AA_RESOLVE_FILTER_NAMES[] = {
+    "box", "tent", "blackman_harris"};
+
+const char* aa_resolve_filter_name(aa_resolve_filter filter)
+{
+  if ((unsigned)filter >= AA_RESOLVE_FILTER_COUNT)
+    return "?";
+  return AA_RESOLVE_FILTER_NAMES[filter];
+}
+
+int aa_resolve_filter_find(const char* name)
+{
+  for (int i = 0; i < AA_RESOLVE_FILTER_COUNT; i++)
+  {
+    if (strcmp(AA_RESOLVE_FILTER_NAMES[i], name) == 0)
+      return i;
+  }
+  return -1;
+}
+
+float aa_resolve_filter_radius(aa_resolve_filter filter)
+{
+  switch (filter)
+  {
+  case AA_RESOLVE_TENT:
+    return AA_RESOLVE_TENT_RADIUS;
+  case AA_RESOLVE_BLACKMAN_HARRIS:
+    return AA_RESOLVE_BLACKMAN_HARRIS_RADIUS;
+  default:
+    return AA_RESOLVE_BOX_RADIUS;
+  }
+}
+
+/// @brief Weight of a sample at (`x`, `y`) from the pixel centre, in pixels
+static float aa_resolve_filter_weight(
+    aa_resolve_filter filter, float radius, float x, float y)
+{
+  if (filter == AA_RESOLVE_TENT)
+    return fmaxf(1.0f - fabsf(x) / radius, 0.0f)
+           * fmaxf(1.0f - fabsf(y) / radius, 0.0f);
+  if (filter == AA_RESOLVE_BLACKMAN_HARRIS)
+  {
+    float distance = sqrtf(x * x + y * y);
+    if (distance >= radius)
+      return 0.0f;
+    // The window spans [-radius, radius], peaking in its middle
+    double t = 2.0 * M_PI * (0.5 + 0.5 * distance / radius);
+    return (float)(0.35875 - 0.48829 * cos(t) + 0.14128 * cos(2.0 * t)
+                   - 0.01168 * cos(3.0 * t));
+  }
+  return fabsf(x) <= radius && fabsf(y) <= radius ? 1.0f : 0.0f;
+}
+
+void aa_resolve_table_positions(aa_resolve_table* table)
+{
+  GLint count = 0;
+  glGetIntegerv(GL_SAMPLES, &count);
+  if (count > AA_RESOLVE_MAX_SAMPLES)
+    count = AA_RESOLVE_MAX_SAMPLES;
+  for (GLint i = 0; i < count; i++)
+    glGetMultisamplefv(GL_SAMPLE_POSITION, (GLuint)i, table->positions[i]);
+  table->samples = count;
+  table->filter  = -1;
+}
+
+void aa_resolve_table_filter(aa_resolve_table* table, aa_resolve_filter filter)
+{
+  if (table->filter == (int)filter)
+    return;
+  const int COUNT = table->samples;
+  float* out      = table->weights;
+
+  const float RADIUS = aa_resolve_filter_radius(filter);
+  int reach          = (int)ceilf(RADIUS - 0.5f);
+  if (reach > AA_RESOLVE_MAX_REACH)
+    reach = AA_RESOLVE_MAX_REACH;
+  const int SIDE = 2 * reach + 1;
+  float total    = 0.0f;
+  for (int y = -reach; y <= reach; y++)
+  {
+    for (int x = -reach; x <= reach; x++)
+    {
+      float* pixel = out + ((y + reach) * SIDE + x + reach) * COUNT;
+      for (int s = 0; s < COUNT; s++)
+      {
+        pixel[s] = aa_resolve_filter_weight(
+            filter, RADIUS, (float)x + table->positions[s][0] - 0.5f,
+            (float)y + table->positions[s][1] - 0.5f);
+        total += pixel[s];
+      }
+    }
+  }
+  for (int i = 0; total > 0.0f && i < SIDE * SIDE * COUNT; i++)
+    out[i] /= total;
+  table->reach  = reach;
+  table->filter = (int)filter;
+}
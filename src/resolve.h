@@ -0,0 +1,85 @@
+#ifndef __AA_HG_RESOLVE
+#define __AA_HG_RESOLVE
+
+#include <stdbool.h>
+
+// Custom MSAA resolve (`fragment_msaa_resolve.glsl`)
+// Instead of the fixed box of `glBlitFramebuffer`, every sample of the pixel
+// and of its neighbours within the filter radius is read from the
+// multisampled texture, and weighted by the distance between its position
+// (from `GL_SAMPLE_POSITION`) and the pixel centre. The sample positions are
+// the same in every pixel, so the weights are computed once on the CPU and
+// the shader only fetches and sums:
+// - box: the samples of the pixel only (what the blit computes),
+// - tent: separable, `AA_RESOLVE_TENT_RADIUS` pixels,
+// - Blackman-Harris: radial, `AA_RESOLVE_BLACKMAN_HARRIS_RADIUS` pixels.
+// With `tonemap`, samples are resolved through a reversible Reinhard curve
+// (c / (1 + max(c)), undone after the sum), so that very bright samples do
+// not swallow their pixel.
+
+/// @brief Most samples a multisampled texture may have
+#define AA_RESOLVE_MAX_SAMPLES 16
+
+/// @brief Most pixels read on each side of the resolved one
+#define AA_RESOLVE_MAX_REACH 1
+/// @brief Size of the weight table: every sample of (2 x reach + 1)^2 pixels
+#define AA_RESOLVE_MAX_WEIGHTS                                        \
+  ((2 * AA_RESOLVE_MAX_REACH + 1) * (2 * AA_RESOLVE_MAX_REACH + 1) \
+   * AA_RESOLVE_MAX_SAMPLES)
+
+/// @brief Filter radii, in pixels
+#define AA_RESOLVE_BOX_RADIUS             0.5f
+#define AA_RESOLVE_TENT_RADIUS            1.0f
+#define AA_RESOLVE_BLACKMAN_HARRIS_RADIUS 1.5f
+
+/// @brief Resolve filter (the shader only receives its weights)
+typedef enum
+{
+  AA_RESOLVE_BOX,
+  AA_RESOLVE_TENT,
+  AA_RESOLVE_BLACKMAN_HARRIS,
+  AA_RESOLVE_FILTER_COUNT
+} aa_resolve_filter;
+
+/// @brief Parameters of the custom resolve
+typedef struct
+{
+  aa_resolve_filter filter;
+  // Resolve tonemapped samples
+  bool tonemap;
+} aa_resolve_parameters;
+
+/// @brief Returns the name of a filter, as used in matrix and result files
+const char* aa_resolve_filter_name(aa_resolve_filter filter);
+
+/// @brief Finds a filter by name
+/// @return The filter, or -1 if unknown
+int aa_resolve_filter_find(const char* name);
+
+/// @brief Returns the radius of a filter, in pixels
+float aa_resolve_filter_radius(aa_resolve_filter filter);
+
+/// @brief Weights of a filter over the samples of one multisampled target
+typedef struct
+{
+  // Number of samples, at most `AA_RESOLVE_MAX_SAMPLES`, and their
+  // GL_SAMPLE_POSITION
+  int samples;
+  float positions[AA_RESOLVE_MAX_SAMPLES][2];
+  // Filter the weights were computed for (-1 if none yet)
+  int filter;
+  // Number of pixels read on each side of the resolved one
+  int reach;
+  // Summing to 1: sample `s` of the pixel offset by (x, y) from the resolved
+  // one is at ((y + reach) * (2 * reach + 1) + x + reach) * samples + s
+  float weights[AA_RESOLVE_MAX_WEIGHTS];
+} aa_resolve_table;
+
+/// @brief Reads the sample positions of the bound multisampled frame buffer,
+///        and forgets the weights (once the target is (re)sized)
+void aa_resolve_table_positions(aa_resolve_table* table);
+
+/// @brief Computes the weights of a filter, unless they already are
+void aa_resolve_table_filter(aa_resolve_table* table, aa_resolve_filter filter);
+
+#endif // !__AA_HG_RESOLVE
@@ -0,0 +1,93 @@
+#include "samples.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+/// @brief Builds `<name without .txt>_cpu.csv`
+static void aa_samples_cpu_file_name(const char* file_name, char* out, size_t size)
+{
+  size_t length = strlen(file_name);
+  if (length > 4 && strcmp(file_name + length - 4, ".txt") == 0)
+    length -= 4;
+  snprintf(out, size, "%.*s_cpu.csv", (int)length, file_name);
+}
+
+int aa_samples_save(AppState* state)
+{
+  if (state->current_algorithm_file_name == NULL)
+    return -1;
+
+  FILE* file = fopen(state->current_algorithm_file_name, "w");
+  if (file == NULL)
+  {
+    printf(
+        "Error: Could not create file `%s`!\n", state->current_algorithm_file_name);
+    return -1;
+  }
+  for (size_t i = 0; i < state->samples_current; i++)
+    fprintf(file, "%" PRIu32 ",", state->samples[i]);
+  fclose(file);
+
+  char cpu_file_name[256];
+  aa_samples_cpu_file_name(
+      state->current_algorithm_file_name, cpu_file_name, sizeof(cpu_file_name));
+  file = fopen(cpu_file_name, "w");
+  if (file == NULL)
+  {
+    printf("Error: Could not create file `%s`!\n", cpu_file_name);
+    return -1;
+  }
+  uint64_t gpu_total = 0;
+  uint64_t cpu_total = 0;
+  fputs("gpu_ns,cpu_submit_ns,cpu_gpu_ratio\n", file);
+  for (size_t i = 0; i < state->samples_current; i++)
+  {
+    uint32_t gpu = state->samples[i];
+    uint32_t cpu = state->cpu_samples[i];
+    gpu_total += gpu;
+    cpu_total += cpu;
+    fprintf(
+        file, "%" PRIu32 ",%" PRIu32 ",%.4f\n", gpu, cpu,
+        gpu ? (double)cpu / (double)gpu : 0.0);
+  }
+  fclose(file);
+
+  double count = state->samples_current ? (double)state->samples_current : 1.0;
+  double gpu_ms = (double)gpu_total / count / 1000000.0;
+  double cpu_ms = (double)cpu_total / count / 1000000.0;
+  printf(
+      "Saved: %s (GPU %.4f ms, CPU submit %.4f ms, CPU/GPU %.2f)\n",
+      state->current_algorithm_file_name, gpu_ms, cpu_ms,
+      gpu_ms > 0.0 ? cpu_ms / gpu_ms : 0.0);
+
+  const aa_metrics* quality = &state->last_quality;
+  if (state->measure_quality && quality->psnr >= 0.0)
+  {
+    file = fopen(AA_SAMPLES_QUALITY_FILE_NAME, "a");
+    if (file == NULL)
+    {
+      printf("Error: Could not open file `%s`!\n", AA_SAMPLES_QUALITY_FILE_NAME);
+      return -1;
+    }
+    if (ftell(file) == 0)
+    {
+      fputs(
+          "file,gpu_ms,cpu_submit_ms,psnr_db,ssim,ms_ssim,edge_psnr_db,"
+          "edge_fraction\n",
+          file);
+    }
+    fprintf(
+        file, "%s,%.4f,%.4f,%.3f,%.5f,%.5f,%.3f,%.4f\n",
+        state->current_algorithm_file_name, gpu_ms, cpu_ms, quality->psnr,
+        quality->ssim, quality->ms_ssim, quality->edge_psnr, quality->edge_fraction);
+    fclose(file);
+    printf(
+        "       PSNR %.2f dB, SSIM %.4f, MS-SSIM %.4f, edge PSNR %.2f dB "
+        "(scored in %.2f ms)\n",
+        quality->psnr, quality->ssim, quality->ms_ssim, quality->edge_psnr,
+        state->metrics.last_duration_ns / 1000000.0);
+    // Never paired with the next configuration
+    state->last_quality.psnr = -1.0;
+  }
+  return 0;
+}
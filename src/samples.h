@@ -0,0 +1,21 @@
+#ifndef __AA_HG_SAMPLES
+#define __AA_HG_SAMPLES
+
+#include "appstate.h"
+
+/// @brief Summary of the measured configurations, one line each, written when
+///        image quality is measured (`--quality`)
+#define AA_SAMPLES_QUALITY_FILE_NAME "aa_quality.csv"
+
+/// @brief Saves the recorded samples of the current algorithm
+/// @details Writes the GPU frame times to `current_algorithm_file_name` (the
+///          comma separated format read by `aa.m`), and a companion CSV
+///          (`<name>_cpu.csv`) holding, per frame, the GPU time, the CPU submit
+///          time and their ratio. A summary is printed to the console.
+///          If the quality of the last frame was measured, the mean times and
+///          the PSNR are appended to `AA_SAMPLES_QUALITY_FILE_NAME`.
+/// @param state The application state
+/// @return 0 on success, -1 if a file could not be written
+int aa_samples_save(AppState* state);
+
+#endif // !__AA_HG_SAMPLES
@@ -0,0 +1,131 @@
+#include "scene.h"
+#include "matrix.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef M_PI
+  #define M_PI 3.14159265358979323846
+#endif
+
+const float AA_TRIANGLE_VERTICES[9] = {-0.5f, -0.5f, 0.0f, 0.5f, -0.5f,
+                                       0.0f,  0.0f,  0.5f, 0.0f};
+
+/// @brief Returns the motion of the scene at a frame: a rotation around the
+///        centre of the window, round in pixels whatever the aspect ratio
+/// @param out Column-major 2x2 matrix, in clip space
+static void aa_scene_motion(const AppState* state, uint64_t frame, float out[4])
+{
+  double degrees = fmod(state->scene_parameters.spin * (double)frame, 360.0);
+  double c       = cos(degrees * M_PI / 180.0);
+  double s       = sin(degrees * M_PI / 180.0);
+  double aspect  = (double)state->window_width / state->window_height;
+  out[0]         = (float)c;
+  out[1]         = (float)(s * aspect);
+  out[2]         = (float)(-s / aspect);
+  out[3]         = (float)c;
+}
+
+/// @brief Generates the meshes and instances of the current scene
+/// @return 0 on success, -1 on allocation failure
+static int aa_scene_generate(const AppState* state, aa_batch_geometry* out)
+{
+  const aa_scene_parameters* parameters = &state->scene_parameters;
+  const int WIDTH                       = state->window_width;
+  const int HEIGHT                      = state->window_height;
+  uint32_t vertex_count;
+  float* vertices;
+
+  switch (state->current_scene)
+  {
+  case SCENE_DARTBOARD:
+    vertices = dartboard_vertices(parameters->slices, &vertex_count);
+    return aa_batch_geometry_single(out, vertices, vertex_count);
+  case SCENE_SIEMENS_STAR:
+    return aa_stress_star(out, parameters->slices, WIDTH, HEIGHT);
+  case SCENE_GRID:
+    return aa_stress_grid(out, parameters, WIDTH, HEIGHT);
+  case SCENE_SLIVERS:
+    return aa_stress_slivers(out, parameters, WIDTH, HEIGHT);
+  default:
+    break;
+  }
+
+  vertices = malloc(sizeof(AA_TRIANGLE_VERTICES));
+  if (vertices != NULL)
+    memcpy(vertices, AA_TRIANGLE_VERTICES, sizeof(AA_TRIANGLE_VERTICES));
+  return aa_batch_geometry_single(out, vertices, 3);
+}
+
+int aa_scene_prepare(AppState* state)
+{
+  aa_scene_key key;
+  memset(&key, 0, sizeof(aa_scene_key));
+  key.scene      = state->current_scene;
+  key.parameters = state->scene_parameters;
+  // Spinning only moves the scene, its geometry stays the same
+  key.parameters.spin = 0.0f;
+  key.width           = state->window_width;
+  key.height     = state->window_height;
+  if (memcmp(&key, &state->scene_key, sizeof(aa_scene_key)) == 0)
+    return 0;
+  // Failures are not retried until the scene or its parameters change
+  state->scene_key = key;
+  aa_reference_forget(&state->reference, (uint32_t)key.scene);
+
+  aa_batch_geometry geometry;
+  if (aa_scene_generate(state, &geometry) != 0)
+  {
+    printf("Error: Could not generate scene `%s`\n", aa_scene_name(key.scene));
+    state->scene_batch.command_count = 0;
+    return -1;
+  }
+  aa_batch_upload(&state->scene_batch, &geometry);
+  aa_batch_geometry_free(&geometry);
+  return 0;
+}
+
+void aa_scene_render(AppState* state)
+{
+  // Every scene uses the default program, and is drawn in a single call
+  aa_program_use(&state->program);
+  aa_scene_prepare(state);
+
+  // Pose of the scene in this frame and the previous one (for the velocity)
+  const uint64_t FRAME = state->scene_frame;
+  float motion[4];
+  float previous_motion[4];
+  aa_scene_motion(state, FRAME, motion);
+  aa_scene_motion(state, FRAME ? FRAME - 1 : 0, previous_motion);
+  glUniformMatrix2fv(
+      glGetUniformLocation(state->program.id, "u_motion"), 1, GL_FALSE, motion);
+  glUniformMatrix2fv(
+      glGetUniformLocation(state->program.id, "u_previous_motion"), 1, GL_FALSE,
+      previous_motion);
+
+  aa_batch_render(&state->scene_batch);
+}
+
+float* aa_scene_vertices(const AppState* state, uint32_t* vertex_count)
+{
+  aa_batch_geometry geometry;
+  if (aa_scene_generate(state, &geometry) != 0)
+    return NULL;
+  // Instances are expanded, the rasteriser only takes triangles
+  float* vertices = aa_batch_geometry_expand(&geometry, vertex_count);
+  aa_batch_geometry_free(&geometry);
+  if (vertices == NULL || state->scene_parameters.spin == 0.0f)
+    return vertices;
+
+  float motion[4];
+  aa_scene_motion(state, state->scene_frame, motion);
+  for (uint32_t i = 0; i < *vertex_count; i++)
+  {
+    float x             = vertices[i * 3 + 0];
+    float y             = vertices[i * 3 + 1];
+    vertices[i * 3 + 0] = motion[0] * x + motion[2] * y;
+    vertices[i * 3 + 1] = motion[1] * x + motion[3] * y;
+  }
+  return vertices;
+}
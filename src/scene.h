@@ -0,0 +1,45 @@
+#ifndef __AA_HG_SCENE
+#define __AA_HG_SCENE
+
+#include "appstate.h"
+
+/// @brief Clear colour used while image quality is measured
+/// @details The animated clear colour would make every frame different from the
+///          reference image, so measured frames use this constant one instead
+#define AA_SCENE_BACKGROUND_R 0.0f
+#define AA_SCENE_BACKGROUND_G 0.0f
+#define AA_SCENE_BACKGROUND_B 0.0f
+
+/// @brief Colour of the geometry (see `fragment_default.glsl`)
+#define AA_SCENE_FOREGROUND_R 1.0f
+#define AA_SCENE_FOREGROUND_G 1.0f
+#define AA_SCENE_FOREGROUND_B 1.0f
+
+/// @brief Vertices of the triangle scene (xyz, clip space)
+extern const float AA_TRIANGLE_VERTICES[9];
+
+/// @brief Generates the batch of the current scene (see `batch.h`) if the
+///        scene, its parameters or the window size changed since it was last
+///        generated
+/// @details Called by `aa_scene_render`. Drops the cached reference image of
+///          the scene when it is regenerated.
+/// @return 0 on success, -1 if the scene could not be generated
+int aa_scene_prepare(AppState* state);
+
+/// @brief Draws the current scene into the bound framebuffer
+/// @details The scene is posed at `scene_frame` (see `aa_scene_parameters`),
+///          and writes its velocity since the previous frame to the second
+///          colour attachment, if any (in texture coordinates)
+/// @param state The application state
+void aa_scene_render(AppState* state);
+
+/// @brief Returns the triangles of the current scene, as drawn by
+///        `aa_scene_render` (instances are expanded, the scene is posed at
+///        `scene_frame`)
+/// @param state The application state
+/// @param vertex_count Receives the number of vertices (3 per triangle)
+/// @return The xyz positions in clip space, to be freed by the caller, or NULL
+///         on failure
+float* aa_scene_vertices(const AppState* state, uint32_t* vertex_count);
+
+#endif // !__AA_HG_SCENE
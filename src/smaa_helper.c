@@ -3,125 +3,377 @@
 #include <string.h>
 #include <stdio.h>
 #include <glad/glad.h>
+#include "gl/error.h"
 
-char* aa_concat_smaa_source(
-    const char* preamble, const char* smaa_lib, const char* shader_logic)
+/// @brief Assembles one SMAA pass: header + preset + body (+ SMAA.hlsl)
+static void aa_smaa_assemble(
+    aa_shader_assembly* out, const char* preset_macro, bool vertex,
+    const char* body)
 {
-  if (!preamble || !smaa_lib || !shader_logic)
-    return NULL;
+  aa_shader_assembly_begin(out, "#version 430 core\n");
+  aa_shader_assembly_text(
+      out, "#define SMAA_GLSL_4 1\n"
+           "uniform vec4 SMAA_RT_METRICS;\n");
+  aa_shader_assembly_text(out, preset_macro);
+  // We define "discard" to be empty space. This tricks the Vertex Shader
+  // into ignoring the discard commands inside the SMAA library.
+  if (vertex)
+  {
+    aa_shader_assembly_text(
+        out, "#define SMAA_DISCARD \n"
+             "#define discard \n");
+  }
+  aa_shader_assembly_file(out, body);
+}
+
+int aa_smaa_pipeline_init(
+    aa_smaa_pipeline* p, aa_shader_cache* cache, const char* preset_macro)
+{
+  aa_shader_assembly assembly;
+  int result = 0;
 
-  size_t len_pre = strlen(preamble);
-  size_t len_lib = strlen(smaa_lib);
-  size_t len_log = strlen(shader_logic);
+  // Submit Shaders (compile status is checked by `aa_shader_cache_check`)
+  aa_smaa_assemble(&assembly, preset_macro, true, "vertex_edge_smaa.glsl");
+  result |= aa_shader_cache_vertex(cache, &assembly, &p->edge_vs);
+  aa_smaa_assemble(&assembly, preset_macro, false, "fragment_edge_smaa.glsl");
+  result |= aa_shader_cache_fragment(cache, &assembly, &p->edge_fs);
 
-  char* result = (char*)malloc(len_pre + len_lib + len_log + 1);
-  if (!result)
-    return NULL;
+  aa_smaa_assemble(&assembly, preset_macro, true, "vertex_blend_smaa.glsl");
+  result |= aa_shader_cache_vertex(cache, &assembly, &p->blend_vs);
+  aa_smaa_assemble(&assembly, preset_macro, false, "fragment_blend_smaa.glsl");
+  result |= aa_shader_cache_fragment(cache, &assembly, &p->blend_fs);
+
+  aa_smaa_assemble(&assembly, preset_macro, true, "vertex_neighborhood_smaa.glsl");
+  result |= aa_shader_cache_vertex(cache, &assembly, &p->neigh_vs);
+  aa_smaa_assemble(
+      &assembly, preset_macro, false, "fragment_neighborhood_smaa.glsl");
+  result |= aa_shader_cache_fragment(cache, &assembly, &p->neigh_fs);
 
-  memcpy(result, preamble, len_pre);
-  memcpy(result + len_pre, smaa_lib, len_lib);
-  memcpy(result + len_pre + len_lib, shader_logic, len_log);
-  result[len_pre + len_lib + len_log] = '\0';
+  if (result != 0)
+  {
+    printf("Error: Could not assemble SMAA pipeline\n");
+    return -1;
+  }
 
+  // Submit Links
+  aa_program_create(&p->edge_program);
+  aa_program_attach_shaders(&p->edge_program, &p->edge_vs, &p->edge_fs);
+  aa_program_link_submit(&p->edge_program);
+
+  aa_program_create(&p->blend_program);
+  aa_program_attach_shaders(&p->blend_program, &p->blend_vs, &p->blend_fs);
+  aa_program_link_submit(&p->blend_program);
+
+  aa_program_create(&p->neighborhood_program);
+  aa_program_attach_shaders(&p->neighborhood_program, &p->neigh_vs, &p->neigh_fs);
+  aa_program_link_submit(&p->neighborhood_program);
+
+  return 0;
+}
+
+int aa_smaa_pipeline_check(aa_smaa_pipeline* p)
+{
+  int result = 0;
+  result |= aa_program_link_check(&p->edge_program);
+  result |= aa_program_link_check(&p->blend_program);
+  result |= aa_program_link_check(&p->neighborhood_program);
   return result;
 }
 
-int aa_smaa_pipeline_init(
-    aa_smaa_pipeline* p, const char* preset_macro, const char* lib_src,
-    const char* vs_edge_raw, const char* fs_edge_raw, const char* vs_blend_raw,
-    const char* fs_blend_raw, const char* vs_neigh_raw, const char* fs_neigh_raw)
+uint32_t aa_smaa_pipeline_ready(aa_smaa_pipeline* p)
 {
-  //Base Header: Version + Uniforms + Defines
-  const char* base_string = "#version 430 core\n"
-                            "#define SMAA_GLSL_4 1\n"
-                            "uniform vec4 SMAA_RT_METRICS;\n";
+  return (uint32_t)aa_program_link_ready(&p->edge_program)
+         + (uint32_t)aa_program_link_ready(&p->blend_program)
+         + (uint32_t)aa_program_link_ready(&p->neighborhood_program);
+}
 
-  char* full_header = aa_concat_smaa_source(base_string, preset_macro, "");
+void aa_smaa_pipeline_delete(aa_smaa_pipeline* p)
+{
+  aa_program_delete(&p->edge_program);
+  aa_program_delete(&p->blend_program);
+  aa_program_delete(&p->neighborhood_program);
+}
 
-  // We define "discard" to be empty space. This tricks the Vertex Shader
-  // into ignoring the discard commands inside the SMAA library.
-  const char* no_discard_define = "#define SMAA_DISCARD \n"
-                                  "#define discard \n";
+// See @SUBSAMPLE_INDICES in SMAA.hlsl: the table gives the motion of the pixel
+// centres, the geometry moves the opposite way, and the rows of our textures
+// run bottom to top, which mirrors the vertical axis of the area texture
+const float AA_SMAA_T2X_JITTER[2][2] = {{-0.25f, -0.25f}, {0.25f, 0.25f}};
+const float AA_SMAA_T2X_SUBSAMPLE_INDICES[2][4] = {
+    {1.0f, 1.0f, 1.0f, 0.0f}, {2.0f, 2.0f, 2.0f, 0.0f}};
 
-  char* temp_header = aa_concat_smaa_source(base_string, preset_macro, "");
-  char* vs_header   = aa_concat_smaa_source(temp_header, no_discard_define, "");
-  free(temp_header);
+int aa_smaa_temporal_init(
+    aa_smaa_temporal* t, aa_shader_cache* cache, const char* preset_macro)
+{
+  // The neighborhood blending pass packs the velocity for the resolve
+  char macros[256];
+  snprintf(
+      macros, sizeof(macros), "%s#define SMAA_REPROJECTION 1\n", preset_macro);
+  if (aa_smaa_pipeline_init(&t->pipeline, cache, macros) != 0)
+    return -1;
 
-  if (!full_header || !vs_header)
+  aa_shader_assembly assembly;
+  int result = 0;
+  aa_smaa_assemble(&assembly, macros, true, "vertex_resolve_smaa.glsl");
+  result |= aa_shader_cache_vertex(cache, &assembly, &t->resolve_vs);
+  aa_smaa_assemble(&assembly, macros, false, "fragment_resolve_smaa.glsl");
+  result |= aa_shader_cache_fragment(cache, &assembly, &t->resolve_fs);
+  if (result != 0)
+  {
+    printf("Error: Could not assemble SMAA T2x resolve\n");
     return -1;
+  }
 
-  // Concatenate Sources
-  // Use vs_header for Vertex Shaders, full_header for Fragment Shaders
-  char* src_e_vs = aa_concat_smaa_source(vs_header, lib_src, vs_edge_raw);
-  char* src_e_fs = aa_concat_smaa_source(full_header, lib_src, fs_edge_raw);
+  aa_program_create(&t->resolve_program);
+  aa_program_attach_shaders(&t->resolve_program, &t->resolve_vs, &t->resolve_fs);
+  aa_program_link_submit(&t->resolve_program);
+  return 0;
+}
 
-  char* src_b_vs = aa_concat_smaa_source(vs_header, lib_src, vs_blend_raw);
-  char* src_b_fs = aa_concat_smaa_source(full_header, lib_src, fs_blend_raw);
+int aa_smaa_temporal_check(aa_smaa_temporal* t)
+{
+  return aa_smaa_pipeline_check(&t->pipeline)
+         | aa_program_link_check(&t->resolve_program);
+}
 
-  char* src_n_vs = aa_concat_smaa_source(vs_header, lib_src, vs_neigh_raw);
-  char* src_n_fs = aa_concat_smaa_source(full_header, lib_src, fs_neigh_raw);
+uint32_t aa_smaa_temporal_ready(aa_smaa_temporal* t)
+{
+  return aa_smaa_pipeline_ready(&t->pipeline)
+         + (uint32_t)aa_program_link_ready(&t->resolve_program);
+}
 
-  // Clean up headers
-  free(full_header);
-  free(vs_header);
+void aa_smaa_temporal_delete(aa_smaa_temporal* t)
+{
+  aa_smaa_pipeline_delete(&t->pipeline);
+  aa_program_delete(&t->resolve_program);
+}
 
-  if (!src_e_vs || !src_e_fs || !src_b_vs || !src_b_fs || !src_n_vs || !src_n_fs)
+int aa_smaa_separate_init(
+    aa_smaa_separate* separate, aa_shader_cache* cache, bool velocity)
+{
+  const char* macros = velocity ? "#define SMAA_REPROJECTION 1\n" : "";
+  aa_shader_assembly assembly;
+  int result = 0;
+  aa_smaa_assemble(&assembly, macros, true, "vertex_resolve_smaa.glsl");
+  result |= aa_shader_cache_vertex(cache, &assembly, &separate->vs);
+  aa_smaa_assemble(&assembly, macros, false, "fragment_separate_smaa.glsl");
+  result |= aa_shader_cache_fragment(cache, &assembly, &separate->fs);
+  if (result != 0)
   {
+    printf("Error: Could not assemble SMAA separate pass\n");
     return -1;
   }
 
-  // Compile Shaders
-  aa_vertex_shader_create(&p->edge_vs, src_e_vs);
-  aa_vertex_shader_compile(&p->edge_vs);
-  aa_fragment_shader_create(&p->edge_fs, src_e_fs);
-  aa_fragment_shader_compile(&p->edge_fs);
+  aa_program_create(&separate->program);
+  aa_program_attach_shaders(&separate->program, &separate->vs, &separate->fs);
+  aa_program_link_submit(&separate->program);
+  return 0;
+}
 
-  aa_vertex_shader_create(&p->blend_vs, src_b_vs);
-  aa_vertex_shader_compile(&p->blend_vs);
-  aa_fragment_shader_create(&p->blend_fs, src_b_fs);
-  aa_fragment_shader_compile(&p->blend_fs);
+// Same conventions as AA_SMAA_T2X_JITTER: the frames of SMAA 4x are jittered
+// by an eighth of a pixel, and the subsamples of the table are the offsets of
+// the pixel centres, (0.25, 0.25) for S0 and (-0.25, -0.25) for S1 here
+const float AA_SMAA_4X_JITTER[2][2] = {{-0.125f, 0.125f}, {0.125f, -0.125f}};
+static const float AA_SMAA_S2X_INDICES[2][4] = {
+    {1.0f, 1.0f, 1.0f, 0.0f}, {2.0f, 2.0f, 2.0f, 0.0f}};
+static const float AA_SMAA_4X_INDICES[2][2][4] = {
+    {{5.0f, 3.0f, 1.0f, 3.0f}, {4.0f, 6.0f, 2.0f, 3.0f}},
+    {{3.0f, 5.0f, 1.0f, 4.0f}, {6.0f, 4.0f, 2.0f, 4.0f}}};
 
-  aa_vertex_shader_create(&p->neigh_vs, src_n_vs);
-  aa_vertex_shader_compile(&p->neigh_vs);
-  aa_fragment_shader_create(&p->neigh_fs, src_n_fs);
-  aa_fragment_shader_compile(&p->neigh_fs);
+int aa_smaa_separate_indices(
+    const float positions[2][2], float centre[2], float s2x[2][4],
+    float smaa_4x[2][2][4])
+{
+  memset(s2x, 0, 2 * 4 * sizeof(float));
+  memset(smaa_4x, 0, 2 * 2 * 4 * sizeof(float));
 
-  // Link Programs
-  aa_program_create(&p->edge_program);
-  aa_program_attach_shaders(&p->edge_program, &p->edge_vs, &p->edge_fs);
-  aa_program_link(&p->edge_program);
+  // Moving the scene by the offset of the middle of the samples centres them
+  // on the pixel, whatever the driver's pattern
+  centre[0] = 0.5f * (positions[0][0] + positions[1][0]) - 0.5f;
+  centre[1] = 0.5f * (positions[0][1] + positions[1][1]) - 0.5f;
 
-  aa_program_create(&p->blend_program);
-  aa_program_attach_shaders(&p->blend_program, &p->blend_vs, &p->blend_fs);
-  aa_program_link(&p->blend_program);
+  // The samples must then lie on the diagonal of SMAA.hlsl, in either order
+  float dx = positions[1][0] - positions[0][0];
+  float dy = positions[1][1] - positions[0][1];
+  if (dx * dy <= 0.0f)
+    return -1;
+  uint32_t first = dx > 0.0f ? 1 : 0;
 
-  aa_program_create(&p->neighborhood_program);
-  aa_program_attach_shaders(&p->neighborhood_program, &p->neigh_vs, &p->neigh_fs);
-  aa_program_link(&p->neighborhood_program);
+  for (uint32_t sample = 0; sample < 2; sample++)
+  {
+    uint32_t s = sample == first ? 0 : 1;
+    memcpy(s2x[sample], AA_SMAA_S2X_INDICES[s], 4 * sizeof(float));
+    memcpy(smaa_4x[0][sample], AA_SMAA_4X_INDICES[0][s], 4 * sizeof(float));
+    memcpy(smaa_4x[1][sample], AA_SMAA_4X_INDICES[1][s], 4 * sizeof(float));
+  }
+  return 0;
+}
 
-  // Cleanup Source Strings
-  free(src_e_vs);
-  free(src_e_fs);
-  free(src_b_vs);
-  free(src_b_fs);
-  free(src_n_vs);
-  free(src_n_fs);
+const aa_smaa_parameters AA_SMAA_PRESETS[4] = {
+    {0.15f, 4, 8, 25.0f, AA_SMAA_EDGE_LUMA, false, false},
+    {0.1f, 8, 8, 25.0f, AA_SMAA_EDGE_LUMA, false, false},
+    {0.1f, 16, 8, 25.0f, AA_SMAA_EDGE_LUMA, true, true},
+    {0.05f, 32, 16, 25.0f, AA_SMAA_EDGE_LUMA, true, true}};
 
-  return 0;
+static const char* const AA_SMAA_EDGE_MODE_NAMES[AA_SMAA_EDGE_MODES] = {
+    "luma", "color", "depth", "predicated"};
+
+const char* aa_smaa_edge_mode_name(aa_smaa_edge_mode mode)
+{
+  return (uint32_t)mode < AA_SMAA_EDGE_MODES ? AA_SMAA_EDGE_MODE_NAMES[mode] : "?";
 }
 
-void aa_smaa_pipeline_delete(aa_smaa_pipeline* p)
+bool aa_smaa_edge_mode_depth(aa_smaa_edge_mode mode)
 {
-  aa_program_delete(&p->edge_program);
-  aa_program_delete(&p->blend_program);
-  aa_program_delete(&p->neighborhood_program);
+  return mode == AA_SMAA_EDGE_DEPTH || mode == AA_SMAA_EDGE_PREDICATED;
+}
+
+// The macros SMAA.hlsl reads its parameters from are redirected to uniforms.
+// They are declared by every pass: the vertex shader of the blend pass reads
+// the search steps, its fragment shader the diagonal steps and rounding.
+#define AA_SMAA_CUSTOM_DEFINES                                        \
+  "uniform float u_smaa_threshold;\n"                                 \
+  "uniform int u_smaa_max_search_steps;\n"                            \
+  "uniform int u_smaa_max_search_steps_diag;\n"                       \
+  "uniform float u_smaa_corner_rounding;\n"                           \
+  "#define SMAA_THRESHOLD u_smaa_threshold\n"                         \
+  "#define SMAA_MAX_SEARCH_STEPS u_smaa_max_search_steps\n"           \
+  "#define SMAA_MAX_SEARCH_STEPS_DIAG u_smaa_max_search_steps_diag\n" \
+  "#define SMAA_CORNER_ROUNDING u_smaa_corner_rounding\n"
+
+// Indexed by `diagonal_detection | corner_detection << 1`
+static const char* const AA_SMAA_CUSTOM_FEATURES[4] = {
+    "#define SMAA_DISABLE_DIAG_DETECTION\n"
+    "#define SMAA_DISABLE_CORNER_DETECTION\n",
+    "#define SMAA_DISABLE_CORNER_DETECTION\n",
+    "#define SMAA_DISABLE_DIAG_DETECTION\n",
+    ""};
+
+// Read by `fragment_edge_smaa.glsl`, indexed by `aa_smaa_edge_mode`
+static const char* const AA_SMAA_CUSTOM_EDGES[AA_SMAA_EDGE_MODES] = {
+    "", "#define SMAA_EDGE_COLOR 1\n", "#define SMAA_EDGE_DEPTH 1\n",
+    "#define SMAA_PREDICATION 1\n"};
+
+/// @brief Every feature, luma edges
+#define AA_SMAA_CUSTOM_DEFAULT 3u
+
+static uint32_t aa_smaa_custom_variant(const aa_smaa_parameters* parameters)
+{
+  return (parameters->diagonal_detection ? 1u : 0u)
+         | (parameters->corner_detection ? 2u : 0u)
+         | ((uint32_t)parameters->edge_mode << 2);
+}
+
+/// @brief Submits a variant of the custom pipeline
+static int aa_smaa_custom_submit(aa_smaa_custom* custom, uint32_t variant)
+{
+  char macros[1024];
+  snprintf(
+      macros, sizeof(macros), "%s%s%s", AA_SMAA_CUSTOM_DEFINES,
+      AA_SMAA_CUSTOM_FEATURES[variant & 3u], AA_SMAA_CUSTOM_EDGES[variant >> 2]);
+  return aa_smaa_pipeline_init(&custom->variants[variant], custom->cache, macros);
+}
+
+/// @brief Compares the fields (a memcmp would also compare the padding)
+static bool aa_smaa_parameters_equal(
+    const aa_smaa_parameters* a, const aa_smaa_parameters* b)
+{
+  return a->threshold == b->threshold
+         && a->max_search_steps == b->max_search_steps
+         && a->max_search_steps_diag == b->max_search_steps_diag
+         && a->corner_rounding == b->corner_rounding
+         && a->edge_mode == b->edge_mode
+         && a->diagonal_detection == b->diagonal_detection
+         && a->corner_detection == b->corner_detection;
+}
+
+/// @brief Uploads the parameters to every uniform of a program that uses them
+static void aa_smaa_custom_upload(
+    aa_program* program, const aa_smaa_parameters* parameters)
+{
+  glCall(glProgramUniform1f(
+      program->id, glGetUniformLocation(program->id, "u_smaa_threshold"),
+      parameters->threshold));
+  glCall(glProgramUniform1i(
+      program->id, glGetUniformLocation(program->id, "u_smaa_max_search_steps"),
+      parameters->max_search_steps));
+  glCall(glProgramUniform1i(
+      program->id,
+      glGetUniformLocation(program->id, "u_smaa_max_search_steps_diag"),
+      parameters->max_search_steps_diag));
+  glCall(glProgramUniform1f(
+      program->id, glGetUniformLocation(program->id, "u_smaa_corner_rounding"),
+      parameters->corner_rounding));
+}
 
-  aa_vertex_shader_delete(&p->edge_vs);
-  aa_fragment_shader_delete(&p->edge_fs);
-  aa_vertex_shader_delete(&p->blend_vs);
-  aa_fragment_shader_delete(&p->blend_fs);
-  aa_vertex_shader_delete(&p->neigh_vs);
-  aa_fragment_shader_delete(&p->neigh_fs);
+int aa_smaa_custom_init(aa_smaa_custom* custom, aa_shader_cache* cache)
+{
+  memset(custom, 0, sizeof(aa_smaa_custom));
+  custom->cache = cache;
+  if (aa_smaa_custom_submit(custom, AA_SMAA_CUSTOM_DEFAULT) != 0)
+    return -1;
+  custom->initialized[AA_SMAA_CUSTOM_DEFAULT] = true;
+  return 0;
 }
 
+aa_smaa_pipeline* aa_smaa_custom_default(aa_smaa_custom* custom)
+{
+  return &custom->variants[AA_SMAA_CUSTOM_DEFAULT];
+}
 
+aa_smaa_pipeline* aa_smaa_custom_get(
+    aa_smaa_custom* custom, const aa_smaa_parameters* parameters)
+{
+  if ((uint32_t)parameters->edge_mode >= AA_SMAA_EDGE_MODES)
+    return NULL;
+  uint32_t variant        = aa_smaa_custom_variant(parameters);
+  aa_smaa_pipeline* p     = &custom->variants[variant];
+  aa_smaa_parameters* old = &custom->uploaded[variant];
+
+  if (custom->failed[variant])
+    return NULL;
+  if (!custom->initialized[variant])
+  {
+    if (aa_smaa_custom_submit(custom, variant) != 0)
+    {
+      custom->failed[variant] = true;
+      return NULL;
+    }
+    if (aa_shader_cache_check(custom->cache) != 0
+        || aa_smaa_pipeline_check(p) != 0)
+    {
+      printf(
+          "Error: Custom SMAA variant (diagonal %s, corner %s, %s edges) "
+          "failed, it is disabled\n",
+          parameters->diagonal_detection ? "on" : "off",
+          parameters->corner_detection ? "on" : "off",
+          aa_smaa_edge_mode_name(parameters->edge_mode));
+      aa_smaa_pipeline_delete(p);
+      custom->failed[variant] = true;
+      return NULL;
+    }
+    custom->initialized[variant] = true;
+    printf(
+        "Compiled custom SMAA variant (diagonal %s, corner %s, %s edges)\n",
+        parameters->diagonal_detection ? "on" : "off",
+        parameters->corner_detection ? "on" : "off",
+        aa_smaa_edge_mode_name(parameters->edge_mode));
+  }
+  else if (aa_smaa_parameters_equal(old, parameters))
+  {
+    return p;
+  }
+
+  aa_smaa_custom_upload(&p->edge_program, parameters);
+  aa_smaa_custom_upload(&p->blend_program, parameters);
+  *old = *parameters;
+  return p;
+}
+
+void aa_smaa_custom_delete(aa_smaa_custom* custom)
+{
+  for (uint32_t i = 0; i < AA_SMAA_CUSTOM_VARIANTS; i++)
+  {
+    if (custom->initialized[i])
+      aa_smaa_pipeline_delete(&custom->variants[i]);
+  }
+}
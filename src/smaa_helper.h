@@ -1,10 +1,13 @@
 #ifndef __HG_AA_SMAA_SMAA_HELPER
 #define __HG_AA_SMAA_SMAA_HELPER
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include "gl/program.h"
 #include "gl/shaders.h"
+#include "gl/shader_assembly.h"
 
 // Container for the complete SMAA rendering pipeline
 // Bundles the three distinct shader programs (Edge Detection, Blend Weight, Neighborhood Blending)
@@ -15,35 +18,188 @@ typedef struct
   aa_program blend_program;
   aa_program neighborhood_program;
 
-  // Keeping shaders to delete them cleanly later
+  // Shaders are owned by the shader cache they were taken from
   aa_vertex_shader edge_vs, blend_vs, neigh_vs;
   aa_fragment_shader edge_fs, blend_fs, neigh_fs;
 } aa_smaa_pipeline;
 
 ///@brief Initializes a specific SMAA pipeline (e.g. Low, Ultra)
+///@details Each pass is assembled from the common header, `preset_macro` and the
+///         pass body (`vertex/fragment_*_smaa.glsl`), which includes SMAA.hlsl.
+///         Shaders with identical sources are shared through `cache`.
+///         Compilation and linking are only submitted, see `aa_smaa_pipeline_check`.
 ///@param pipeline Pointer to the struct to initialize
-///@param preset_macro The specific define string (e.g. "#define SMAA_PRESET_ULTRA 1\n")
-///@param lib_src Content of SMAA.hlsl
-///@param vs_edge_src Content of vertex_edge_smaa.glsl
-///@param fs_edge_src Content of fragment_edge_smaa.glsl
-///@param vs_blend_src Content of vertex_blend_smaa.glsl
-///@param fs_blend_src Content of fragment_blend_smaa.glsl
-///@param vs_neigh_src Content of vertex_neighborhood_smaa.glsl
-///@param fs_neigh_src Content of fragment_neighborhood_smaa.glsl
+///@param cache The cache owning the compiled shaders
+///@param preset_macro The specific define string
+///       (e.g. "#define SMAA_PRESET_ULTRA 1\n"), referenced until the call returns
 ///@return 0 on success, -1 on failure
 int aa_smaa_pipeline_init(
-    aa_smaa_pipeline* pipeline, const char* preset_macro, const char* lib_src,
-    const char* vs_edge_src, const char* fs_edge_src, const char* vs_blend_src,
-    const char* fs_blend_src, const char* vs_neigh_src, const char* fs_neigh_src);
+    aa_smaa_pipeline* pipeline, aa_shader_cache* cache, const char* preset_macro);
 
-// Cleans up the programs and shaders in the pipeline
+///@brief Waits for the programs of a pipeline to be linked
+///@return 0 on success, -1 if a program failed to link
+int aa_smaa_pipeline_check(aa_smaa_pipeline* pipeline);
+
+///@brief Counts the programs of a pipeline that finished linking, without blocking
+uint32_t aa_smaa_pipeline_ready(aa_smaa_pipeline* pipeline);
+
+// Cleans up the programs in the pipeline (shaders belong to the cache)
 void aa_smaa_pipeline_delete(aa_smaa_pipeline* pipeline);
 
-// Helper to concatenate strings (Preamble + Lib + Body)
-char* aa_concat_smaa_source(
-    const char* preamble, const char* library, const char* body);
+// SMAA T2x: SMAA 1x on frames alternately jittered by a quarter of a pixel,
+// followed by a temporal resolve blending each frame with the previous one
+// (reprojected along the velocity of the scene). Two subsamples per pixel
+// for the cost of SMAA 1x and a resolve.
+typedef struct
+{
+  // SMAA 1x passes, compiled with SMAA_REPROJECTION
+  aa_smaa_pipeline pipeline;
+  aa_program resolve_program;
+  aa_vertex_shader resolve_vs;
+  aa_fragment_shader resolve_fs;
+} aa_smaa_temporal;
+
+/// @brief Offset of the scene for the two subsamples of SMAA T2x, in pixels
+///        (y up)
+extern const float AA_SMAA_T2X_JITTER[2][2];
+/// @brief `subsampleIndices` of the blending weight pass, per subsample
+extern const float AA_SMAA_T2X_SUBSAMPLE_INDICES[2][4];
+
+///@brief Initializes the T2x pipeline on top of a preset
+///@details Submits compilation and linking like `aa_smaa_pipeline_init`
+///@return 0 on success, -1 on failure
+int aa_smaa_temporal_init(
+    aa_smaa_temporal* temporal, aa_shader_cache* cache, const char* preset_macro);
+
+///@brief Waits for the programs of the T2x pipeline to be linked
+///@return 0 on success, -1 if a program failed to link
+int aa_smaa_temporal_check(aa_smaa_temporal* temporal);
+
+///@brief Counts the programs of the T2x pipeline that finished linking
+uint32_t aa_smaa_temporal_ready(aa_smaa_temporal* temporal);
+
+// Cleans up the programs of the T2x pipeline
+void aa_smaa_temporal_delete(aa_smaa_temporal* temporal);
+
+// SMAA S2x: the scene is drawn with 2x MSAA, its samples are separated into
+// two textures, and each one is anti-aliased by SMAA 1x with the area texture
+// of its position before both are averaged. SMAA 4x jitters S2x like T2x and
+// adds the temporal resolve.
+typedef struct
+{
+  // Writes the two samples to the colour attachments 0 and 1 (and the velocity
+  // of the first one to the attachment 2, for SMAA 4x)
+  aa_program program;
+  aa_vertex_shader vs;
+  aa_fragment_shader fs;
+} aa_smaa_separate;
+
+/// @brief Offset of the scene for the two frames of SMAA 4x, in pixels (y up)
+extern const float AA_SMAA_4X_JITTER[2][2];
+
+///@brief Initializes the separate pass
+///@details Submits compilation and linking like `aa_smaa_pipeline_init`
+///@param velocity Also copies the velocity (SMAA 4x)
+///@return 0 on success, -1 on failure
+int aa_smaa_separate_init(
+    aa_smaa_separate* separate, aa_shader_cache* cache, bool velocity);
+
+///@brief Fits the samples of a 2x multisampled target to SMAA S2x and 4x
+///@details SMAA.hlsl expects the diagonal pattern of Direct3D, centred on the
+///         pixel, whose positions and order OpenGL does not guarantee: the
+///         scene is offset to centre the samples, which are matched by their
+///         relative position.
+///@param positions The GL_SAMPLE_POSITION of both samples
+///@param centre Offset of the scene centring the samples, in pixels (y up)
+///@param s2x `subsampleIndices` of each sample for SMAA S2x
+///@param smaa_4x `subsampleIndices` of each sample in the two frames of SMAA 4x
+///@return 0 on success, -1 if the samples are not on that diagonal (every
+///        index is then 0, the samples being processed like SMAA 1x)
+int aa_smaa_separate_indices(
+    const float positions[2][2], float centre[2], float s2x[2][4],
+    float smaa_4x[2][2][4]);
+
+/// @brief Input of the edge detection pass of the custom pipeline
+typedef enum
+{
+  // SMAALumaEdgeDetectionPS on the colour
+  AA_SMAA_EDGE_LUMA,
+  // SMAAColorEdgeDetectionPS: the largest difference of the three channels
+  AA_SMAA_EDGE_COLOR,
+  // SMAADepthEdgeDetectionPS on the depth of the scene: cheapest, but blind to
+  // the edges inside a surface
+  AA_SMAA_EDGE_DEPTH,
+  // Luma edges with SMAA_PREDICATION: the threshold is lowered where the depth
+  // has an edge, and raised elsewhere
+  AA_SMAA_EDGE_PREDICATED,
+  AA_SMAA_EDGE_MODES
+} aa_smaa_edge_mode;
+
+/// @brief Name of an edge detection mode (e.g. "luma"), used by the matrix
+const char* aa_smaa_edge_mode_name(aa_smaa_edge_mode mode);
+
+/// @brief True if an edge detection mode reads the depth of the scene
+bool aa_smaa_edge_mode_depth(aa_smaa_edge_mode mode);
+
+// Parameters of the custom SMAA pipeline, matching the SMAA.hlsl macros
+typedef struct
+{
+  // SMAA_THRESHOLD: edge detection sensitivity (0.05 to 0.5)
+  float threshold;
+  // SMAA_MAX_SEARCH_STEPS: horizontal/vertical search distance (0 to 112)
+  int max_search_steps;
+  // SMAA_MAX_SEARCH_STEPS_DIAG: diagonal search distance (0 to 20)
+  int max_search_steps_diag;
+  // SMAA_CORNER_ROUNDING: how much sharp corners are rounded (0 to 100)
+  float corner_rounding;
+  // Edge detection pass, compiled in (one variant each)
+  aa_smaa_edge_mode edge_mode;
+  // Diagonal and corner processing are compiled in or out (like the presets
+  // do), since disabling them at runtime would still pay for the code
+  bool diagonal_detection;
+  bool corner_detection;
+} aa_smaa_parameters;
+
+/// @brief The values of SMAA_PRESET_LOW, MEDIUM, HIGH and ULTRA (in that order)
+extern const aa_smaa_parameters AA_SMAA_PRESETS[4];
+
+/// @brief Number of compiled variants of the custom pipeline (diagonal and
+///        corner processing on or off, for every edge detection mode)
+#define AA_SMAA_CUSTOM_VARIANTS (4 * AA_SMAA_EDGE_MODES)
+
+// SMAA pipeline whose parameters are uniforms instead of preset macros
+// Any parameter set can be measured without recompiling. Only the features
+// switched by `#if` in SMAA.hlsl select a variant, and those are compiled on
+// first use.
+typedef struct
+{
+  aa_smaa_pipeline variants[AA_SMAA_CUSTOM_VARIANTS];
+  bool initialized[AA_SMAA_CUSTOM_VARIANTS];
+  // Failed to compile or link (and never submitted again)
+  bool failed[AA_SMAA_CUSTOM_VARIANTS];
+  // Parameters last uploaded to each variant
+  aa_smaa_parameters uploaded[AA_SMAA_CUSTOM_VARIANTS];
+  // The cache owning the shaders of the variants
+  aa_shader_cache* cache;
+} aa_smaa_custom;
+
+///@brief Initializes the custom pipeline
+///@details Only submits the variant with every feature enabled and luma edges,
+///         check it with
+///         `aa_smaa_pipeline_check(aa_smaa_custom_default(custom))`
+///@return 0 on success, -1 on failure
+int aa_smaa_custom_init(aa_smaa_custom* custom, aa_shader_cache* cache);
+
+///@brief The variant submitted by `aa_smaa_custom_init`
+aa_smaa_pipeline* aa_smaa_custom_default(aa_smaa_custom* custom);
+
+///@brief Returns the variant matching `parameters`, with the parameters uploaded
+///@details A variant used for the first time is compiled and linked on the spot
+///@return The pipeline, or NULL if it failed to compile (now or before)
+aa_smaa_pipeline* aa_smaa_custom_get(
+    aa_smaa_custom* custom, const aa_smaa_parameters* parameters);
 
-char* aa_concat_smaa_source(
-    const char* preamble, const char* smaa_lib, const char* shader_logic);
+// Cleans up the programs of every initialized variant
+void aa_smaa_custom_delete(aa_smaa_custom* custom);
 
 #endif // !__AA_SMAA_SMAA_HELPER
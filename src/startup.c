@@ -0,0 +1,75 @@
+#include "startup.h"
+#include "clock.h"
+#include <stdio.h>
+
+typedef struct
+{
+  const char* name;
+  uint64_t begin_ns;
+  uint64_t end_ns;
+  uint32_t depth;
+} aa_startup_phase;
+
+static aa_startup_phase phases[AA_STARTUP_MAX_PHASES];
+static uint32_t phase_count;
+// Indices of the open phases
+static uint32_t stack[AA_STARTUP_MAX_DEPTH];
+static uint32_t depth;
+// Phases that did not fit are still balanced by `aa_startup_end`
+static uint32_t dropped_depth;
+
+void aa_startup_begin(const char* name)
+{
+  if (phase_count == AA_STARTUP_MAX_PHASES || depth == AA_STARTUP_MAX_DEPTH)
+  {
+    dropped_depth++;
+    return;
+  }
+  aa_startup_phase* phase = &phases[phase_count];
+  phase->name             = name;
+  phase->depth            = depth;
+  phase->end_ns           = 0;
+  stack[depth++]          = phase_count++;
+  // Last, so that the bookkeeping above is not measured
+  phase->begin_ns = aa_clock_ns();
+}
+
+void aa_startup_end(void)
+{
+  uint64_t now = aa_clock_ns();
+  if (dropped_depth > 0)
+  {
+    dropped_depth--;
+    return;
+  }
+  if (depth == 0)
+    return;
+  phases[stack[--depth]].end_ns = now;
+}
+
+void aa_startup_report(void)
+{
+  if (phase_count == 0)
+    return;
+
+  uint64_t origin = phases[0].begin_ns;
+  uint64_t end    = origin;
+  printf("Startup phases (ms, start offset in brackets):\n");
+  for (uint32_t i = 0; i < phase_count; i++)
+  {
+    const aa_startup_phase* phase = &phases[i];
+    if (phase->end_ns == 0)
+    {
+      printf("%*s%s: not finished\n", 2 + 2 * (int)phase->depth, "", phase->name);
+      continue;
+    }
+    printf(
+        "%*s%-*s %9.3f  [%9.3f]\n", 2 + 2 * (int)phase->depth, "",
+        32 - 2 * (int)phase->depth, phase->name,
+        (double)(phase->end_ns - phase->begin_ns) / 1e6,
+        (double)(phase->begin_ns - origin) / 1e6);
+    if (phase->end_ns > end)
+      end = phase->end_ns;
+  }
+  printf("  %-32s %9.3f\n", "total", (double)(end - origin) / 1e6);
+}
@@ -0,0 +1,26 @@
+#ifndef __AA_HG_STARTUP
+#define __AA_HG_STARTUP
+
+#include <stdint.h>
+
+// Startup profiler
+// Phases of the initialisation (GLFW, GLAD, ImGui, shaders, render targets...)
+// are timed with nested begin/end pairs and reported with `--time-startup`.
+// The profile is global since phases start in `main`, before any `AppState`
+// exists. Recording costs two clock reads per phase, so it is always on.
+
+/// @brief Maximum number of phases recorded (later ones are dropped)
+#define AA_STARTUP_MAX_PHASES 64
+/// @brief Maximum nesting depth of phases
+#define AA_STARTUP_MAX_DEPTH 8
+
+/// @brief Opens a phase (`name` must be a string literal)
+void aa_startup_begin(const char* name);
+
+/// @brief Closes the innermost phase
+void aa_startup_end(void);
+
+/// @brief Prints every phase, indented by nesting depth, with its duration
+void aa_startup_report(void);
+
+#endif // !__AA_HG_STARTUP
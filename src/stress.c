@@ -0,0 +1,170 @@
+#include "stress.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef M_PI
+  #define M_PI 3.14159265358979323846
+#endif
+
+/// @brief Length of the rim segments of the Siemens star, in pixels
+#define AA_STRESS_STAR_SEGMENT 4.0
+/// @brief Length of the slivers, in pixels
+#define AA_STRESS_SLIVER_MIN_LENGTH 4.0
+#define AA_STRESS_SLIVER_MAX_LENGTH 64.0
+
+const aa_scene_parameters AA_SCENE_DEFAULTS = {180, 10000, 0.5f, 1, 0.0f};
+
+/// @brief Returns a pseudo-random number in [0, 1) (linear congruential)
+static double aa_stress_random(uint32_t* state)
+{
+  *state = *state * 1664525u + 1013904223u;
+  return (double)(*state >> 8) / 16777216.0;
+}
+
+/// @brief Unit needle: a base of width 1 centred on the origin, and an apex
+///        at (1, 0)
+static const float AA_STRESS_NEEDLE[9] = {
+    0.0f, 0.5f, 0.0f, 0.0f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f};
+
+/// @brief Sets the transform of a needle, from a base of `thickness` pixels
+///        centred on (`base_x`, `base_y`) to an apex at (`apex_x`, `apex_y`),
+///        in pixels
+static void aa_stress_needle(
+    aa_batch_object* out, double base_x, double base_y, double apex_x,
+    double apex_y, double thickness, int width, int height)
+{
+  double dx     = apex_x - base_x;
+  double dy     = apex_y - base_y;
+  double length = sqrt(dx * dx + dy * dy);
+  double nx     = length > 0.0 ? -dy / length * thickness : 0.0;
+  double ny     = length > 0.0 ? dx / length * thickness : 0.0;
+  out->offset[0] = (float)(base_x * 2.0 / width - 1.0);
+  out->offset[1] = (float)(base_y * 2.0 / height - 1.0);
+  out->axis_x[0] = (float)(dx * 2.0 / width);
+  out->axis_x[1] = (float)(dy * 2.0 / height);
+  out->axis_y[0] = (float)(nx * 2.0 / width);
+  out->axis_y[1] = (float)(ny * 2.0 / height);
+}
+
+/// @brief Allocates a geometry of `count` needles
+/// @return 0 on success, -1 on allocation failure
+static int aa_stress_needles(aa_batch_geometry* out, uint32_t count)
+{
+  memset(out, 0, sizeof(aa_batch_geometry));
+  out->vertices = malloc(sizeof(AA_STRESS_NEEDLE));
+  out->commands = malloc(sizeof(aa_batch_command));
+  out->objects  = malloc((size_t)count * sizeof(aa_batch_object));
+  if (out->vertices == NULL || out->commands == NULL || out->objects == NULL)
+  {
+    aa_batch_geometry_free(out);
+    return -1;
+  }
+  memcpy(out->vertices, AA_STRESS_NEEDLE, sizeof(AA_STRESS_NEEDLE));
+  out->vertex_count               = 3;
+  out->commands[0].count          = 3;
+  out->commands[0].instance_count = count;
+  out->commands[0].first          = 0;
+  out->commands[0].base_instance  = 0;
+  out->command_count              = 1;
+  out->object_count               = count;
+  return 0;
+}
+
+int aa_stress_star(
+    aa_batch_geometry* out, uint32_t slices, int width, int height)
+{
+  // The disc is round in pixels, whatever the aspect ratio
+  double radius   = 0.45 * (width < height ? width : height);
+  double angle    = 2.0 * M_PI / slices;
+  uint32_t wedges = (slices + 1) / 2;
+  uint32_t segments =
+      (uint32_t)ceil(angle * radius / AA_STRESS_STAR_SEGMENT);
+  segments              = segments ? segments : 1;
+  uint32_t vertex_count = wedges * segments * 3;
+
+  float* vertices = malloc((size_t)vertex_count * 3 * sizeof(float));
+  if (vertices == NULL)
+    return -1;
+
+  const double SCALE_X = radius * 2.0 / width;
+  const double SCALE_Y = radius * 2.0 / height;
+  float* vertex        = vertices;
+  for (uint32_t wedge = 0; wedge < wedges; wedge++)
+  {
+    for (uint32_t segment = 0; segment < segments; segment++)
+    {
+      double theta1 = angle * (2 * wedge + (double)segment / segments);
+      double theta2 = angle * (2 * wedge + (double)(segment + 1) / segments);
+      float fan[9]  = {
+          0.0f,
+          0.0f,
+          0.0f,
+          (float)(SCALE_X * cos(theta1)),
+          (float)(SCALE_Y * sin(theta1)),
+          0.0f,
+          (float)(SCALE_X * cos(theta2)),
+          (float)(SCALE_Y * sin(theta2)),
+          0.0f};
+      memcpy(vertex, fan, sizeof(fan));
+      vertex += 9;
+    }
+  }
+  return aa_batch_geometry_single(out, vertices, vertex_count);
+}
+
+int aa_stress_grid(
+    aa_batch_geometry* out, const aa_scene_parameters* parameters, int width,
+    int height)
+{
+  if (aa_stress_needles(out, parameters->triangles) != 0)
+    return -1;
+
+  // Splits the window into at least `triangles` cells of its aspect
+  double count     = (double)parameters->triangles;
+  uint32_t columns = (uint32_t)ceil(sqrt(count * width / height));
+  columns          = columns ? columns : 1;
+  uint32_t rows    = (parameters->triangles + columns - 1) / columns;
+  rows             = rows ? rows : 1;
+
+  // Slightly off the diagonal, so that edges are neither at 45 degrees nor
+  // aligned with the pixel grid
+  double cell_width  = (double)width / columns;
+  double cell_height = (double)height / rows;
+  for (uint32_t i = 0; i < parameters->triangles; i++)
+  {
+    double x = (i % columns) * cell_width;
+    double y = (i / columns) * cell_height;
+    aa_stress_needle(
+        &out->objects[i], x + 0.1 * cell_width, y + 0.2 * cell_height,
+        x + 0.9 * cell_width, y + 0.8 * cell_height, parameters->thickness,
+        width, height);
+  }
+  return 0;
+}
+
+int aa_stress_slivers(
+    aa_batch_geometry* out, const aa_scene_parameters* parameters, int width,
+    int height)
+{
+  if (aa_stress_needles(out, parameters->triangles) != 0)
+    return -1;
+
+  const double LENGTH_RANGE =
+      AA_STRESS_SLIVER_MAX_LENGTH - AA_STRESS_SLIVER_MIN_LENGTH;
+  uint32_t random = parameters->seed;
+  for (uint32_t i = 0; i < parameters->triangles; i++)
+  {
+    double x      = aa_stress_random(&random) * width;
+    double y      = aa_stress_random(&random) * height;
+    double theta  = aa_stress_random(&random) * 2.0 * M_PI;
+    double length =
+        AA_STRESS_SLIVER_MIN_LENGTH + aa_stress_random(&random) * LENGTH_RANGE;
+    double dx = 0.5 * length * cos(theta);
+    double dy = 0.5 * length * sin(theta);
+    aa_stress_needle(
+        &out->objects[i], x - dx, y - dy, x + dx, y + dy, parameters->thickness,
+        width, height);
+  }
+  return 0;
+}
@@ -0,0 +1,58 @@
+#ifndef __AA_HG_STRESS
+#define __AA_HG_STRESS
+
+#include <stdint.h>
+#include "batch.h"
+
+// Procedural stress scenes, scaled by `aa_scene_parameters`
+// - Siemens star: `slices` wedges around the centre, every other one drawn,
+//   on a disc of 90% of the smaller window side; the rim is subdivided so
+//   that it stays round. Edges converge towards the centre until they are
+//   closer than a pixel.
+// - grid: `triangles` thin triangles (`thickness` pixels at their base, a
+//   cell long), one per cell of a grid covering the window.
+// - slivers: `triangles` thin triangles (`thickness` pixels at their base,
+//   4 to 64 pixels long) at random positions and orientations (`seed`).
+//   Slivers overlap: their exact reference (`cpu/raster.h` adds coverages)
+//   slightly overestimates the covered area, a sampled one does not.
+// The grid and the slivers are instances of a single needle-shaped mesh, each
+// with its own transform (see `batch.h`).
+
+/// @brief Parameters of the scalable scenes
+typedef struct
+{
+  // Dartboard and Siemens star: number of slices, half of them drawn
+  uint32_t slices;
+  // Grid and slivers: number of triangles
+  uint32_t triangles;
+  // Grid and slivers: width of the triangles at their base, in pixels
+  float thickness;
+  // Slivers: seed of the random placement
+  uint32_t seed;
+  // Every scene: rotation around the centre of the window, in degrees per
+  // frame (0 for a still scene, see `aa_scene_render`)
+  float spin;
+} aa_scene_parameters;
+
+/// @brief 180 slices (the historical dartboard), 10000 triangles half a pixel
+///        thick, seed 1, still
+extern const aa_scene_parameters AA_SCENE_DEFAULTS;
+
+/// @brief Generates a Siemens star
+/// @return 0 on success, -1 on allocation failure
+int aa_stress_star(
+    aa_batch_geometry* out, uint32_t slices, int width, int height);
+
+/// @brief Generates a grid of thin triangles: one mesh, one instance per cell
+/// @return 0 on success, -1 on allocation failure
+int aa_stress_grid(
+    aa_batch_geometry* out, const aa_scene_parameters* parameters, int width,
+    int height);
+
+/// @brief Generates random slivers: one mesh, one instance per sliver
+/// @return 0 on success, -1 on allocation failure
+int aa_stress_slivers(
+    aa_batch_geometry* out, const aa_scene_parameters* parameters, int width,
+    int height);
+
+#endif // !__AA_HG_STRESS
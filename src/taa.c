@@ -0,0 +1,23 @@
+#include "taa.h"
+
+/// @brief Element `index` of the van der Corput sequence in `base`
+static float aa_taa_halton(uint32_t index, uint32_t base)
+{
+  float result   = 0.0f;
+  float fraction = 1.0f;
+  while (index > 0)
+  {
+    fraction /= (float)base;
+    result += fraction * (float)(index % base);
+    index /= base;
+  }
+  return result;
+}
+
+void aa_taa_jitter(uint64_t frame, float out[2])
+{
+  // The sequence starts at 1, 0 would put a sample on the pixel corner
+  uint32_t index = (uint32_t)(frame % AA_TAA_JITTER_COUNT) + 1;
+  out[0]         = aa_taa_halton(index, 2) - 0.5f;
+  out[1]         = aa_taa_halton(index, 3) - 0.5f;
+}
@@ -0,0 +1,26 @@
+#ifndef __AA_HG_TAA
+#define __AA_HG_TAA
+
+#include <stdint.h>
+
+// Temporal anti-aliasing
+// Every frame, the scene is offset by a point of the Halton (2, 3) sequence
+// inside the pixel and blended into a history (`fragment_taa.glsl`): the
+// history is reprojected along the velocity of the scene, clipped to the
+// colours of the current neighbourhood, and keeps `AA_TAA_FEEDBACK` of the
+// current frame. On a still scene, it converges to a supersampled image.
+
+/// @brief Number of jitter offsets before the sequence repeats
+#define AA_TAA_JITTER_COUNT 8
+
+/// @brief Weight of the current frame in the blend
+#define AA_TAA_FEEDBACK 0.1f
+
+/// @brief Width of the box the history is clipped to, in standard deviations
+///        of the neighbourhood
+#define AA_TAA_VARIANCE_GAMMA 1.0f
+
+/// @brief Offset of the scene in `frame`, in pixels (-0.5 to 0.5, y up)
+void aa_taa_jitter(uint64_t frame, float out[2]);
+
+#endif // !__AA_HG_TAA
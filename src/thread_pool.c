@@ -0,0 +1,207 @@
+#include "thread_pool.h"
+#include <stdlib.h>
+
+#ifdef _WIN32
+  #define WIN32_LEAN_AND_MEAN
+  #include <windows.h>
+typedef HANDLE aa_thread;
+typedef SRWLOCK aa_mutex;
+typedef CONDITION_VARIABLE aa_condition;
+  #define aa_mutex_init(m)          InitializeSRWLock(m)
+  #define aa_mutex_lock(m)          AcquireSRWLockExclusive(m)
+  #define aa_mutex_unlock(m)        ReleaseSRWLockExclusive(m)
+  #define aa_mutex_destroy(m)       ((void)(m))
+  #define aa_condition_init(c)      InitializeConditionVariable(c)
+  #define aa_condition_wait(c, m)   SleepConditionVariableSRW(c, m, INFINITE, 0)
+  #define aa_condition_broadcast(c) WakeAllConditionVariable(c)
+  #define aa_condition_destroy(c)   ((void)(c))
+#else
+  #include <pthread.h>
+  #include <unistd.h>
+typedef pthread_t aa_thread;
+typedef pthread_mutex_t aa_mutex;
+typedef pthread_cond_t aa_condition;
+  #define aa_mutex_init(m)          pthread_mutex_init(m, NULL)
+  #define aa_mutex_lock(m)          pthread_mutex_lock(m)
+  #define aa_mutex_unlock(m)        pthread_mutex_unlock(m)
+  #define aa_mutex_destroy(m)       pthread_mutex_destroy(m)
+  #define aa_condition_init(c)      pthread_cond_init(c, NULL)
+  #define aa_condition_wait(c, m)   pthread_cond_wait(c, m)
+  #define aa_condition_broadcast(c) pthread_cond_broadcast(c)
+  #define aa_condition_destroy(c)   pthread_cond_destroy(c)
+#endif
+
+struct aa_thread_pool_shared
+{
+  aa_mutex mutex;
+  // Signaled when a loop starts, or when the workers must exit
+  aa_condition start;
+  // Signaled when the last task of a loop finished
+  aa_condition done;
+  // The current loop
+  aa_thread_pool_task task;
+  void* context;
+  uint32_t task_count;
+  uint32_t next_task;
+  uint32_t finished_tasks;
+  // Incremented by every loop, so sleeping workers notice a new one
+  uint64_t generation;
+  bool quit;
+  // Workers, the calling thread excluded
+  aa_thread* threads;
+  uint32_t thread_count;
+};
+
+typedef struct
+{
+  aa_thread_pool_shared* shared;
+  uint32_t worker;
+} aa_thread_pool_worker;
+
+/// @brief Runs tasks of the current loop until none is left
+/// @details Called with the mutex locked, returns with the mutex locked
+static void aa_thread_pool_drain(aa_thread_pool_shared* shared, uint32_t worker)
+{
+  while (shared->next_task < shared->task_count)
+  {
+    uint32_t task = shared->next_task++;
+    aa_mutex_unlock(&shared->mutex);
+    shared->task(shared->context, task, worker);
+    aa_mutex_lock(&shared->mutex);
+    if (++shared->finished_tasks == shared->task_count)
+      aa_condition_broadcast(&shared->done);
+  }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI aa_thread_pool_main(LPVOID argument)
+#else
+static void* aa_thread_pool_main(void* argument)
+#endif
+{
+  aa_thread_pool_worker* self   = argument;
+  aa_thread_pool_shared* shared = self->shared;
+  uint64_t generation           = 0;
+  aa_mutex_lock(&shared->mutex);
+  while (true)
+  {
+    while (!shared->quit && shared->generation == generation)
+      aa_condition_wait(&shared->start, &shared->mutex);
+    if (shared->quit)
+      break;
+    generation = shared->generation;
+    aa_thread_pool_drain(shared, self->worker);
+  }
+  aa_mutex_unlock(&shared->mutex);
+  free(self);
+  return 0;
+}
+
+uint32_t aa_thread_pool_hardware_threads(void)
+{
+#ifdef _WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  long count = (long)info.dwNumberOfProcessors;
+#else
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+  return count > 0 ? (uint32_t)count : 1;
+}
+
+int aa_thread_pool_init(aa_thread_pool* pool, uint32_t worker_count)
+{
+  if (worker_count == 0)
+    worker_count = aa_thread_pool_hardware_threads();
+  pool->worker_count = 1;
+  pool->shared       = calloc(1, sizeof(aa_thread_pool_shared));
+  if (pool->shared == NULL)
+    return -1;
+  aa_thread_pool_shared* shared = pool->shared;
+  aa_mutex_init(&shared->mutex);
+  aa_condition_init(&shared->start);
+  aa_condition_init(&shared->done);
+  if (worker_count == 1)
+    return 0;
+
+  shared->threads = calloc(worker_count - 1, sizeof(aa_thread));
+  if (shared->threads == NULL)
+    return -1;
+  for (uint32_t i = 0; i < worker_count - 1; i++)
+  {
+    aa_thread_pool_worker* worker = malloc(sizeof(aa_thread_pool_worker));
+    if (worker == NULL)
+      return -1;
+    // Worker 0 is the calling thread
+    worker->shared = shared;
+    worker->worker = i + 1;
+#ifdef _WIN32
+    shared->threads[i] = CreateThread(NULL, 0, aa_thread_pool_main, worker, 0, NULL);
+    bool started       = shared->threads[i] != NULL;
+#else
+    bool started =
+        pthread_create(&shared->threads[i], NULL, aa_thread_pool_main, worker) == 0;
+#endif
+    if (!started)
+    {
+      free(worker);
+      return -1;
+    }
+    shared->thread_count++;
+    pool->worker_count++;
+  }
+  return 0;
+}
+
+void aa_thread_pool_run(
+    aa_thread_pool* pool, aa_thread_pool_task task, void* context,
+    uint32_t task_count)
+{
+  aa_thread_pool_shared* shared = pool->shared;
+  if (shared == NULL || shared->thread_count == 0 || task_count < 2)
+  {
+    for (uint32_t i = 0; i < task_count; i++)
+      task(context, i, 0);
+    return;
+  }
+
+  aa_mutex_lock(&shared->mutex);
+  shared->task           = task;
+  shared->context        = context;
+  shared->task_count     = task_count;
+  shared->next_task      = 0;
+  shared->finished_tasks = 0;
+  shared->generation++;
+  aa_condition_broadcast(&shared->start);
+  aa_thread_pool_drain(shared, 0);
+  while (shared->finished_tasks < task_count)
+    aa_condition_wait(&shared->done, &shared->mutex);
+  aa_mutex_unlock(&shared->mutex);
+}
+
+void aa_thread_pool_delete(aa_thread_pool* pool)
+{
+  aa_thread_pool_shared* shared = pool->shared;
+  if (shared == NULL)
+    return;
+  aa_mutex_lock(&shared->mutex);
+  shared->quit = true;
+  aa_condition_broadcast(&shared->start);
+  aa_mutex_unlock(&shared->mutex);
+  for (uint32_t i = 0; i < shared->thread_count; i++)
+  {
+#ifdef _WIN32
+    WaitForSingleObject(shared->threads[i], INFINITE);
+    CloseHandle(shared->threads[i]);
+#else
+    pthread_join(shared->threads[i], NULL);
+#endif
+  }
+  aa_mutex_destroy(&shared->mutex);
+  aa_condition_destroy(&shared->start);
+  aa_condition_destroy(&shared->done);
+  free(shared->threads);
+  free(shared);
+  pool->shared       = NULL;
+  pool->worker_count = 1;
+}
@@ -0,0 +1,48 @@
+#ifndef __AA_HG_THREAD_POOL
+#define __AA_HG_THREAD_POOL
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Fixed set of worker threads running parallel loops
+// `aa_thread_pool_run` hands out the tasks of a loop one at a time to the
+// workers and to the calling thread, and returns once every task finished.
+// Tasks should be coarse (e.g. bands of rows): handing one out takes a lock.
+
+/// @brief A task of a parallel loop
+/// @param context The context given to `aa_thread_pool_run`
+/// @param task Index of the task, in [0, task_count)
+/// @param worker Index of the thread running the task, in [0, worker_count),
+///        to address per-thread scratch memory
+typedef void (*aa_thread_pool_task)(void* context, uint32_t task, uint32_t worker);
+
+typedef struct aa_thread_pool_shared aa_thread_pool_shared;
+
+typedef struct
+{
+  // Number of threads running tasks, including the calling thread
+  uint32_t worker_count;
+  // Synchronisation and the current loop, shared with the workers
+  aa_thread_pool_shared* shared;
+} aa_thread_pool;
+
+/// @brief Returns the number of logical processors
+uint32_t aa_thread_pool_hardware_threads(void);
+
+/// @brief Starts the workers
+/// @param pool The pool
+/// @param worker_count Number of threads running tasks, including the calling
+///        thread, 0 for one per logical processor
+/// @return 0 on success, -1 if not every thread could be started (the pool
+///         still runs tasks, on the threads that were)
+int aa_thread_pool_init(aa_thread_pool* pool, uint32_t worker_count);
+
+/// @brief Runs `task_count` tasks in parallel and waits for all of them
+void aa_thread_pool_run(
+    aa_thread_pool* pool, aa_thread_pool_task task, void* context,
+    uint32_t task_count);
+
+/// @brief Stops and joins the workers
+void aa_thread_pool_delete(aa_thread_pool* pool);
+
+#endif // !__AA_HG_THREAD_POOL
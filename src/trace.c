@@ -0,0 +1,217 @@
+#include "trace.h"
+#include "clock.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <glad/glad.h>
+
+static void aa_trace_push(
+    aa_trace* trace, const char* name, uint64_t begin_ns, uint64_t end_ns,
+    aa_trace_track track)
+{
+  if (trace->event_count == trace->event_capacity)
+  {
+    if (trace->event_capacity >= AA_TRACE_MAX_EVENTS)
+      return;
+    size_t capacity = trace->event_capacity ? trace->event_capacity * 2 : 4096;
+    aa_trace_event* events =
+        realloc(trace->events, capacity * sizeof(aa_trace_event));
+    if (events == NULL)
+      return;
+    trace->events         = events;
+    trace->event_capacity = capacity;
+  }
+  aa_trace_event* event = &trace->events[trace->event_count++];
+  event->name           = name;
+  event->begin_ns       = begin_ns;
+  event->end_ns         = end_ns;
+  event->track          = track;
+}
+
+/// @brief Converts the spans of a GPU frame to events (waits for their results)
+static void aa_trace_collect(aa_trace* trace, aa_trace_gpu_frame* frame)
+{
+  for (uint32_t i = 0; i < frame->count; i++)
+  {
+    aa_trace_gpu_span* span = &frame->spans[i];
+    aa_timestamp_query_result(&span->begin);
+    aa_timestamp_query_result(&span->end);
+    aa_trace_push(
+        trace, span->name, span->begin.result + trace->gpu_to_cpu_ns,
+        span->end.result + trace->gpu_to_cpu_ns, AA_TRACE_TRACK_GPU);
+  }
+  frame->count = 0;
+}
+
+int aa_trace_init(aa_trace* trace)
+{
+  if (!trace->enabled)
+    return 0;
+  if (trace->file_name == NULL)
+    trace->file_name = "trace.json";
+
+  trace->events = malloc(4096 * sizeof(aa_trace_event));
+  if (trace->events == NULL)
+    return -1;
+  trace->event_capacity = 4096;
+  trace->event_count    = 0;
+
+  for (uint32_t f = 0; f < AA_TRACE_GPU_FRAMES_IN_FLIGHT; f++)
+  {
+    for (uint32_t i = 0; i < AA_TRACE_GPU_MAX_SPANS; i++)
+    {
+      aa_timestamp_query_create(&trace->gpu_frames[f].spans[i].begin);
+      aa_timestamp_query_create(&trace->gpu_frames[f].spans[i].end);
+    }
+    trace->gpu_frames[f].count = 0;
+  }
+  trace->gpu_frame = 0;
+  trace->gpu_depth = 0;
+  trace->cpu_depth = 0;
+  aa_trace_calibrate(trace);
+  trace->origin_ns = aa_clock_ns();
+  return 0;
+}
+
+void aa_trace_calibrate(aa_trace* trace)
+{
+  if (!trace->enabled)
+    return;
+  // Reading GL_TIMESTAMP returns the time at which all previous commands reached
+  // the GPU, so drain the queue first and bracket the read with the CPU clock.
+  glFinish();
+  uint64_t before = aa_clock_ns();
+  int64_t gpu     = aa_gpu_timestamp_now();
+  uint64_t after  = aa_clock_ns();
+  trace->gpu_to_cpu_ns = (int64_t)(before + (after - before) / 2) - gpu;
+}
+
+void aa_trace_frame_begin(aa_trace* trace)
+{
+  if (!trace->enabled)
+    return;
+  if (trace->gpu_depth != 0)
+  {
+    printf("Trace: %" PRIu32 " GPU span(s) left open\n", trace->gpu_depth);
+    trace->gpu_depth = 0;
+  }
+  // The slot we are about to reuse was issued AA_TRACE_GPU_FRAMES_IN_FLIGHT frames
+  // ago, its results are normally available without stalling.
+  trace->gpu_frame = (trace->gpu_frame + 1) % AA_TRACE_GPU_FRAMES_IN_FLIGHT;
+  aa_trace_collect(trace, &trace->gpu_frames[trace->gpu_frame]);
+}
+
+void aa_trace_cpu_begin(aa_trace* trace, const char* name)
+{
+  if (!trace->enabled)
+    return;
+  if (trace->cpu_depth < AA_TRACE_MAX_DEPTH)
+  {
+    trace->cpu_names[trace->cpu_depth]  = name;
+    trace->cpu_begins[trace->cpu_depth] = aa_clock_ns();
+  }
+  trace->cpu_depth++;
+}
+
+void aa_trace_cpu_end(aa_trace* trace)
+{
+  if (!trace->enabled || trace->cpu_depth == 0)
+    return;
+  trace->cpu_depth--;
+  if (trace->cpu_depth < AA_TRACE_MAX_DEPTH)
+  {
+    aa_trace_push(
+        trace, trace->cpu_names[trace->cpu_depth],
+        trace->cpu_begins[trace->cpu_depth], aa_clock_ns(), AA_TRACE_TRACK_CPU);
+  }
+}
+
+void aa_trace_gpu_begin(aa_trace* trace, const char* name)
+{
+  if (!trace->enabled)
+    return;
+  aa_trace_gpu_frame* frame = &trace->gpu_frames[trace->gpu_frame];
+  uint32_t index            = UINT32_MAX;
+  if (frame->count < AA_TRACE_GPU_MAX_SPANS)
+  {
+    index                    = frame->count++;
+    frame->spans[index].name = name;
+    aa_timestamp_query_record(&frame->spans[index].begin);
+  }
+  if (trace->gpu_depth < AA_TRACE_MAX_DEPTH)
+    trace->gpu_stack[trace->gpu_depth] = index;
+  trace->gpu_depth++;
+}
+
+void aa_trace_gpu_end(aa_trace* trace)
+{
+  if (!trace->enabled || trace->gpu_depth == 0)
+    return;
+  trace->gpu_depth--;
+  if (trace->gpu_depth >= AA_TRACE_MAX_DEPTH)
+    return;
+  uint32_t index = trace->gpu_stack[trace->gpu_depth];
+  // Spans beyond AA_TRACE_GPU_MAX_SPANS were dropped in `aa_trace_gpu_begin`
+  if (index != UINT32_MAX)
+    aa_timestamp_query_record(&trace->gpu_frames[trace->gpu_frame].spans[index].end);
+}
+
+int aa_trace_write(aa_trace* trace)
+{
+  if (!trace->enabled)
+    return 0;
+  for (uint32_t f = 0; f < AA_TRACE_GPU_FRAMES_IN_FLIGHT; f++)
+    aa_trace_collect(trace, &trace->gpu_frames[f]);
+
+  FILE* file = fopen(trace->file_name, "w");
+  if (file == NULL)
+  {
+    printf("Error: Could not create file `%s`!\n", trace->file_name);
+    return -1;
+  }
+  // Complete events ("ph":"X") use microseconds for both `ts` and `dur`
+  fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", file);
+  fputs(
+      "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"aa\"}},\n"
+      "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+      "\"args\":{\"name\":\"CPU\"}},\n"
+      "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,"
+      "\"args\":{\"name\":\"GPU\"}}",
+      file);
+  for (size_t i = 0; i < trace->event_count; i++)
+  {
+    const aa_trace_event* event = &trace->events[i];
+    double ts  = (double)((int64_t)(event->begin_ns - trace->origin_ns)) / 1000.0;
+    double dur = (double)((int64_t)(event->end_ns - event->begin_ns)) / 1000.0;
+    fprintf(
+        file,
+        ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+        "\"ts\":%.3f,\"dur\":%.3f}",
+        event->name, event->track == AA_TRACE_TRACK_GPU ? "gpu" : "cpu",
+        (int)event->track, ts, dur);
+  }
+  fputs("\n]}\n", file);
+  fclose(file);
+  if (trace->event_count == AA_TRACE_MAX_EVENTS)
+    printf("Trace: event limit reached, the end of the run was dropped\n");
+  printf("Saved: %s (%zu events)\n", trace->file_name, trace->event_count);
+  return 0;
+}
+
+void aa_trace_delete(aa_trace* trace)
+{
+  if (!trace->enabled)
+    return;
+  for (uint32_t f = 0; f < AA_TRACE_GPU_FRAMES_IN_FLIGHT; f++)
+  {
+    for (uint32_t i = 0; i < AA_TRACE_GPU_MAX_SPANS; i++)
+    {
+      aa_timestamp_query_delete(&trace->gpu_frames[f].spans[i].begin);
+      aa_timestamp_query_delete(&trace->gpu_frames[f].spans[i].end);
+    }
+  }
+  free(trace->events);
+  trace->events         = NULL;
+  trace->event_count    = 0;
+  trace->event_capacity = 0;
+}
@@ -0,0 +1,112 @@
+#ifndef __AA_HG_TRACE
+#define __AA_HG_TRACE
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "gl/query.h"
+
+// Timeline recorder exporting the Chrome Trace Event format (`trace.json`)
+// CPU spans are measured with `aa_clock_ns`, GPU spans with timestamp queries.
+// GPU timestamps are mapped onto the CPU clock using a `GL_TIMESTAMP`
+// calibration, so both tracks line up when the file is opened in Perfetto
+// (ui.perfetto.dev) or chrome://tracing.
+// Every function is a no-op while the trace is disabled, so call sites do not
+// need to check whether tracing was requested.
+
+/// @brief Number of frames a GPU span may stay in flight before being read back
+#define AA_TRACE_GPU_FRAMES_IN_FLIGHT 4
+/// @brief Maximum number of GPU spans recorded in a single frame
+#define AA_TRACE_GPU_MAX_SPANS 32
+/// @brief Maximum nesting depth of spans (per track)
+#define AA_TRACE_MAX_DEPTH 16
+/// @brief Events recorded after this limit are dropped (about 32 MiB of memory)
+#define AA_TRACE_MAX_EVENTS (1u << 20)
+
+/// @brief The track (Perfetto thread) an event is displayed on
+typedef enum
+{
+  AA_TRACE_TRACK_CPU = 1,
+  AA_TRACE_TRACK_GPU = 2
+} aa_trace_track;
+
+/// @brief A completed span, in CPU clock nanoseconds
+typedef struct
+{
+  // Must have static storage duration (string literals)
+  const char* name;
+  uint64_t begin_ns;
+  uint64_t end_ns;
+  aa_trace_track track;
+} aa_trace_event;
+
+/// @brief A GPU span whose timestamps might not be available yet
+typedef struct
+{
+  const char* name;
+  aa_timestamp_query begin;
+  aa_timestamp_query end;
+} aa_trace_gpu_span;
+
+/// @brief The GPU spans issued during a single frame
+typedef struct
+{
+  aa_trace_gpu_span spans[AA_TRACE_GPU_MAX_SPANS];
+  uint32_t count;
+} aa_trace_gpu_frame;
+
+typedef struct
+{
+  // True if spans should be recorded
+  bool enabled;
+  // The file the trace is written to by `aa_trace_write`
+  const char* file_name;
+  // Completed events
+  aa_trace_event* events;
+  size_t event_count;
+  size_t event_capacity;
+  // Open CPU spans
+  const char* cpu_names[AA_TRACE_MAX_DEPTH];
+  uint64_t cpu_begins[AA_TRACE_MAX_DEPTH];
+  uint32_t cpu_depth;
+  // Ring of frames whose GPU spans are waiting for their query results
+  aa_trace_gpu_frame gpu_frames[AA_TRACE_GPU_FRAMES_IN_FLIGHT];
+  uint32_t gpu_frame;
+  uint32_t gpu_stack[AA_TRACE_MAX_DEPTH];
+  uint32_t gpu_depth;
+  // Offset to add to a GPU timestamp to convert it to the CPU clock
+  int64_t gpu_to_cpu_ns;
+  // CPU time of `aa_trace_init`, used as the origin of the timeline
+  uint64_t origin_ns;
+} aa_trace;
+
+/// @brief Creates the timestamp queries and calibrates the GPU clock
+/// @param trace The trace (only initialized if `enabled` is set)
+/// @return 0 on success, -1 on allocation failure
+int aa_trace_init(aa_trace* trace);
+
+/// @brief Measures the offset between the GPU and CPU clocks
+/// @details Waits for the GPU to be idle, do not call in the middle of a frame
+void aa_trace_calibrate(aa_trace* trace);
+
+/// @brief Starts a new frame, collecting the GPU spans of the oldest frame in flight
+void aa_trace_frame_begin(aa_trace* trace);
+
+/// @brief Opens a CPU span (`name` must be a string literal)
+void aa_trace_cpu_begin(aa_trace* trace, const char* name);
+/// @brief Closes the innermost CPU span
+void aa_trace_cpu_end(aa_trace* trace);
+
+/// @brief Opens a GPU span (`name` must be a string literal)
+void aa_trace_gpu_begin(aa_trace* trace, const char* name);
+/// @brief Closes the innermost GPU span
+void aa_trace_gpu_end(aa_trace* trace);
+
+/// @brief Reads back the pending GPU spans and writes the trace file
+/// @return 0 on success, -1 if the file could not be written
+int aa_trace_write(aa_trace* trace);
+
+/// @brief Releases the queries and the recorded events
+void aa_trace_delete(aa_trace* trace);
+
+#endif // !__AA_HG_TRACE
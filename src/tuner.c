@@ -0,0 +1,151 @@
+#include "tuner.h"
+#include "matrix.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int aa_tuner_init(AppState* state, double budget_ms, double quality_floor)
+{
+  aa_tuner_delete(state);
+  state->tuning_points = calloc(state->matrix_count, sizeof(aa_tuning_point));
+  if (state->tuning_points == NULL)
+    return -1;
+  for (size_t i = 0; i < state->matrix_count; i++)
+  {
+    state->tuning_points[i].cell    = state->matrix[i];
+    state->tuning_points[i].quality = -1.0;
+    state->tuning_points[i].ssim    = -1.0;
+  }
+  state->tuning_budget_ms     = budget_ms;
+  state->tuning_quality_floor = quality_floor;
+  return 0;
+}
+
+static int aa_tuner_compare_samples(const void* a, const void* b)
+{
+  uint32_t x = *(const uint32_t*)a;
+  uint32_t y = *(const uint32_t*)b;
+  return (x > y) - (x < y);
+}
+
+void aa_tuner_record(AppState* state)
+{
+  if (state->tuning_points == NULL || state->samples_current == 0)
+    return;
+  // The samples are not needed anymore: sorted in place
+  qsort(
+      state->samples, state->samples_current, sizeof(uint32_t),
+      aa_tuner_compare_samples);
+  aa_tuning_point* point = &state->tuning_points[state->matrix_index];
+  point->gpu_ms  = state->samples[state->samples_current / 2] / 1000000.0;
+  point->quality = state->last_quality.psnr;
+  point->ssim    = state->last_quality.ssim;
+  // Never paired with the next configuration
+  state->last_quality.psnr = -1.0;
+
+  char name[96];
+  aa_matrix_cell_name(&point->cell, name, sizeof(name));
+  printf(
+      "Tuned: %s (GPU %.4f ms, PSNR %.2f dB, SSIM %.4f)\n", name, point->gpu_ms,
+      point->quality, point->ssim);
+}
+
+static int aa_tuner_compare_cost(const void* a, const void* b)
+{
+  const aa_tuning_point* x = *(const aa_tuning_point* const*)a;
+  const aa_tuning_point* y = *(const aa_tuning_point* const*)b;
+  if (x->gpu_ms != y->gpu_ms)
+    return x->gpu_ms < y->gpu_ms ? -1 : 1;
+  // Among equally cheap points the best one comes first
+  return (x->quality < y->quality) - (x->quality > y->quality);
+}
+
+int aa_tuner_report(const AppState* state)
+{
+  size_t count = state->matrix_count;
+  const aa_tuning_point** sorted = malloc(count * sizeof(aa_tuning_point*));
+  bool* pareto                   = calloc(count, sizeof(bool));
+  if (sorted == NULL || pareto == NULL)
+  {
+    free(sorted);
+    free(pareto);
+    return -1;
+  }
+  for (size_t i = 0; i < count; i++)
+    sorted[i] = &state->tuning_points[i];
+  qsort(sorted, count, sizeof(aa_tuning_point*), aa_tuner_compare_cost);
+
+  // Sweeping by increasing cost, a point is on the front if it is better than
+  // every cheaper one
+  double best_quality = -1.0;
+  for (size_t i = 0; i < count; i++)
+  {
+    if (sorted[i]->quality > best_quality)
+    {
+      pareto[i]    = true;
+      best_quality = sorted[i]->quality;
+    }
+  }
+
+  FILE* file = fopen(AA_TUNER_FILE_NAME, "w");
+  if (file == NULL)
+  {
+    printf("Error: Could not create file `%s`!\n", AA_TUNER_FILE_NAME);
+    free(sorted);
+    free(pareto);
+    return -1;
+  }
+  fputs(
+      "configuration,scene,gpu_ms,psnr_db,ssim,pareto,within_budget,meets_floor\n",
+      file);
+
+  const aa_tuning_point* pick = NULL;
+  char name[96];
+  char scene[64];
+  printf(
+      "Pareto front (budget %.3f ms, quality floor %.2f dB):\n",
+      state->tuning_budget_ms, state->tuning_quality_floor);
+  for (size_t i = 0; i < count; i++)
+  {
+    const aa_tuning_point* point = sorted[i];
+    bool within_budget           = point->gpu_ms <= state->tuning_budget_ms;
+    bool meets_floor             = point->quality >= state->tuning_quality_floor;
+    aa_matrix_cell_name(&point->cell, name, sizeof(name));
+    aa_matrix_scene_label(&point->cell, scene, sizeof(scene));
+    fprintf(
+        file, "%s,%s,%.4f,%.3f,%.5f,%d,%d,%d\n", name, scene, point->gpu_ms,
+        point->quality, point->ssim, pareto[i], within_budget, meets_floor);
+    if (pareto[i])
+    {
+      printf(
+          "  %-40s %8.4f ms %7.2f dB%s\n", name, point->gpu_ms, point->quality,
+          within_budget ? "" : " (over budget)");
+    }
+    // Sorted by cost: the first acceptable point is the cheapest one
+    if (pick == NULL && within_budget && meets_floor)
+      pick = point;
+  }
+  fclose(file);
+
+  if (pick)
+  {
+    aa_matrix_cell_name(&pick->cell, name, sizeof(name));
+    printf(
+        "Cheapest configuration meeting the floor: %s (%.4f ms, %.2f dB)\n", name,
+        pick->gpu_ms, pick->quality);
+  }
+  else
+  {
+    printf("No configuration meets the quality floor within the budget\n");
+  }
+  printf("Saved: %s\n", AA_TUNER_FILE_NAME);
+  free(sorted);
+  free(pareto);
+  return 0;
+}
+
+void aa_tuner_delete(AppState* state)
+{
+  free(state->tuning_points);
+  state->tuning_points = NULL;
+}
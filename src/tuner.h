@@ -0,0 +1,33 @@
+#ifndef __AA_HG_TUNER
+#define __AA_HG_TUNER
+
+#include "appstate.h"
+
+// Quality/cost tuner (`--tune <ms>`)
+// The automation mode measures every configuration of the tuning matrix (see
+// `aa_matrix_tuning`, or the `--matrix` file). For each one the median GPU time
+// of the recorded frames is kept with the PSNR of the last frame against the
+// supersampled reference. At the end the Pareto-optimal configurations (no
+// other one is both cheaper and better) are written to `aa_tuning.csv` and the
+// cheapest configuration within the budget that meets the quality floor is
+// printed.
+
+/// @brief Name of the file written by `aa_tuner_report`
+#define AA_TUNER_FILE_NAME "aa_tuning.csv"
+
+/// @brief Allocates one result per cell of the matrix
+/// @return 0 on success, -1 on allocation failure
+int aa_tuner_init(AppState* state, double budget_ms, double quality_floor);
+
+/// @brief Stores the result of the current cell (recorded samples and
+///        `last_quality`)
+void aa_tuner_record(AppState* state);
+
+/// @brief Writes the results and prints the Pareto front and the pick
+/// @return 0 on success, -1 if the file could not be written
+int aa_tuner_report(const AppState* state);
+
+/// @brief Releases the results
+void aa_tuner_delete(AppState* state);
+
+#endif // !__AA_HG_TUNER
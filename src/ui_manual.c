@@ -1,10 +1,15 @@
 #include "ui_manual.h"
+#include <stdio.h>
+#include "samples.h"
+#include "matrix.h"
+#include "lifecycle.h"
 
 void aa_ui_render(AppState* state)
 {
   if (igBegin("Control", NULL, 0))
   {
     // Algorithm selection menu
+    aa_algorithm previous = state->anti_aliasing;
     igTextColored((ImVec4){1.0f, 0.9f, 0.0f, 1.0f}, "Anti-Aliasing Algorithm:");
     if (igButton("No AA", (ImVec2){0, 0}))
       state->anti_aliasing = AA_NONE;
@@ -35,6 +40,133 @@ void aa_ui_render(AppState* state)
     igSameLine(0.0f, 5.0f);
     if (igButton("SMAA_ULTRA", (ImVec2){0, 0}))
       state->anti_aliasing = AA_SMAA_ULTRA;
+    igSameLine(0.0f, 5.0f);
+    if (igButton("SMAA_CUSTOM", (ImVec2){0, 0}))
+      state->anti_aliasing = AA_SMAA_CUSTOM;
+    igSameLine(0.0f, 5.0f);
+    if (igButton("SMAA_T2x", (ImVec2){0, 0}))
+      state->anti_aliasing = AA_SMAA_T2X;
+    igSameLine(0.0f, 5.0f);
+    if (igButton("SMAA_S2x", (ImVec2){0, 0}))
+      state->anti_aliasing = AA_SMAA_S2X;
+    igSameLine(0.0f, 5.0f);
+    if (igButton("SMAA_4x", (ImVec2){0, 0}))
+      state->anti_aliasing = AA_SMAA_4X;
+    igSameLine(0.0f, 5.0f);
+    if (igButton("TAA", (ImVec2){0, 0}))
+      state->anti_aliasing = AA_TAA;
+    igSameLine(0.0f, 5.0f);
+    if (igButton("CMAA2", (ImVec2){0, 0}))
+      state->anti_aliasing = AA_CMAA2;
+    igSameLine(0.0f, 5.0f);
+    if (igButton("MLAA", (ImVec2){0, 0}))
+      state->anti_aliasing = AA_MLAA;
+    igSameLine(0.0f, 5.0f);
+    if (igButton("MLAA_CPU", (ImVec2){0, 0}))
+      state->anti_aliasing = AA_MLAA_CPU;
+    igSameLine(0.0f, 5.0f);
+    if (igButton("SSAA_2x", (ImVec2){0, 0}))
+      state->anti_aliasing = AA_SSAA_2X;
+    igSameLine(0.0f, 5.0f);
+    if (igButton("SSAA_4x", (ImVec2){0, 0}))
+      state->anti_aliasing = AA_SSAA_4X;
+    igSameLine(0.0f, 5.0f);
+    if (igButton("MSAAx4_SampleShading", (ImVec2){0, 0}))
+      state->anti_aliasing = AA_MSAAx4_SAMPLE_SHADING;
+    igSameLine(0.0f, 5.0f);
+    if (igButton("MSAAx4_Resolve", (ImVec2){0, 0}))
+      state->anti_aliasing = AA_MSAAx4_RESOLVE;
+    igSameLine(0.0f, 5.0f);
+    if (igButton("MSAAx8_Resolve", (ImVec2){0, 0}))
+      state->anti_aliasing = AA_MSAAx8_RESOLVE;
+    igSameLine(0.0f, 5.0f);
+    if (igButton("MSAAx16_Resolve", (ImVec2){0, 0}))
+      state->anti_aliasing = AA_MSAAx16_RESOLVE;
+    // Algorithms the device cannot run are refused
+    static char refused[128] = "";
+    if (state->anti_aliasing != previous)
+    {
+      refused[0] = '\0';
+      char reason[96];
+      if (!aa_algorithm_supported(
+              state, state->anti_aliasing, reason, sizeof(reason)))
+      {
+        snprintf(
+            refused, sizeof(refused), "%s is not supported: %s",
+            aa_algorithm_name(state->anti_aliasing), reason);
+        state->anti_aliasing = previous;
+      }
+    }
+    if (refused[0] != '\0')
+      igTextColored((ImVec4){1.0f, 0.3f, 0.3f, 1.0f}, "%s", refused);
+    // Custom SMAA parameters (uniforms, no recompilation)
+    if (state->anti_aliasing == AA_SMAA_CUSTOM)
+    {
+      aa_smaa_parameters* smaa = &state->smaa_parameters;
+      igSliderFloat("Threshold", &smaa->threshold, 0.05f, 0.5f, "%.3f", 0);
+      igSliderInt("Search Steps", &smaa->max_search_steps, 0, 112, "%d", 0);
+      igCheckbox("Diagonal Detection", &smaa->diagonal_detection);
+      igBeginDisabled(!smaa->diagonal_detection);
+      igSliderInt("Diagonal Steps", &smaa->max_search_steps_diag, 0, 20, "%d", 0);
+      igEndDisabled();
+      igText("Edges:");
+      int* edge_mode = (int*)&smaa->edge_mode;
+      for (int i = 0; i < AA_SMAA_EDGE_MODES; i++)
+      {
+        igSameLine(0.0f, 5.0f);
+        igRadioButton_IntPtr(
+            aa_smaa_edge_mode_name((aa_smaa_edge_mode)i), edge_mode, i);
+      }
+      igCheckbox("Corner Detection", &smaa->corner_detection);
+      igBeginDisabled(!smaa->corner_detection);
+      igSliderFloat(
+          "Corner Rounding", &smaa->corner_rounding, 0.0f, 100.0f, "%.0f", 0);
+      igEndDisabled();
+      igText("Preset values:");
+      const char* presets[] = {"Low", "Medium", "High", "Ultra"};
+      for (int i = 0; i < 4; i++)
+      {
+        igSameLine(0.0f, 5.0f);
+        if (igButton(presets[i], (ImVec2){0, 0}))
+          *smaa = AA_SMAA_PRESETS[i];
+      }
+    }
+    // Iterative FXAA parameters (uniforms)
+    if (state->anti_aliasing == AA_FXAA_ITERATIVE)
+    {
+      aa_fxaa_parameters* fxaa = &state->fxaa_parameters;
+      igSliderFloat("Subpixel", &fxaa->subpix, 0.0f, 1.0f, "%.2f", 0);
+      igSliderFloat(
+          "Edge Threshold", &fxaa->edge_threshold, 0.063f, 0.333f, "%.3f", 0);
+      igSliderFloat(
+          "Edge Threshold Min", &fxaa->edge_threshold_min, 0.0312f, 0.0833f, "%.4f",
+          0);
+      // Compiled variants
+      static const char* const PRESETS[AA_FXAA_PRESET_COUNT] = {
+          "10", "11", "12", "13", "14", "15", "20", "21", "22",
+          "23", "24", "25", "26", "27", "28", "29", "39"};
+      int preset = aa_fxaa_preset_index(fxaa->quality_preset);
+      if (igCombo_Str_arr(
+              "Quality Preset", &preset, PRESETS, AA_FXAA_PRESET_COUNT, -1)
+          && preset >= 0)
+        fxaa->quality_preset = AA_FXAA_PRESETS[preset];
+      igCheckbox("Luma In Alpha", &fxaa->luma_alpha);
+      if (igButton("Defaults", (ImVec2){0, 0}))
+        *fxaa = AA_FXAA_DEFAULTS;
+    }
+    // Custom MSAA resolve filter (uniforms)
+    if (state->anti_aliasing >= AA_MSAAx4_RESOLVE
+        && state->anti_aliasing <= AA_MSAAx16_RESOLVE)
+    {
+      aa_resolve_parameters* resolve = &state->resolve_parameters;
+      int* filter                    = (int*)&resolve->filter;
+      igRadioButton_IntPtr("Box", filter, AA_RESOLVE_BOX);
+      igSameLine(0.0f, 5.0f);
+      igRadioButton_IntPtr("Tent", filter, AA_RESOLVE_TENT);
+      igSameLine(0.0f, 5.0f);
+      igRadioButton_IntPtr("Blackman-Harris", filter, AA_RESOLVE_BLACKMAN_HARRIS);
+      igCheckbox("Tonemap Before Resolve", &resolve->tonemap);
+    }
     //Scene Menu
     igSeparator();
     igTextColored((ImVec4){1.0f, 0.9f, 0.0f, 1.0f}, "Scene Selection:");
@@ -43,6 +175,43 @@ void aa_ui_render(AppState* state)
     igSameLine(0.0f, 5.0f);
     if (igButton("Dartboard", (ImVec2){0, 0}))
       state->current_scene = SCENE_DARTBOARD;
+    igSameLine(0.0f, 5.0f);
+    if (igButton("Siemens Star", (ImVec2){0, 0}))
+      state->current_scene = SCENE_SIEMENS_STAR;
+    igSameLine(0.0f, 5.0f);
+    if (igButton("Grid", (ImVec2){0, 0}))
+      state->current_scene = SCENE_GRID;
+    igSameLine(0.0f, 5.0f);
+    if (igButton("Slivers", (ImVec2){0, 0}))
+      state->current_scene = SCENE_SLIVERS;
+    // Scalable scene parameters (the scene is regenerated when they change)
+    aa_scene_parameters* scene = &state->scene_parameters;
+    if (state->current_scene == SCENE_DARTBOARD
+        || state->current_scene == SCENE_SIEMENS_STAR)
+    {
+      int slices = (int)scene->slices;
+      if (igSliderInt(
+              "Slices", &slices, 2, 4096, "%d",
+              ImGuiSliderFlags_Logarithmic | ImGuiSliderFlags_AlwaysClamp))
+        scene->slices = (uint32_t)slices;
+    }
+    if (state->current_scene == SCENE_GRID || state->current_scene == SCENE_SLIVERS)
+    {
+      int triangles = (int)scene->triangles;
+      if (igSliderInt(
+              "Triangles", &triangles, 1, 1000000, "%d",
+              ImGuiSliderFlags_Logarithmic | ImGuiSliderFlags_AlwaysClamp))
+        scene->triangles = (uint32_t)triangles;
+      igSliderFloat(
+          "Thickness", &scene->thickness, 0.05f, 4.0f, "%.2f px",
+          ImGuiSliderFlags_AlwaysClamp);
+    }
+    // Moving scenes show the ghosting of temporal techniques
+    igSliderFloat(
+        "Spin", &scene->spin, -2.0f, 2.0f, "%.2f deg/frame",
+        ImGuiSliderFlags_AlwaysClamp);
+    if (igButton("Scene Defaults", (ImVec2){0, 0}))
+      *scene = AA_SCENE_DEFAULTS;
     igSeparator();
     // Tracing Menu
     igTextColored((ImVec4){1.0f, 0.9f, 0.0f, 1.0f}, "Tracing:");
@@ -55,10 +224,18 @@ void aa_ui_render(AppState* state)
         AA_SAMPLE_COUNT = 10;
       state->samples_total = AA_SAMPLE_COUNT;
       state->samples = realloc(state->samples, AA_SAMPLE_COUNT * sizeof(uint32_t));
+      state->cpu_samples =
+          realloc(state->cpu_samples, AA_SAMPLE_COUNT * sizeof(uint32_t));
       state->samples_current = 0;
     }
     igEndDisabled();
+    igText(
+        "GPU: %.4f ms | CPU submit: %.4f ms | CPU/GPU: %.2f",
+        state->last_gpu_ns / 1000000.0, state->last_cpu_submit_ns / 1000000.0,
+        state->last_gpu_ns ? (double)state->last_cpu_submit_ns / state->last_gpu_ns
+                           : 0.0);
 
+    igCheckbox("Hide UI while recording", &state->isolate_measurements);
     if (igButton("Record Samples", (ImVec2){0, 0}))
     {
       state->samples_current = 0;
@@ -68,22 +245,48 @@ void aa_ui_render(AppState* state)
     igBeginDisabled(state->samples_current != state->samples_total);
     if (igButton("Save Samples", (ImVec2){0, 0}))
     {
-      FILE* file = fopen(state->current_algorithm_file_name, "w");
-      if (file == NULL)
-      {
-        printf(
-            "Error: Could not create file `%s`!",
-            state->current_algorithm_file_name);
-      }
-      else
-      {
-        for (size_t i = 0; i < state->samples_current; i++)
-          fprintf(file, "%" PRIu32 ",", state->samples[i]);
-        fclose(file);
-      }
+      aa_samples_save(state);
       state->samples_current = 0;
     }
     igEndDisabled();
   }
   igEnd();
 }
+
+void aa_ui_overlay(AppState* state)
+{
+  float values[AA_FRAME_RING_CAPACITY];
+  uint32_t count       = aa_frame_ring_snapshot(&state->frame_times, values);
+  aa_frame_stats stats = aa_frame_stats_compute(values, count);
+
+  // Anchor to the top right corner of the main window
+  const ImGuiViewport* viewport = igGetMainViewport();
+  igSetNextWindowPos(
+      (ImVec2){viewport->WorkPos.x + viewport->WorkSize.x - 10.0f,
+               viewport->WorkPos.y + 10.0f},
+      ImGuiCond_Always, (ImVec2){1.0f, 0.0f});
+  igSetNextWindowViewport(viewport->ID);
+  igSetNextWindowBgAlpha(0.5f);
+  ImGuiWindowFlags flags = ImGuiWindowFlags_NoDecoration
+                           | ImGuiWindowFlags_NoDocking
+                           | ImGuiWindowFlags_AlwaysAutoResize
+                           | ImGuiWindowFlags_NoSavedSettings
+                           | ImGuiWindowFlags_NoFocusOnAppearing
+                           | ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoInputs;
+  if (igBegin("Frame Times", NULL, flags))
+  {
+    char label[64];
+    snprintf(
+        label, sizeof(label), "p50 %.3f ms  p99 %.3f ms", stats.p50, stats.p99);
+    igPlotLines_FloatPtr(
+        "##frame_times", values, (int)count, 0, label, 0.0f, stats.max * 1.2f,
+        (ImVec2){240.0f, 60.0f}, sizeof(float));
+    if (state->is_recording)
+    {
+      igTextColored(
+          (ImVec4){1.0f, 0.3f, 0.3f, 1.0f}, "REC %" PRIu64 "/%" PRIu64,
+          state->samples_current, state->samples_total);
+    }
+  }
+  igEnd();
+}
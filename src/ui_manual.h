@@ -9,4 +9,11 @@
 /// @param state The application state
 void aa_ui_render(AppState* state);
 
+/// @brief Renders a small, non-interactive overlay with the recent frame times
+/// @details Shows a rolling graph of the GPU frame time together with its p50 and
+///          p99. Meant to be called once the frame's timing window is closed, so
+///          that it does not perturb the measured pipeline.
+/// @param state The application state
+void aa_ui_overlay(AppState* state);
+
 #endif // !__AA_HG_MANUAL_UI